@@ -1,11 +1,15 @@
 #include <stdbool.h>
 #include "stdlib.h"
+#include "stddef.h"
 #include "stdio.h"
 #include "string.h"
 #include "FixedSizeHeap.h"
 #include "cJSON.h"
-
-FixedSizeMaxHeap* heapMatrix[12][10];
+#include "cJSON_Stream.h"
+#include "cJSON_Bind.h"
+#include "operation_stats.h"
+#include "memory_stats.h"
+#include "trace_events.h"
 
 FixedSizeMaxHeap *CreateMaxHeap(int Grade_Level, int CourseNumber)
 {
@@ -16,6 +20,7 @@ FixedSizeMaxHeap *CreateMaxHeap(int Grade_Level, int CourseNumber)
         perror("Failed to create heap");
         return NULL;
     }
+    MEMORY_ADD(MemoryHeaps, sizeof(FixedSizeMaxHeap));
 
     MaxHeap->Grade_Level = Grade_Level;
     MaxHeap->CourseNumber = CourseNumber;
@@ -27,6 +32,7 @@ FixedSizeMaxHeap *CreateMaxHeap(int Grade_Level, int CourseNumber)
 
 void insert(FixedSizeMaxHeap *maxHeap, Student *student)
 {
+    STATS_START(start);
     int index = maxHeap->FilledIndex;
     if (index < MaxSize)
     {
@@ -59,10 +65,58 @@ void insert(FixedSizeMaxHeap *maxHeap, Student *student)
     maxHeap->studentsCount++;
     SiftUp(maxHeap);
     SiftDown(maxHeap);
+    STATS_STOP(StatHeapInsert, start);
+}
+
+int isSameStudent(const Student *ranked, const Student *student)
+{
+    return strcmp(ranked->first_name, student->first_name) == 0 && strcmp(ranked->last_name, student->last_name) == 0 &&
+           strcmp(ranked->phone, student->phone) == 0;
+}
+
+// Places student among the best ranked, kept sorted from the highest grade down
+static int KeepBest(const Student **best, int count, const Student *student, int course)
+{
+    int grade = student->grades[course];
+    if (count == MaxSize && best[count - 1]->grades[course] >= grade)
+        return count;
+
+    int i = count < MaxSize ? count++ : count - 1;
+    for (; i > 0 && best[i - 1]->grades[course] < grade; i--)
+        best[i] = best[i - 1];
+    best[i] = student;
+    return count;
+}
+
+void insertMany(FixedSizeMaxHeap *maxHeap, Student **students, int count)
+{
+    STATS_START(start);
+    int course = maxHeap->CourseNumber;
+    Student kept[MaxSize];
+    const Student *best[MaxSize];
+    int filled = 0;
+
+    memcpy(kept, maxHeap->students, maxHeap->FilledIndex * sizeof(Student));
+    for (int i = 0; i < maxHeap->FilledIndex; i++)
+        filled = KeepBest(best, filled, &kept[i], course);
+
+    for (int i = 0; i < count; i++)
+    {
+        filled = KeepBest(best, filled, students[i], course);
+        maxHeap->overall_grade += students[i]->grades[course];
+    }
+
+    // An array sorted from the highest grade down already is a max heap
+    for (int i = 0; i < filled; i++)
+        maxHeap->students[i] = *best[i];
+    maxHeap->FilledIndex = filled;
+    maxHeap->studentsCount += count;
+    STATS_STOP(StatHeapInsertMany, start);
 }
 
 void Delete(FixedSizeMaxHeap *maxHeap, Student *Student)
 {
+    STATS_START(start);
     for (int i = 0; i < MaxSize; i++)
     {
         if (strcmp(maxHeap->students[i].first_name, Student->first_name) == 0 && strcmp(maxHeap->students[i].last_name, Student->last_name) == 0)
@@ -72,10 +126,12 @@ void Delete(FixedSizeMaxHeap *maxHeap, Student *Student)
     }
     maxHeap->overall_grade -= Student->grades[maxHeap->CourseNumber];
     maxHeap->studentsCount--;
+    STATS_STOP(StatHeapDelete, start);
 }
 
 void update(FixedSizeMaxHeap *maxHeap, Student *NewStudent)
 {
+    STATS_START(start);
     for (int i = 0; i < MaxSize; i++)
     {
         if (strcmp(maxHeap->students[i].first_name, NewStudent->first_name) == 0 && strcmp(NewStudent->last_name, maxHeap->students[i].last_name) == 0)
@@ -88,12 +144,70 @@ void update(FixedSizeMaxHeap *maxHeap, Student *NewStudent)
             maxHeap->students[i] = *NewStudent;
         }
     }
+    STATS_STOP(StatHeapUpdate, start);
+}
+
+int updateMany(FixedSizeMaxHeap *maxHeap, Student **changed, int count, int delta)
+{
+    STATS_START(start);
+    int course = maxHeap->CourseNumber;
+    Student kept[MaxSize];
+    const Student *best[MaxSize];
+    int filled = 0;
+    int complete = 1;
+
+    // The ranked copies of changed students are stale, the changed students replace them.
+    // Copies are told apart by name and phone, a name alone is shared by many students.
+    int matched[MaxSize];
+    int removed = 0;
+    memcpy(kept, maxHeap->students, maxHeap->FilledIndex * sizeof(Student));
+    for (int i = 0; i < maxHeap->FilledIndex; i++)
+    {
+        const Student *current = &kept[i];
+        for (int j = 0; j < count; j++)
+        {
+            if (isSameStudent(&kept[i], changed[j]))
+            {
+                // A student that isn't ranked could now be better than this one
+                if (changed[j]->grades[course] < kept[i].grades[course])
+                    complete = 0;
+                // Two copies of one changed student leave a place that only a full ranking fills
+                for (int k = 0; k < removed; k++)
+                {
+                    if (matched[k] == j)
+                        complete = 0;
+                }
+                matched[removed++] = j;
+                current = NULL;
+                break;
+            }
+        }
+        if (current)
+            filled = KeepBest(best, filled, current, course);
+    }
+    for (int i = 0; i < count; i++)
+        filled = KeepBest(best, filled, changed[i], course);
+
+    for (int i = 0; i < filled; i++)
+        maxHeap->students[i] = *best[i];
+    maxHeap->FilledIndex = filled;
+    maxHeap->overall_grade += delta;
+    STATS_STOP(StatHeapUpdateMany, start);
+    return complete;
+}
 
+void rankAll(FixedSizeMaxHeap *maxHeap, Student **students, int count)
+{
+    maxHeap->FilledIndex = 0;
+    maxHeap->overall_grade = 0;
+    maxHeap->studentsCount = 0;
+    insertMany(maxHeap, students, count);
 }
 
 void SiftUp(FixedSizeMaxHeap *maxHeap)
 {
     int index = maxHeap->FilledIndex - 1;
+    STATS_COUNT(StatSiftUpCalls, 1);
 
     while (index > 0)
     {
@@ -104,6 +218,7 @@ void SiftUp(FixedSizeMaxHeap *maxHeap)
             Student temp = maxHeap->students[index];
             maxHeap->students[index] = maxHeap->students[parentIndex];
             maxHeap->students[parentIndex] = temp;
+            STATS_COUNT(StatSiftUpSwaps, 1);
 
             index = parentIndex;
         }
@@ -117,6 +232,7 @@ void SiftUp(FixedSizeMaxHeap *maxHeap)
 void SiftDown(FixedSizeMaxHeap *maxHeap)
 {
     int index = 0;
+    STATS_COUNT(StatSiftDownCalls, 1);
 
     while (true)
     {
@@ -142,6 +258,7 @@ void SiftDown(FixedSizeMaxHeap *maxHeap)
         Student temp = maxHeap->students[index];
         maxHeap->students[index] = maxHeap->students[largest];
         maxHeap->students[largest] = temp;
+        STATS_COUNT(StatSiftDownSwaps, 1);
 
         index = largest;
     }
@@ -174,17 +291,20 @@ void printHeap(FixedSizeMaxHeap *maxHeap)
     }
 }
 
-void CreateHeapMatrix() {
-    for (int grade = 0; grade < 12; grade++) {
-        for (int course = 0; course < 10; course++) {
-            heapMatrix[grade][course] = CreateMaxHeap(grade, course);
-        }
-    }
+FixedSizeMaxHeap *GetOrCreateHeap(HeapMatrix matrix, int grade, int course)
+{
+    if (grade < 0 || grade >= MAX_GRADES || course < 0 || course >= SUBJECTS)
+        return NULL;
+    if (matrix[grade][course] == NULL)
+        matrix[grade][course] = CreateMaxHeap(grade, course);
+    return matrix[grade][course];
 }
 
 // Free heap memory
 void FreeHeap(FixedSizeMaxHeap *heap)
 {
+    if (heap != NULL)
+        MEMORY_REMOVE(MemoryHeaps, sizeof(FixedSizeMaxHeap));
     free(heap);
 }
 
@@ -201,148 +321,503 @@ bool file_exists(const char *filename)
     return false;
 }
 
-void SaveHeapMatrixToJson(const char *filename)
+void SaveHeapMatrixToJson(HeapMatrix matrix, const char *filename)
 {
     // Check if the file already exists
-    if (file_exists(filename))
+    TRACE_BEGIN(existsSpan);
+    bool exists = file_exists(filename);
+    TRACE_END(existsSpan, "file_exists");
+    if (exists)
     {
         printf("File '%s' already exists. Skipping save.\n", filename);
         return;
     }
 
-    cJSON *jsonMatrix = cJSON_CreateArray();
+    STATS_START(start);
+    FILE *file = fopen(filename, "w");
+    if (!file)
+    {
+        return;
+    }
+
+    // The writer renders straight into the file through a fixed size buffer,
+    // in the same layout cJSON_Print gives, without building a cJSON tree.
+    cJSON_StreamWriter *writer = cJSONStream_CreateFileWriter(file, 1);
+    if (!writer)
+    {
+        fclose(file);
+        return;
+    }
 
-    for (int grade = 0; grade < 12; grade++)
+    cJSONStream_BeginArray(writer);
+    for (int grade = 0; grade < MAX_GRADES; grade++)
     {
-        for (int course = 0; course < 10; course++)
+        for (int course = 0; course < SUBJECTS; course++)
         {
-            FixedSizeMaxHeap *heap = heapMatrix[grade][course];
+            FixedSizeMaxHeap *heap = matrix[grade][course];
             if (heap != NULL)
             {
-                cJSON *jsonHeap = cJSON_CreateObject();
-                cJSON_AddNumberToObject(jsonHeap, "Grade_Level", heap->Grade_Level);
-                cJSON_AddNumberToObject(jsonHeap, "CourseNumber", heap->CourseNumber);
-                cJSON_AddNumberToObject(jsonHeap, "overall_grade", heap->overall_grade);
-                cJSON_AddNumberToObject(jsonHeap, "studentsCount", heap->studentsCount);
-
-                cJSON *jsonStudents = cJSON_CreateArray();
+                cJSONStream_BeginObject(writer);
+                cJSONStream_Key(writer, "Grade_Level");
+                cJSONStream_Int(writer, heap->Grade_Level);
+                cJSONStream_Key(writer, "CourseNumber");
+                cJSONStream_Int(writer, heap->CourseNumber);
+                cJSONStream_Key(writer, "overall_grade");
+                cJSONStream_Int(writer, heap->overall_grade);
+                cJSONStream_Key(writer, "studentsCount");
+                cJSONStream_Int(writer, heap->studentsCount);
+
+                cJSONStream_Key(writer, "students");
+                cJSONStream_BeginArray(writer);
                 for (int i = 0; i < heap->FilledIndex; i++)
                 {
-                    cJSON *jsonStudent = cJSON_CreateObject();
-                    cJSON_AddStringToObject(jsonStudent, "first_name", heap->students[i].first_name);
-                    cJSON_AddStringToObject(jsonStudent, "last_name", heap->students[i].last_name);
-                    cJSON_AddStringToObject(jsonStudent, "phone", heap->students[i].phone);
-                    cJSON_AddNumberToObject(jsonStudent, "grade", heap->students[i].grade);
-                    cJSON_AddNumberToObject(jsonStudent, "class", heap->students[i].class);
-
-                    cJSON *gradesArray = cJSON_CreateIntArray(heap->students[i].grades, 10);
-                    cJSON_AddItemToObject(jsonStudent, "grades", gradesArray);
-
-                    cJSON_AddItemToArray(jsonStudents, jsonStudent);
+                    cJSONStream_BeginObject(writer);
+                    cJSONStream_Key(writer, "first_name");
+                    cJSONStream_String(writer, heap->students[i].first_name);
+                    cJSONStream_Key(writer, "last_name");
+                    cJSONStream_String(writer, heap->students[i].last_name);
+                    cJSONStream_Key(writer, "phone");
+                    cJSONStream_String(writer, heap->students[i].phone);
+                    cJSONStream_Key(writer, "grade");
+                    cJSONStream_Int(writer, heap->students[i].grade);
+                    cJSONStream_Key(writer, "class");
+                    cJSONStream_Int(writer, heap->students[i].class);
+
+                    cJSONStream_Key(writer, "grades");
+                    cJSONStream_BeginArray(writer);
+                    for (int j = 0; j < SUBJECTS; j++)
+                    {
+                        cJSONStream_Int(writer, heap->students[i].grades[j]);
+                    }
+                    cJSONStream_EndArray(writer);
+
+                    cJSONStream_EndObject(writer);
                 }
-                cJSON_AddItemToObject(jsonHeap, "students", jsonStudents);
-                cJSON_AddItemToArray(jsonMatrix, jsonHeap);
+                cJSONStream_EndArray(writer);
+                cJSONStream_EndObject(writer);
             }
         }
     }
+    cJSONStream_EndArray(writer);
 
-    FILE *file = fopen(filename, "w");
-    if (file)
+    // Errors are sticky, so one check at the end covers every call above
+    if (!cJSONStream_Flush(writer))
     {
-        char *jsonString = cJSON_Print(jsonMatrix);
-        fprintf(file, "%s", jsonString);
-        fclose(file);
-        free(jsonString);
+        printf("Failed to write '%s'.\n", filename);
     }
-
-    cJSON_Delete(jsonMatrix);
+    cJSONStream_DeleteWriter(writer);
+    fclose(file);
+    STATS_STOP(StatSaveHeapMatrix, start);
 }
 
 
 // Load the heap matrix from JSON
-void LoadHeapMatrixFromJson(const char *filename)
+//
+// The file is read in chunks through the streaming parser and every value is
+// written straight into its FixedSizeMaxHeap, so no cJSON tree is built and the
+// file is never held in memory as a whole.
+// Nesting depths: 1 = matrix array, 2 = heap object, 3 = students array,
+// 4 = student object, 5 = grades array.
+// Which key goes into which struct member is described by the field tables
+// below, so every key is looked up once and every copy is bounded.
+static const cJSONBind_Field HeapFields[] = {
+    {"Grade_Level", offsetof(FixedSizeMaxHeap, Grade_Level), cJSONBind_Int, 0},
+    {"CourseNumber", offsetof(FixedSizeMaxHeap, CourseNumber), cJSONBind_Int, 0},
+    {"overall_grade", offsetof(FixedSizeMaxHeap, overall_grade), cJSONBind_Int, 0},
+    {"studentsCount", offsetof(FixedSizeMaxHeap, studentsCount), cJSONBind_Int, 0},
+};
+
+static const cJSONBind_Field StudentFields[] = {
+    {"first_name", offsetof(Student, first_name), cJSONBind_String, MAX_NAME},
+    {"last_name", offsetof(Student, last_name), cJSONBind_String, MAX_NAME},
+    {"phone", offsetof(Student, phone), cJSONBind_String, MAX_PHONE},
+    {"grade", offsetof(Student, grade), cJSONBind_Int, 0},
+    {"class", offsetof(Student, class), cJSONBind_Int, 0},
+    {"grades", offsetof(Student, grades), cJSONBind_IntArray, SUBJECTS},
+};
+
+#define FieldCount(fields) (sizeof(fields) / sizeof((fields)[0]))
+
+typedef struct HeapMatrixLoader
 {
-    FILE *file = fopen(filename, "r");
+    FixedSizeMaxHeap *(*matrix)[SUBJECTS]; // HeapMatrix being filled
+    int depth;                  // number of open arrays/objects
+    const cJSONBind_Field *field; // field of the value that comes next, NULL if it isn't bound
+    FixedSizeMaxHeap *heap;     // heap object being read
+    Student *student;           // student object being read, NULL once the heap is full
+    int gradeIndex;             // next entry of the grades array
+} HeapMatrixLoader;
+
+static cJSON_bool LoaderStartObject(void *userData)
+{
+    HeapMatrixLoader *loader = userData;
+    loader->depth++;
+    loader->field = NULL;
+
+    if (loader->depth == 2)
+    {
+        loader->heap = CreateMaxHeap(0, 0);
+        return loader->heap != NULL;
+    }
+    if (loader->depth == 4 && loader->heap != NULL && loader->heap->FilledIndex < MaxSize)
+    {
+        loader->student = &loader->heap->students[loader->heap->FilledIndex];
+    }
+    return true;
+}
+
+static cJSON_bool LoaderEndObject(void *userData)
+{
+    HeapMatrixLoader *loader = userData;
+
+    if (loader->depth == 4 && loader->student != NULL)
+    {
+        loader->heap->FilledIndex++;
+        loader->student = NULL;
+    }
+    else if (loader->depth == 2 && loader->heap != NULL)
+    {
+        FixedSizeMaxHeap *heap = loader->heap;
+        loader->heap = NULL;
+
+        if (heap->Grade_Level < 0 || heap->Grade_Level >= MAX_GRADES || heap->CourseNumber < 0 || heap->CourseNumber >= SUBJECTS)
+        {
+            printf("Skipping heap with invalid grade %d / course %d.\n", heap->Grade_Level, heap->CourseNumber);
+            FreeHeap(heap);
+        }
+        else
+        {
+            if (loader->matrix[heap->Grade_Level][heap->CourseNumber] != NULL)
+            {
+                FreeHeap(loader->matrix[heap->Grade_Level][heap->CourseNumber]);
+            }
+            loader->matrix[heap->Grade_Level][heap->CourseNumber] = heap;
+        }
+    }
+    loader->depth--;
+    return true;
+}
+
+static cJSON_bool LoaderStartArray(void *userData)
+{
+    HeapMatrixLoader *loader = userData;
+    loader->depth++;
+    loader->gradeIndex = 0;
+    return true;
+}
+
+static cJSON_bool LoaderEndArray(void *userData)
+{
+    HeapMatrixLoader *loader = userData;
+    loader->depth--;
+    return true;
+}
+
+static cJSON_bool LoaderKey(void *userData, const char *key, size_t length)
+{
+    HeapMatrixLoader *loader = userData;
+    (void)length;
+
+    if (loader->depth == 2)
+        loader->field = cJSONBind_FindField(HeapFields, FieldCount(HeapFields), key);
+    else if (loader->depth == 4)
+        loader->field = cJSONBind_FindField(StudentFields, FieldCount(StudentFields), key);
+    else
+        loader->field = NULL;
+    return true;
+}
+
+// Values that don't match their field's type are ignored, like unknown keys
+static cJSON_bool LoaderNumber(void *userData, double number)
+{
+    HeapMatrixLoader *loader = userData;
+
+    if (loader->depth == 2 && loader->heap != NULL)
+        cJSONBind_SetNumber(loader->field, loader->heap, number);
+    else if (loader->depth == 4 && loader->student != NULL)
+        cJSONBind_SetNumber(loader->field, loader->student, number);
+    else if (loader->depth == 5 && loader->student != NULL)
+        cJSONBind_SetArrayNumber(loader->field, loader->student, (size_t)loader->gradeIndex++, number);
+    return true;
+}
+
+static cJSON_bool LoaderString(void *userData, const char *string, size_t length)
+{
+    HeapMatrixLoader *loader = userData;
+    (void)length;
+
+    if (loader->depth == 4 && loader->student != NULL)
+        cJSONBind_SetString(loader->field, loader->student, string);
+    return true;
+}
+
+// Moves every heap of loaded into matrix, replacing the heaps it had for the same grade and course
+static void MoveHeaps(HeapMatrix loaded, HeapMatrix matrix)
+{
+    for (int grade = 0; grade < MAX_GRADES; grade++)
+    {
+        for (int course = 0; course < SUBJECTS; course++)
+        {
+            if (loaded[grade][course] == NULL)
+                continue;
+            if (matrix[grade][course] != NULL)
+                FreeHeap(matrix[grade][course]);
+            matrix[grade][course] = loaded[grade][course];
+            loaded[grade][course] = NULL;
+        }
+    }
+}
+
+int LoadHeapMatrixFromJson(HeapMatrix matrix, const char *filename)
+{
+    STATS_START(start);
+    FILE *file = fopen(filename, "rb");
     if (!file)
     {
         perror("Failed to open file");
-        return;
+        return 0;
     }
 
-    fseek(file, 0, SEEK_END);
-    long fileSize = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    char *jsonString = (char *)malloc(fileSize + 1);
-    fread(jsonString, 1, fileSize, file);
+    cJSON_StreamHandler handler = {
+        LoaderStartObject, LoaderEndObject,
+        LoaderStartArray, LoaderEndArray,
+        LoaderKey, LoaderString, LoaderNumber,
+        NULL, NULL
+    };
+    // Heaps are collected apart from matrix, so a file that is cut off or corrupt changes nothing
+    HeapMatrix loaded = {{NULL}};
+    HeapMatrixLoader loader = {0};
+    loader.matrix = loaded;
+
+    int ok = cJSONStream_ParseFile(file, &handler, &loader);
     fclose(file);
-    jsonString[fileSize] = '\0';
 
-    cJSON *jsonMatrix = cJSON_Parse(jsonString);
-    free(jsonString);
+    // A heap that was cut off by a parse error never reached the matrix
+    if (loader.heap != NULL)
+    {
+        FreeHeap(loader.heap);
+    }
+    if (ok)
+    {
+        MoveHeaps(loaded, matrix);
+    }
+    else
+    {
+        printf("Failed to parse heap matrix file '%s'.\n", filename);
+        FreeHeapMatrix(loaded);
+    }
+    STATS_STOP(StatLoadHeapMatrix, start);
+    return ok;
+}
+
+
+// Binary snapshot of the heap matrix
+//
+// Layout: the magic "HMX1" and the number of heaps, then for every heap its
+// Grade_Level, CourseNumber, overall_grade, studentsCount and FilledIndex
+// followed by FilledIndex student records. A student record holds the name
+// and phone buffers as they are (zero padded) and grade, class and the 10
+// grades. Every int is stored as 4 bytes little endian, so a snapshot reads
+// back the same on any platform and loading needs no number parsing at all.
+#define SnapshotMagic "HMX1"
+#define HeapRecordSize (5 * 4)
+#define StudentRecordSize (2 * MAX_NAME + MAX_PHONE + (2 + 10) * 4)
 
-    if (!jsonMatrix)
+static unsigned char *WriteInt32(unsigned char *out, int value)
+{
+    unsigned long bits = (unsigned long)value;
+    out[0] = (unsigned char)(bits & 0xFF);
+    out[1] = (unsigned char)((bits >> 8) & 0xFF);
+    out[2] = (unsigned char)((bits >> 16) & 0xFF);
+    out[3] = (unsigned char)((bits >> 24) & 0xFF);
+    return out + 4;
+}
+
+static const unsigned char *ReadInt32(const unsigned char *in, int *value)
+{
+    unsigned long bits = (unsigned long)in[0] | ((unsigned long)in[1] << 8) | ((unsigned long)in[2] << 16) | ((unsigned long)in[3] << 24);
+    // Sign extend without relying on how out of range conversions behave
+    *value = (bits & 0x80000000UL) ? -(int)(~bits & 0x7FFFFFFFUL) - 1 : (int)bits;
+    return in + 4;
+}
+
+void SaveHeapMatrixToBinary(HeapMatrix matrix, const char *filename)
+{
+    FILE *file = fopen(filename, "wb");
+    if (!file)
     {
+        perror("Failed to open file");
         return;
     }
 
-    cJSON *jsonHeap;
-    cJSON_ArrayForEach(jsonHeap, jsonMatrix)
+    unsigned char record[StudentRecordSize];
+    int heapCount = 0;
+    for (int grade = 0; grade < MAX_GRADES; grade++)
     {
-        int grade = cJSON_GetObjectItem(jsonHeap, "Grade_Level")->valueint;
-        int course = cJSON_GetObjectItem(jsonHeap, "CourseNumber")->valueint;
+        for (int course = 0; course < SUBJECTS; course++)
+        {
+            if (matrix[grade][course] != NULL)
+                heapCount++;
+        }
+    }
+
+    memcpy(record, SnapshotMagic, 4);
+    WriteInt32(record + 4, heapCount);
+    bool ok = fwrite(record, 1, 8, file) == 8;
 
-        if (heapMatrix[grade][course] != NULL) {
-            FreeHeap(heapMatrix[grade][course]);
+    for (int grade = 0; grade < MAX_GRADES && ok; grade++)
+    {
+        for (int course = 0; course < SUBJECTS && ok; course++)
+        {
+            FixedSizeMaxHeap *heap = matrix[grade][course];
+            if (heap == NULL)
+                continue;
+
+            unsigned char *out = record;
+            out = WriteInt32(out, heap->Grade_Level);
+            out = WriteInt32(out, heap->CourseNumber);
+            out = WriteInt32(out, heap->overall_grade);
+            out = WriteInt32(out, heap->studentsCount);
+            WriteInt32(out, heap->FilledIndex);
+            ok = fwrite(record, 1, HeapRecordSize, file) == HeapRecordSize;
+
+            for (int i = 0; i < heap->FilledIndex && ok; i++)
+            {
+                Student *student = &heap->students[i];
+
+                // strncpy pads with zeros, so nothing past the terminator reaches the file
+                memset(record, 0, sizeof(record));
+                strncpy((char *)record, student->first_name, MAX_NAME - 1);
+                strncpy((char *)record + MAX_NAME, student->last_name, MAX_NAME - 1);
+                strncpy((char *)record + 2 * MAX_NAME, student->phone, MAX_PHONE - 1);
+                out = record + 2 * MAX_NAME + MAX_PHONE;
+                out = WriteInt32(out, student->grade);
+                out = WriteInt32(out, student->class);
+                for (int j = 0; j < SUBJECTS; j++)
+                {
+                    out = WriteInt32(out, student->grades[j]);
+                }
+                ok = fwrite(record, 1, StudentRecordSize, file) == StudentRecordSize;
+            }
         }
+    }
 
-        FixedSizeMaxHeap *heap = CreateMaxHeap(grade, course);
-        if (!heap) {
-            continue;
+    if (fclose(file) != 0 || !ok)
+    {
+        printf("Failed to write '%s'.\n", filename);
+    }
+}
+
+int LoadHeapMatrixFromBinary(HeapMatrix matrix, const char *filename)
+{
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+    {
+        perror("Failed to open file");
+        return 0;
+    }
+
+    unsigned char record[StudentRecordSize];
+    int heapCount = 0;
+    if (fread(record, 1, 8, file) != 8 || memcmp(record, SnapshotMagic, 4) != 0)
+    {
+        printf("'%s' is not a heap matrix snapshot.\n", filename);
+        fclose(file);
+        return 0;
+    }
+    ReadInt32(record + 4, &heapCount);
+
+    // Like the JSON loader, a broken snapshot leaves matrix as it was
+    HeapMatrix loaded = {{NULL}};
+    int h;
+    for (h = 0; h < heapCount; h++)
+    {
+        if (fread(record, 1, HeapRecordSize, file) != HeapRecordSize)
+        {
+            printf("Heap matrix snapshot '%s' is truncated.\n", filename);
+            break;
         }
 
-        heap->overall_grade = cJSON_GetObjectItem(jsonHeap, "overall_grade")->valueint;
-        heap->studentsCount = cJSON_GetObjectItem(jsonHeap, "studentsCount")->valueint;
+        int gradeLevel, courseNumber, filledIndex;
+        const unsigned char *in = record;
+        in = ReadInt32(in, &gradeLevel);
+        in = ReadInt32(in, &courseNumber);
+        if (gradeLevel < 0 || gradeLevel >= MAX_GRADES || courseNumber < 0 || courseNumber >= SUBJECTS)
+        {
+            printf("Heap matrix snapshot '%s' has an invalid grade %d / course %d.\n", filename, gradeLevel, courseNumber);
+            break;
+        }
+        ReadInt32(in + 8, &filledIndex);
+        if (filledIndex < 0 || filledIndex > MaxSize)
+        {
+            printf("Heap matrix snapshot '%s' has a heap with %d students.\n", filename, filledIndex);
+            break;
+        }
 
-        cJSON *jsonStudents = cJSON_GetObjectItem(jsonHeap, "students");
-        if (!jsonStudents || heap->studentsCount == 0) {
-            continue;
+        FixedSizeMaxHeap *heap = CreateMaxHeap(gradeLevel, courseNumber);
+        if (!heap)
+        {
+            break;
         }
+        in = ReadInt32(in, &heap->overall_grade);
+        in = ReadInt32(in, &heap->studentsCount);
 
-        int i = 0;
-        cJSON *jsonStudent;
-        cJSON_ArrayForEach(jsonStudent, jsonStudents)
+        bool complete = true;
+        for (int i = 0; i < filledIndex; i++)
         {
-            strcpy(heap->students[i].first_name, cJSON_GetObjectItem(jsonStudent, "first_name")->valuestring);
-            strcpy(heap->students[i].last_name, cJSON_GetObjectItem(jsonStudent, "last_name")->valuestring);
-            strcpy(heap->students[i].phone, cJSON_GetObjectItem(jsonStudent, "phone")->valuestring);
-            heap->students[i].grade = cJSON_GetObjectItem(jsonStudent, "grade")->valueint;
-            heap->students[i].class = cJSON_GetObjectItem(jsonStudent, "class")->valueint;
-
-            cJSON *gradesArray = cJSON_GetObjectItem(jsonStudent, "grades");
-            if (gradesArray) {
-                for (int j = 0; j < 10; j++) {
-                    heap->students[i].grades[j] = cJSON_GetArrayItem(gradesArray, j)->valueint;
-                }
+            if (fread(record, 1, StudentRecordSize, file) != StudentRecordSize)
+            {
+                complete = false;
+                break;
             }
 
-            i++;
+            Student *student = &heap->students[i];
+            memcpy(student->first_name, record, MAX_NAME);
+            memcpy(student->last_name, record + MAX_NAME, MAX_NAME);
+            memcpy(student->phone, record + 2 * MAX_NAME, MAX_PHONE);
+            student->first_name[MAX_NAME - 1] = '\0';
+            student->last_name[MAX_NAME - 1] = '\0';
+            student->phone[MAX_PHONE - 1] = '\0';
+            in = record + 2 * MAX_NAME + MAX_PHONE;
+            in = ReadInt32(in, &student->grade);
+            in = ReadInt32(in, &student->class);
+            for (int j = 0; j < SUBJECTS; j++)
+            {
+                in = ReadInt32(in, &student->grades[j]);
+            }
+        }
+        if (!complete)
+        {
+            printf("Heap matrix snapshot '%s' is truncated.\n", filename);
+            FreeHeap(heap);
+            break;
         }
+        heap->FilledIndex = filledIndex;
 
-        heap->FilledIndex = i;
-        heapMatrix[grade][course] = heap;
+        if (loaded[gradeLevel][courseNumber] != NULL)
+        {
+            FreeHeap(loaded[gradeLevel][courseNumber]);
+        }
+        loaded[gradeLevel][courseNumber] = heap;
     }
+    fclose(file);
 
-    cJSON_Delete(jsonMatrix);
+    if (h < heapCount)
+    {
+        FreeHeapMatrix(loaded);
+        return 0;
+    }
+    MoveHeaps(loaded, matrix);
+    return 1;
 }
 
 
-void FreeHeapMatrix() {
-    for (int grade = 0; grade < 12; grade++) {
-        for (int course = 0; course < 10; course++) {
-            if (heapMatrix[grade][course] != NULL) {
-                FreeHeap(heapMatrix[grade][course]);
-                heapMatrix[grade][course] = NULL;
+void FreeHeapMatrix(HeapMatrix matrix) {
+    for (int grade = 0; grade < MAX_GRADES; grade++) {
+        for (int course = 0; course < SUBJECTS; course++) {
+            if (matrix[grade][course] != NULL) {
+                FreeHeap(matrix[grade][course]);
+                matrix[grade][course] = NULL;
             }
 
         }
@@ -14,23 +14,35 @@ typedef struct FixedSizeMaxHeap
     int studentsCount;    // Number of students
 } FixedSizeMaxHeap;
 
-// Declaration of heapMatrix using extern
-extern FixedSizeMaxHeap* heapMatrix[12][10];
-
 FixedSizeMaxHeap *CreateMaxHeap(int Grade_Level , int CourseNumber);
 void SiftUp(FixedSizeMaxHeap *maxHeap);
 void SiftDown(FixedSizeMaxHeap *maxHeap);
 void insert(FixedSizeMaxHeap *maxHeap, Student *student);
+// Inserts count students at once, keeping the MaxSize best grades of the course in one pass
+void insertMany(FixedSizeMaxHeap *maxHeap, Student **students, int count);
 void Delete(FixedSizeMaxHeap *maxHeap, Student *Student);
 void update(FixedSizeMaxHeap *maxHeap, Student *NewStudent);
+// Whether the heap's copy ranked stands for student: same first name, last name and phone
+int isSameStudent(const Student *ranked, const Student *student);
+// Re-ranks after the course grades of count distinct students changed by delta in total.
+// Returns 0 when a ranked student went down, the heap then needs a rankAll over its grade level.
+int updateMany(FixedSizeMaxHeap *maxHeap, Student **changed, int count, int delta);
+// Ranks a grade level's students from scratch, totals included
+void rankAll(FixedSizeMaxHeap *maxHeap, Student **students, int count);
 void printHeap(FixedSizeMaxHeap *maxHeap);
-void CreateHeapMatrix();
+// The heap of grade index 0-11 and course 0-9, created empty the first time it is asked for
+FixedSizeMaxHeap *GetOrCreateHeap(HeapMatrix matrix, int grade, int course);
 
 // Functions for JSON I/O
 void SaveHeapToJson(FixedSizeMaxHeap *heap, const char *filename);
 FixedSizeMaxHeap *LoadHeapFromJson(const char *filename);
 void FreeHeap(FixedSizeMaxHeap *heap);
-void SaveHeapMatrixToJson(const char *filename);
-void LoadHeapMatrixFromJson(const char *filename);
-void FreeHeapMatrix();
+void SaveHeapMatrixToJson(HeapMatrix matrix, const char *filename);
+// Both loaders fill matrix only when the whole file could be read, returning 0 and leaving it alone otherwise
+int LoadHeapMatrixFromJson(HeapMatrix matrix, const char *filename);
+
+// Binary snapshot of the same data, smaller than the JSON file and loaded without number parsing
+void SaveHeapMatrixToBinary(HeapMatrix matrix, const char *filename);
+int LoadHeapMatrixFromBinary(HeapMatrix matrix, const char *filename);
+void FreeHeapMatrix(HeapMatrix matrix);
 #endif //CHECKPOINT_FIXEDSIZEHEAP_H
@@ -0,0 +1,164 @@
+// clock_gettime and CLOCK_MONOTONIC are POSIX, not ISO C
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench_common.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+int BenchParseOptions(int argc, char **argv, const char *defaultOutput, BenchOptions *options) {
+    options->maxSize = BENCH_DEFAULT_MAX_SIZE;
+    options->seed = 1;
+    options->outputPath = defaultOutput;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            options->maxSize = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options->seed = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            options->outputPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--max-size N] [--seed N] [--output PATH]\n", argv[0]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int BenchSizes(size_t maxSize, size_t sizes[], int capacity) {
+    int count = 0;
+    for (size_t size = 1000; size <= 10000000 && size <= maxSize && count < capacity; size *= 10) {
+        sizes[count++] = size;
+    }
+    return count;
+}
+
+double BenchNow(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+#endif
+}
+
+unsigned long BenchRandom(unsigned long *state) {
+    // xorshift on 32 bits, plenty for picking names and grades
+    unsigned long x = *state & 0xFFFFFFFFUL;
+    if (x == 0) x = 0x9E3779B9UL;
+    x ^= (x << 13) & 0xFFFFFFFFUL;
+    x ^= x >> 17;
+    x ^= (x << 5) & 0xFFFFFFFFUL;
+    *state = x;
+    return x;
+}
+
+static const char *FirstNames[] = {
+    "Noa", "David", "Maya", "Ariel", "Yael", "Omer", "Tamar", "Itay",
+    "Shira", "Yosef", "Lior", "Adam", "Michal", "Eitan", "Roni", "Daniel"
+};
+
+static const char *LastNames[] = {
+    "Cohen", "Levi", "Mizrahi", "Peretz", "Biton", "Dahan", "Avraham", "Friedman",
+    "Azulay", "Katz", "Yosef", "Amar", "Ohayon", "Hadad", "Gabay", "Ben-David"
+};
+
+int BenchWriteRoster(const char *path, size_t count, unsigned long seed) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror("Failed to create roster");
+        return 0;
+    }
+
+    unsigned long state = seed;
+    for (size_t i = 0; i < count; i++) {
+        // The running number keeps names unique and well under MAX_NAME
+        fprintf(file, "%s%lu %s 05%08lu %lu %lu",
+                FirstNames[BenchRandom(&state) % 16], (unsigned long)i,
+                LastNames[BenchRandom(&state) % 16],
+                BenchRandom(&state) % 100000000UL,
+                1 + BenchRandom(&state) % 12, 1 + BenchRandom(&state) % 10);
+        for (int course = 0; course < 10; course++) {
+            fprintf(file, " %lu", BenchRandom(&state) % 101);
+        }
+        fputc('\n', file);
+    }
+
+    if (fclose(file) != 0) {
+        perror("Failed to write roster");
+        return 0;
+    }
+    return 1;
+}
+
+int BenchOpenReport(BenchReport *report, const char *path, const char *name) {
+    // The code under test prints to stdout, so results always go to a file
+    report->file = fopen(path, "w");
+    if (!report->file) {
+        perror("Failed to open the results file");
+        return 0;
+    }
+
+    report->writer = cJSONStream_CreateFileWriter(report->file, 1);
+    if (!report->writer) {
+        fclose(report->file);
+        return 0;
+    }
+
+    cJSONStream_BeginObject(report->writer);
+    cJSONStream_Key(report->writer, "benchmark");
+    cJSONStream_String(report->writer, name);
+    cJSONStream_Key(report->writer, "results");
+    cJSONStream_BeginArray(report->writer);
+    return 1;
+}
+
+void BenchRecord(BenchReport *report, const char *operation, size_t size, size_t operations, double seconds, size_t bytes) {
+    cJSONStream_BeginObject(report->writer);
+    cJSONStream_Key(report->writer, "operation");
+    cJSONStream_String(report->writer, operation);
+    cJSONStream_Key(report->writer, "size");
+    cJSONStream_Number(report->writer, (double)size);
+    cJSONStream_Key(report->writer, "operations");
+    cJSONStream_Number(report->writer, (double)operations);
+    cJSONStream_Key(report->writer, "seconds");
+    cJSONStream_Number(report->writer, seconds);
+    cJSONStream_Key(report->writer, "ns_per_op");
+    cJSONStream_Number(report->writer, operations > 0 ? seconds * 1e9 / (double)operations : 0);
+    if (bytes != 0) {
+        cJSONStream_Key(report->writer, "bytes");
+        cJSONStream_Number(report->writer, (double)bytes);
+    }
+    cJSONStream_EndObject(report->writer);
+
+    // Progress goes to stderr, away from what the code under test prints
+    fprintf(stderr, "%-28s %10lu  %12.1f ns/op\n", operation, (unsigned long)size,
+            operations > 0 ? seconds * 1e9 / (double)operations : 0);
+}
+
+int BenchCloseReport(BenchReport *report) {
+    cJSONStream_EndArray(report->writer);
+    cJSONStream_EndObject(report->writer);
+
+    int ok = cJSONStream_Flush(report->writer);
+    cJSONStream_DeleteWriter(report->writer);
+    ok = fputc('\n', report->file) != EOF && ok;
+    ok = fclose(report->file) == 0 && ok;
+    if (!ok) {
+        fprintf(stderr, "Failed to write the results.\n");
+    }
+    return ok;
+}
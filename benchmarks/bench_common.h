@@ -0,0 +1,45 @@
+#ifndef CHECKPOINT_BENCH_COMMON_H
+#define CHECKPOINT_BENCH_COMMON_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "cJSON_Stream.h"
+
+// Roster sizes every benchmark walks through, up to --max-size
+#define BENCH_DEFAULT_MAX_SIZE 1000000
+
+typedef struct {
+    size_t maxSize;          // largest roster size to run (1K, 10K, ... up to this)
+    unsigned long seed;      // seed for the generated data
+    const char *outputPath;  // where the JSON results go
+} BenchOptions;
+
+typedef struct {
+    FILE *file;
+    cJSON_StreamWriter *writer;
+} BenchReport;
+
+// Parses --max-size N, --seed N and --output PATH. Returns 0 on a bad command line.
+int BenchParseOptions(int argc, char **argv, const char *defaultOutput, BenchOptions *options);
+
+// Sizes 1K, 10K, ... 10M that are not above maxSize, returns how many were written
+int BenchSizes(size_t maxSize, size_t sizes[], int capacity);
+
+// Monotonic time in seconds
+double BenchNow(void);
+
+// Small deterministic generator, so every run measures the same data
+unsigned long BenchRandom(unsigned long *state);
+
+// Writes count students in the "first last phone grade class g0..g9" layout read_data_from_file reads.
+// Names are unique, so every student can be found again.
+int BenchWriteRoster(const char *path, size_t count, unsigned long seed);
+
+// Results look like
+// {"benchmark": name, "results": [{"operation": ..., "size": ..., "operations": ..., "seconds": ..., "ns_per_op": ...}]}
+int BenchOpenReport(BenchReport *report, const char *path, const char *name);
+// bytes is added to the entry when it isn't 0
+void BenchRecord(BenchReport *report, const char *operation, size_t size, size_t operations, double seconds, size_t bytes);
+int BenchCloseReport(BenchReport *report);
+
+#endif //CHECKPOINT_BENCH_COMMON_H
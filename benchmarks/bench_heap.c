@@ -0,0 +1,120 @@
+// Times the heap ranking: insert, SiftUp/SiftDown and saving/loading the heap matrix
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FixedSizeHeap.h"
+#include "bench_common.h"
+
+#define MatrixJsonPath "bench_matrix.json"
+#define MatrixBinaryPath "bench_matrix.bin"
+// Students are generated in batches outside the timed part
+#define Batch 4096
+
+static long FileSize(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return 0;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size < 0 ? 0 : size;
+}
+
+static void RunSize(BenchReport *report, size_t size, unsigned long seed) {
+    static Student batch[Batch];
+    static int grades[Batch];
+    static HeapMatrix matrix;
+    unsigned long state = seed;
+    double elapsed = 0;
+
+    for (int grade = 0; grade < MAX_GRADES; grade++) {
+        for (int course = 0; course < SUBJECTS; course++) {
+            GetOrCreateHeap(matrix, grade, course);
+        }
+    }
+    for (size_t done = 0; done < size; done += Batch) {
+        size_t n = size - done < Batch ? size - done : Batch;
+        for (size_t i = 0; i < n; i++) {
+            Student *student = &batch[i];
+            memset(student, 0, sizeof(*student));
+            snprintf(student->first_name, MAX_NAME, "First%lu", (unsigned long)(done + i));
+            snprintf(student->last_name, MAX_NAME, "Last%lu", BenchRandom(&state) % 1000);
+            strcpy(student->phone, "0501234567");
+            student->grade = 1 + (int)(BenchRandom(&state) % 12);
+            student->class = 1 + (int)(BenchRandom(&state) % 10);
+            for (int course = 0; course < 10; course++) {
+                student->grades[course] = (int)(BenchRandom(&state) % 101);
+            }
+        }
+
+        double start = BenchNow();
+        for (size_t i = 0; i < n; i++) {
+            for (int course = 0; course < 10; course++) {
+                insert(matrix[batch[i].grade - 1][course], &batch[i]);
+            }
+        }
+        elapsed += BenchNow() - start;
+    }
+    BenchRecord(report, "heap_insert", size, size * 10, elapsed, 0);
+
+    // Give the last (or first) entry a new grade and let the heap restore its order
+    for (int i = 0; i < Batch; i++) {
+        grades[i] = (int)(BenchRandom(&state) % 101);
+    }
+    double start = BenchNow();
+    for (size_t i = 0; i < size; i++) {
+        FixedSizeMaxHeap *heap = matrix[i % 12][(i / 12) % 10];
+        if (heap->FilledIndex > 0) {
+            heap->students[heap->FilledIndex - 1].grades[heap->CourseNumber] = grades[i % Batch];
+            SiftUp(heap);
+        }
+    }
+    BenchRecord(report, "SiftUp", size, size, BenchNow() - start, 0);
+
+    start = BenchNow();
+    for (size_t i = 0; i < size; i++) {
+        FixedSizeMaxHeap *heap = matrix[i % 12][(i / 12) % 10];
+        if (heap->FilledIndex > 0) {
+            heap->students[0].grades[heap->CourseNumber] = grades[i % Batch];
+            SiftDown(heap);
+        }
+    }
+    BenchRecord(report, "SiftDown", size, size, BenchNow() - start, 0);
+
+    // The matrix holds at most 12 * 10 * MaxSize students, whatever the roster size
+    remove(MatrixJsonPath);
+    start = BenchNow();
+    SaveHeapMatrixToJson(matrix, MatrixJsonPath);
+    BenchRecord(report, "SaveHeapMatrixToJson", size, 1, BenchNow() - start, (size_t)FileSize(MatrixJsonPath));
+
+    start = BenchNow();
+    LoadHeapMatrixFromJson(matrix, MatrixJsonPath);
+    BenchRecord(report, "LoadHeapMatrixFromJson", size, 1, BenchNow() - start, 0);
+
+    start = BenchNow();
+    SaveHeapMatrixToBinary(matrix, MatrixBinaryPath);
+    BenchRecord(report, "SaveHeapMatrixToBinary", size, 1, BenchNow() - start, (size_t)FileSize(MatrixBinaryPath));
+
+    start = BenchNow();
+    LoadHeapMatrixFromBinary(matrix, MatrixBinaryPath);
+    BenchRecord(report, "LoadHeapMatrixFromBinary", size, 1, BenchNow() - start, 0);
+
+    FreeHeapMatrix(matrix);
+    remove(MatrixJsonPath);
+    remove(MatrixBinaryPath);
+}
+
+int main(int argc, char **argv) {
+    BenchOptions options;
+    if (!BenchParseOptions(argc, argv, "bench_heap.json", &options)) return 1;
+
+    BenchReport report;
+    if (!BenchOpenReport(&report, options.outputPath, "heap")) return 1;
+
+    size_t sizes[8];
+    int count = BenchSizes(options.maxSize, sizes, 8);
+    for (int i = 0; i < count; i++) {
+        RunSize(&report, sizes[i], options.seed);
+    }
+
+    return BenchCloseReport(&report) ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+// Times building, printing and parsing a roster as a cJSON array of student objects
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "cJSON_Pool.h"
+#include "cJSON_Parallel.h"
+#include "bench_common.h"
+
+#define ParallelThreads 4
+
+static cJSON *BuildRoster(size_t size, unsigned long seed) {
+    unsigned long state = seed;
+    char text[32];
+    int grades[10];
+
+    cJSON *roster = cJSON_CreateArray();
+    for (size_t i = 0; roster && i < size; i++) {
+        cJSON *student = cJSON_CreateObject();
+        if (!student) goto fail;
+        cJSON_AddItemToArray(roster, student);
+
+        snprintf(text, sizeof(text), "First%lu", (unsigned long)i);
+        if (!cJSON_AddStringToObjectCS(student, "first_name", text)) goto fail;
+        snprintf(text, sizeof(text), "Last%lu", BenchRandom(&state) % 1000);
+        if (!cJSON_AddStringToObjectCS(student, "last_name", text)) goto fail;
+        snprintf(text, sizeof(text), "05%08lu", BenchRandom(&state) % 100000000UL);
+        if (!cJSON_AddStringToObjectCS(student, "phone", text)) goto fail;
+        if (!cJSON_AddNumberToObjectCS(student, "grade", (double)(1 + BenchRandom(&state) % 12))) goto fail;
+        if (!cJSON_AddNumberToObjectCS(student, "class", (double)(1 + BenchRandom(&state) % 10))) goto fail;
+        for (int course = 0; course < 10; course++) {
+            grades[course] = (int)(BenchRandom(&state) % 101);
+        }
+        cJSON *array = cJSON_CreateIntArray(grades, 10);
+        if (!array) goto fail;
+        cJSON_AddItemToObjectCS(student, "grades", array);
+    }
+    return roster;
+
+fail:
+    cJSON_Delete(roster);
+    return NULL;
+}
+
+static int RunSize(BenchReport *report, size_t size, unsigned long seed) {
+    double start = BenchNow();
+    cJSON *roster = BuildRoster(size, seed);
+    BenchRecord(report, "cjson_build", size, size, BenchNow() - start, 0);
+    if (!roster) return 0;
+
+    start = BenchNow();
+    char *formatted = cJSON_Print(roster);
+    double elapsed = BenchNow() - start;
+    BenchRecord(report, "cjson_print", size, size, elapsed, formatted ? strlen(formatted) : 0);
+    cJSON_free(formatted);
+
+    start = BenchNow();
+    char *text = cJSON_PrintUnformatted(roster);
+    elapsed = BenchNow() - start;
+    size_t length = text ? strlen(text) : 0;
+    BenchRecord(report, "cjson_print_unformatted", size, size, elapsed, length);
+
+    start = BenchNow();
+    cJSON_Delete(roster);
+    BenchRecord(report, "cjson_delete", size, size, BenchNow() - start, 0);
+    if (!text) return 0;
+
+    start = BenchNow();
+    cJSON *parsed = cJSON_ParseWithLength(text, length);
+    BenchRecord(report, "cjson_parse", size, size, BenchNow() - start, length);
+    int ok = parsed != NULL;
+    cJSON_Delete(parsed);
+
+    start = BenchNow();
+    parsed = cJSONParallel_ParseArray(text, length, ParallelThreads);
+    BenchRecord(report, "cjson_parse_parallel", size, size, BenchNow() - start, length);
+    ok = ok && parsed != NULL;
+    cJSON_Delete(parsed);
+
+    cJSON_free(text);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    BenchOptions options;
+    if (!BenchParseOptions(argc, argv, "bench_json.json", &options)) return 1;
+
+    // Same allocator as the application
+    cJSON_Hooks hooks;
+    cJSONPool_GetHooks(&hooks);
+    cJSON_InitHooks(&hooks);
+
+    BenchReport report;
+    if (!BenchOpenReport(&report, options.outputPath, "cjson")) return 1;
+
+    size_t sizes[8];
+    int count = BenchSizes(options.maxSize, sizes, 8);
+    int ok = 1;
+    for (int i = 0; i < count && ok; i++) {
+        ok = RunSize(&report, sizes[i], options.seed);
+    }
+
+    return BenchCloseReport(&report) && ok ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+// Times read_data_from_file, find, find_by_phone, apply_grade_updates, insert_student and insert_students
+// on generated rosters
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "student_management_system.h"
+#include "FixedSizeHeap.h"
+#include "bench_common.h"
+
+#define RosterPath "bench_roster.txt"
+// Lookups per size, so the biggest rosters don't spend minutes in find
+#define MaxLookups 1000000
+
+// Flattens the class arrays, returns how many students were collected
+static size_t CollectStudents(School *school, Student **students) {
+    size_t count = 0;
+    for (int grade = 0; grade < MAX_GRADES; grade++) {
+        for (int class = 0; class < MAX_CLASSES; class++) {
+            Class *current = &school->grades[grade].classes[class];
+            for (int i = 0; i < current->num_students; i++) {
+                students[count++] = current->students[i];
+            }
+        }
+    }
+    return count;
+}
+
+// Copies of the students for a school of their own, NULL when out of memory
+static Student **CopyStudents(Student **students, size_t count) {
+    Student **copies = malloc(count * sizeof(Student *));
+    if (!copies) return NULL;
+    for (size_t i = 0; i < count; i++) {
+        copies[i] = malloc(sizeof(Student));
+        if (!copies[i]) {
+            while (i > 0) free(copies[--i]);
+            free(copies);
+            return NULL;
+        }
+        *copies[i] = *students[i];
+        copies[i]->next = NULL;
+        copies[i]->next_by_phone = NULL;
+    }
+    return copies;
+}
+
+static int RunSize(BenchReport *report, size_t size, unsigned long seed) {
+    if (!BenchWriteRoster(RosterPath, size, seed)) return 0;
+
+    // read_data_from_file only fills the heaps when there is no saved matrix yet
+    remove(MatrixPath);
+
+    double start = BenchNow();
+    School *school = read_data_from_file(RosterPath);
+    BenchRecord(report, "read_data_from_file", size, size, BenchNow() - start, 0);
+    if (!school) return 0;
+
+    Student **students = malloc(size * sizeof(Student *));
+    if (!students) {
+        destroySchool(school);
+        return 0;
+    }
+    size_t count = CollectStudents(school, students);
+    size_t lookups = count < MaxLookups ? count : MaxLookups;
+    size_t found = 0;
+
+    // Visit the students in a scattered order, 7919 is prime so every index comes up
+    start = BenchNow();
+    for (size_t i = 0; i < lookups; i++) {
+        Student *student = students[(i * 7919) % count];
+        found += find(school, student->first_name, student->last_name) != NULL;
+    }
+    BenchRecord(report, "find_hit", size, lookups, BenchNow() - start, 0);
+
+    char lastName[MAX_NAME];
+    start = BenchNow();
+    for (size_t i = 0; i < lookups; i++) {
+        snprintf(lastName, sizeof(lastName), "Nobody%lu", (unsigned long)i);
+        found += find(school, students[i % count]->first_name, lastName) != NULL;
+    }
+    BenchRecord(report, "find_miss", size, lookups, BenchNow() - start, 0);
+    if (found != lookups) {
+        fprintf(stderr, "find returned %lu of %lu students\n", (unsigned long)found, (unsigned long)lookups);
+    }
+
+    // Random phones can repeat, so a hit may be another student with the same number
+    found = 0;
+    start = BenchNow();
+    for (size_t i = 0; i < lookups; i++) {
+        found += find_by_phone(school, students[(i * 7919) % count]->phone) != NULL;
+    }
+    BenchRecord(report, "find_by_phone", size, lookups, BenchNow() - start, 0);
+    if (found != lookups) {
+        fprintf(stderr, "find_by_phone returned %lu of %lu students\n", (unsigned long)found, (unsigned long)lookups);
+    }
+
+    // One exam's results, a row for every looked up student
+    GradeUpdate *updates = malloc(lookups * sizeof(GradeUpdate));
+    if (updates) {
+        for (size_t i = 0; i < lookups; i++) {
+            const Student *student = students[(i * 7919) % count];
+            strcpy(updates[i].first_name, student->first_name);
+            strcpy(updates[i].last_name, student->last_name);
+            updates[i].subject = 1 + (int)(i % SUBJECTS);
+            updates[i].grade = (int)((i * 31) % 101);
+        }
+        start = BenchNow();
+        int applied = apply_grade_updates(school, updates, (int)lookups);
+        BenchRecord(report, "apply_grade_updates", size, lookups, BenchNow() - start, 0);
+        if ((size_t)applied != lookups) {
+            fprintf(stderr, "apply_grade_updates applied %d of %lu rows\n", applied, (unsigned long)lookups);
+        }
+        free(updates);
+    }
+
+    // Both inserts link the records into their hash chains, so they get copies
+    School *copy = create_school();
+    Student **copies = copy ? CopyStudents(students, count) : NULL;
+    if (copies) {
+        start = BenchNow();
+        for (size_t i = 0; i < count; i++) {
+            insert_student(copy, copies[i]);
+        }
+        BenchRecord(report, "insert_student", size, count, BenchNow() - start, 0);
+        free(copies);
+    }
+    if (copy) destroySchool(copy);
+
+    // In batches of the size read_data_from_file uses
+    copy = create_school();
+    copies = copy ? CopyStudents(students, count) : NULL;
+    if (copies) {
+        start = BenchNow();
+        for (size_t i = 0; i < count; i += 1024) {
+            insert_students(copy, copies + i, count - i < 1024 ? (int)(count - i) : 1024);
+        }
+        BenchRecord(report, "insert_students", size, count, BenchNow() - start, 0);
+        free(copies);
+    }
+    if (copy) destroySchool(copy);
+
+    free(students);
+    destroySchool(school);
+    remove(MatrixPath);
+    remove(RosterPath);
+    return 1;
+}
+
+int main(int argc, char **argv) {
+    BenchOptions options;
+    if (!BenchParseOptions(argc, argv, "bench_school.json", &options)) return 1;
+
+    BenchReport report;
+    if (!BenchOpenReport(&report, options.outputPath, "school")) return 1;
+
+    size_t sizes[8];
+    int count = BenchSizes(options.maxSize, sizes, 8);
+    int ok = 1;
+    for (int i = 0; i < count && ok; i++) {
+        ok = RunSize(&report, sizes[i], options.seed);
+    }
+
+    return BenchCloseReport(&report) && ok ? 0 : 1;
+}
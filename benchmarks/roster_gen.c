@@ -0,0 +1,421 @@
+// Synthetic roster and operation trace generator
+//
+// Rosters use the "first last phone grade class g0..g9" layout read_data_from_file reads.
+// First and last names are drawn from pools with a Zipf distribution, so common names
+// repeat the way they do in real schools and pile up in the same hash() buckets.
+// Every student is a pure function of (seed, index), so traces can refer to roster
+// students without keeping the roster in memory and any size can be written.
+//
+// Trace lines:
+//   insert first last phone grade class g0..g9
+//   delete first last
+//   edit first last course grade
+//   find first last
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "student_management_system.h"
+
+#define OutputBufferSize (1 << 20)
+#define NameLength 12
+
+typedef struct {
+    double mean;
+    double stddev;
+} GradeDistribution;
+
+typedef struct {
+    uint64_t seed;
+    uint64_t students;
+    double zipfExponent;
+    int namePool;
+    GradeDistribution courses[SUBJECTS];
+    char (*firstNames)[NameLength];
+    char (*lastNames)[NameLength];
+    double *nameCdf;         // cumulative Zipf weights over the name pools
+} Generator;
+
+typedef struct {
+    const char *first;
+    const char *last;
+    unsigned long phone;
+    int grade;
+    int class;
+    int grades[SUBJECTS];
+} GenStudent;
+
+typedef struct {
+    FILE *file;
+    char *buffer;
+    size_t used;
+    int failed;
+} Output;
+
+// splitmix64, used both to seed per student streams and as the stream itself
+static uint64_t NextRandom(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [0, 1)
+static double NextUniform(uint64_t *state) {
+    return (double)(NextRandom(state) >> 11) / 9007199254740992.0;
+}
+
+static int NextGrade(uint64_t *state, const GradeDistribution *distribution) {
+    // Box-Muller, 1 - u keeps the logarithm away from 0
+    double u = 1.0 - NextUniform(state);
+    double v = NextUniform(state);
+    double value = distribution->mean + distribution->stddev * sqrt(-2.0 * log(u)) * cos(6.283185307179586 * v);
+    if (value < 0) return 0;
+    if (value > 100) return 100;
+    return (int)(value + 0.5);
+}
+
+static int NextName(uint64_t *state, const Generator *generator) {
+    double u = NextUniform(state);
+    int low = 0, high = generator->namePool - 1;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (generator->nameCdf[middle] <= u) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+static void MakeStudent(const Generator *generator, uint64_t index, GenStudent *student) {
+    uint64_t state = generator->seed ^ (index * 0xD1B54A32D192ED03ULL);
+    NextRandom(&state);
+
+    student->first = generator->firstNames[NextName(&state, generator)];
+    student->last = generator->lastNames[NextName(&state, generator)];
+    student->phone = (unsigned long)(NextRandom(&state) % 100000000ULL);
+    student->grade = 1 + (int)(NextRandom(&state) % MAX_GRADES);
+    student->class = 1 + (int)(NextRandom(&state) % MAX_CLASSES);
+    for (int course = 0; course < SUBJECTS; course++) {
+        student->grades[course] = NextGrade(&state, &generator->courses[course]);
+    }
+}
+
+// Pronounceable names out of two or three syllables, the same pool for the same seed
+static void MakeNamePool(char (*names)[NameLength], int count, uint64_t seed) {
+    static const char *syllables[] = {
+        "ba", "da", "el", "ga", "ha", "ir", "ka", "li", "ma", "na", "or", "ra",
+        "sa", "ta", "vi", "ya", "zo", "ben", "dan", "lev", "mor", "ron", "tal", "yam"
+    };
+    uint64_t state = seed;
+    for (int i = 0; i < count; i++) {
+        int parts = 2 + (int)(NextRandom(&state) % 2);
+        names[i][0] = '\0';
+        for (int part = 0; part < parts; part++) {
+            strcat(names[i], syllables[NextRandom(&state) % 24]);
+        }
+        names[i][0] = (char)(names[i][0] - 'a' + 'A');
+    }
+}
+
+static int InitGenerator(Generator *generator) {
+    int count = generator->namePool;
+    generator->firstNames = malloc((size_t)count * sizeof(*generator->firstNames));
+    generator->lastNames = malloc((size_t)count * sizeof(*generator->lastNames));
+    generator->nameCdf = malloc((size_t)count * sizeof(double));
+    if (!generator->firstNames || !generator->lastNames || !generator->nameCdf) {
+        return 0;
+    }
+
+    MakeNamePool(generator->firstNames, count, generator->seed * 31 + 1);
+    MakeNamePool(generator->lastNames, count, generator->seed * 31 + 2);
+
+    double total = 0;
+    for (int i = 0; i < count; i++) {
+        total += 1.0 / pow(i + 1, generator->zipfExponent);
+        generator->nameCdf[i] = total;
+    }
+    for (int i = 0; i < count; i++) {
+        generator->nameCdf[i] /= total;
+    }
+    return 1;
+}
+
+static void FreeGenerator(Generator *generator) {
+    free(generator->firstNames);
+    free(generator->lastNames);
+    free(generator->nameCdf);
+}
+
+static int OpenOutput(Output *output, const char *path) {
+    output->file = fopen(path, "wb");
+    output->buffer = malloc(OutputBufferSize);
+    output->used = 0;
+    output->failed = 0;
+    if (!output->file || !output->buffer) {
+        perror(path);
+        if (output->file) fclose(output->file);
+        free(output->buffer);
+        return 0;
+    }
+    return 1;
+}
+
+static void FlushOutput(Output *output) {
+    if (output->used > 0 && fwrite(output->buffer, 1, output->used, output->file) != output->used) {
+        output->failed = 1;
+    }
+    output->used = 0;
+}
+
+static int CloseOutput(Output *output) {
+    FlushOutput(output);
+    if (fclose(output->file) != 0) output->failed = 1;
+    free(output->buffer);
+    return !output->failed;
+}
+
+// Every piece is far smaller than the buffer, so making room once per line is enough
+static void Reserve(Output *output, size_t length) {
+    if (output->used + length > OutputBufferSize) FlushOutput(output);
+}
+
+static void PutText(Output *output, const char *text) {
+    size_t length = strlen(text);
+    memcpy(output->buffer + output->used, text, length);
+    output->used += length;
+}
+
+static void PutChar(Output *output, char c) {
+    output->buffer[output->used++] = c;
+}
+
+static void PutNumber(Output *output, unsigned long value, int width) {
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count < width) digits[count++] = '0';
+    while (count > 0) output->buffer[output->used++] = digits[--count];
+}
+
+static void PutName(Output *output, const GenStudent *student) {
+    PutText(output, student->first);
+    PutChar(output, ' ');
+    PutText(output, student->last);
+}
+
+static void PutStudent(Output *output, const GenStudent *student) {
+    PutName(output, student);
+    PutText(output, " 05");
+    PutNumber(output, student->phone, 8);
+    PutChar(output, ' ');
+    PutNumber(output, (unsigned long)student->grade, 0);
+    PutChar(output, ' ');
+    PutNumber(output, (unsigned long)student->class, 0);
+    for (int course = 0; course < SUBJECTS; course++) {
+        PutChar(output, ' ');
+        PutNumber(output, (unsigned long)student->grades[course], 0);
+    }
+    PutChar(output, '\n');
+}
+
+static int WriteRoster(const Generator *generator, const char *path) {
+    Output output;
+    if (!OpenOutput(&output, path)) return 0;
+
+    GenStudent student;
+    for (uint64_t i = 0; i < generator->students && !output.failed; i++) {
+        MakeStudent(generator, i, &student);
+        Reserve(&output, 256);
+        PutStudent(&output, &student);
+    }
+    return CloseOutput(&output);
+}
+
+enum { OpFind, OpEdit, OpInsert, OpDelete, OpCount };
+static const char *OpNames[OpCount] = {"find", "edit", "insert", "delete"};
+
+static int WriteTrace(const Generator *generator, const char *path, uint64_t operations, const int mix[OpCount]) {
+    Output output;
+    if (!OpenOutput(&output, path)) return 0;
+
+    int total = 0;
+    for (int op = 0; op < OpCount; op++) total += mix[op];
+
+    // Inserted students continue the roster's numbering, later operations may pick them too
+    uint64_t population = generator->students;
+    uint64_t state = generator->seed ^ 0x5DEECE66DULL;
+    GenStudent student;
+    for (uint64_t i = 0; i < operations && !output.failed; i++) {
+        int pick = (int)(NextRandom(&state) % (uint64_t)total);
+        int op = 0;
+        while (pick >= mix[op]) pick -= mix[op++];
+
+        Reserve(&output, 256);
+        if (op == OpInsert || population == 0) {
+            MakeStudent(generator, population++, &student);
+            PutText(&output, "insert ");
+            PutStudent(&output, &student);
+            continue;
+        }
+
+        MakeStudent(generator, NextRandom(&state) % population, &student);
+        PutText(&output, OpNames[op]);
+        PutChar(&output, ' ');
+        PutName(&output, &student);
+        if (op == OpEdit) {
+            int course = (int)(NextRandom(&state) % SUBJECTS);
+            PutChar(&output, ' ');
+            PutNumber(&output, (unsigned long)course + 1, 0);
+            PutChar(&output, ' ');
+            PutNumber(&output, (unsigned long)NextGrade(&state, &generator->courses[course]), 0);
+        }
+        PutChar(&output, '\n');
+    }
+    return CloseOutput(&output);
+}
+
+// "find=70,edit=15,insert=10,delete=5", operations left out get weight 0
+static int ParseMix(const char *text, int mix[OpCount]) {
+    for (int op = 0; op < OpCount; op++) mix[op] = 0;
+
+    int total = 0;
+    while (*text) {
+        int op;
+        for (op = 0; op < OpCount; op++) {
+            size_t length = strlen(OpNames[op]);
+            if (strncmp(text, OpNames[op], length) == 0 && text[length] == '=') {
+                text += length + 1;
+                break;
+            }
+        }
+        if (op == OpCount) return 0;
+
+        char *end;
+        long weight = strtol(text, &end, 10);
+        if (end == text || weight < 0 || weight > 1000000) return 0;
+        mix[op] = (int)weight;
+        total += (int)weight;
+        text = *end == ',' ? end + 1 : end;
+        if (*end != ',' && *end != '\0') return 0;
+    }
+    return total > 0;
+}
+
+// "MEAN:STDDEV" for every course, or "C=MEAN:STDDEV" for course C (1-10)
+static int ParseDistribution(const char *text, Generator *generator) {
+    int first = 0, last = SUBJECTS - 1;
+    const char *equals = strchr(text, '=');
+    if (equals) {
+        int course = atoi(text);
+        if (course < 1 || course > SUBJECTS) return 0;
+        first = last = course - 1;
+        text = equals + 1;
+    }
+
+    double mean, stddev;
+    if (sscanf(text, "%lf:%lf", &mean, &stddev) != 2 || stddev < 0) return 0;
+    for (int course = first; course <= last; course++) {
+        generator->courses[course].mean = mean;
+        generator->courses[course].stddev = stddev;
+    }
+    return 1;
+}
+
+static void Usage(const char *program) {
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  --students N         students in the roster (default 1000000)\n"
+            "  --roster PATH        roster file to write\n"
+            "  --trace PATH         operation trace to write\n"
+            "  --operations N       lines in the trace (default 1000000)\n"
+            "  --mix SPEC           trace mix, default find=70,edit=15,insert=10,delete=5\n"
+            "  --seed N             seed, the same seed gives the same files (default 1)\n"
+            "  --names N            distinct first and last names (default 5000)\n"
+            "  --zipf S             Zipf exponent of the name choice, 0 is uniform (default 1.0)\n"
+            "  --grades MEAN:SD     grade distribution of every course (default 75:12)\n"
+            "  --course C=MEAN:SD   grade distribution of course C (1-%d)\n",
+            program, SUBJECTS);
+}
+
+int main(int argc, char **argv) {
+    Generator generator;
+    memset(&generator, 0, sizeof(generator));
+    generator.seed = 1;
+    generator.students = 1000000;
+    generator.zipfExponent = 1.0;
+    generator.namePool = 5000;
+    for (int course = 0; course < SUBJECTS; course++) {
+        generator.courses[course].mean = 75;
+        generator.courses[course].stddev = 12;
+    }
+
+    const char *rosterPath = NULL;
+    const char *tracePath = NULL;
+    uint64_t operations = 1000000;
+    int mix[OpCount] = {70, 15, 10, 5};
+
+    for (int i = 1; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        int ok = value != NULL;
+        if (!ok) {
+            // every option takes a value
+        } else if (strcmp(argv[i], "--students") == 0) {
+            generator.students = strtoull(value, NULL, 10);
+        } else if (strcmp(argv[i], "--roster") == 0) {
+            rosterPath = value;
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            tracePath = value;
+        } else if (strcmp(argv[i], "--operations") == 0) {
+            operations = strtoull(value, NULL, 10);
+        } else if (strcmp(argv[i], "--mix") == 0) {
+            ok = ParseMix(value, mix);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            generator.seed = strtoull(value, NULL, 10);
+        } else if (strcmp(argv[i], "--names") == 0) {
+            generator.namePool = atoi(value);
+            ok = generator.namePool > 0;
+        } else if (strcmp(argv[i], "--zipf") == 0) {
+            generator.zipfExponent = atof(value);
+            ok = generator.zipfExponent >= 0;
+        } else if (strcmp(argv[i], "--grades") == 0 || strcmp(argv[i], "--course") == 0) {
+            ok = ParseDistribution(value, &generator) && (strcmp(argv[i], "--course") == 0) == (strchr(value, '=') != NULL);
+        } else {
+            ok = 0;
+        }
+        if (!ok) {
+            Usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (!rosterPath && !tracePath) {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    if (!InitGenerator(&generator)) {
+        fprintf(stderr, "Out of memory.\n");
+        FreeGenerator(&generator);
+        return 1;
+    }
+
+    int ok = 1;
+    if (rosterPath && !WriteRoster(&generator, rosterPath)) {
+        fprintf(stderr, "Failed to write '%s'.\n", rosterPath);
+        ok = 0;
+    }
+    if (ok && tracePath && !WriteTrace(&generator, tracePath, operations, mix)) {
+        fprintf(stderr, "Failed to write '%s'.\n", tracePath);
+        ok = 0;
+    }
+
+    FreeGenerator(&generator);
+    return ok ? 0 : 1;
+}
@@ -49,6 +49,20 @@
 #include <locale.h>
 #endif
 
+/* SSE2 is part of the x86-64 baseline, AVX2 is selected at runtime.
+ * Define CJSON_DISABLE_SIMD to always use the portable byte-by-byte loops. */
+#if !defined(CJSON_DISABLE_SIMD) && (defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)))
+#define CJSON_SIMD_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define CJSON_SIMD_AVX2
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
 #if defined(_MSC_VER)
 #pragma warning (pop)
 #endif
@@ -206,37 +220,42 @@ static unsigned char* cJSON_strdup(const unsigned char* string, const internal_h
     return copy;
 }
 
-CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks)
+static void set_hooks(internal_hooks * const target, const cJSON_Hooks * const hooks)
 {
     if (hooks == NULL)
     {
         /* Reset hooks */
-        global_hooks.allocate = malloc;
-        global_hooks.deallocate = free;
-        global_hooks.reallocate = realloc;
+        target->allocate = malloc;
+        target->deallocate = free;
+        target->reallocate = realloc;
         return;
     }
 
-    global_hooks.allocate = malloc;
+    target->allocate = malloc;
     if (hooks->malloc_fn != NULL)
     {
-        global_hooks.allocate = hooks->malloc_fn;
+        target->allocate = hooks->malloc_fn;
     }
 
-    global_hooks.deallocate = free;
+    target->deallocate = free;
     if (hooks->free_fn != NULL)
     {
-        global_hooks.deallocate = hooks->free_fn;
+        target->deallocate = hooks->free_fn;
     }
 
     /* use realloc only if both free and malloc are used */
-    global_hooks.reallocate = NULL;
-    if ((global_hooks.allocate == malloc) && (global_hooks.deallocate == free))
+    target->reallocate = NULL;
+    if ((target->allocate == malloc) && (target->deallocate == free))
     {
-        global_hooks.reallocate = realloc;
+        target->reallocate = realloc;
     }
 }
 
+CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks)
+{
+    set_hooks(&global_hooks, hooks);
+}
+
 /* Internal constructor. */
 static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
 {
@@ -249,32 +268,73 @@ static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
     return node;
 }
 
-/* Delete a cJSON structure. */
-CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
+/* Lookup index over the children of an array or object, see get_array_item and get_object_item */
+typedef struct
+{
+    size_t hash; /* hash of the case folded key */
+    cJSON *item;
+} index_slot;
+
+struct cJSON_Index
+{
+    size_t count; /* number of children in the index */
+    size_t capacity; /* number of slots, always a power of two, items has room for half of that */
+    cJSON **items; /* the children in order */
+    index_slot *slots; /* key hashes, NULL unless every child has a key */
+    internal_hooks hooks; /* of whoever asked for the index, it is regrown and freed with them */
+};
+
+/* Throw away the index of an item, lookups walk the children again until it is rebuilt. */
+static void drop_index(cJSON * const item)
+{
+    struct cJSON_Index *index = item->index;
+    if (index == NULL)
+    {
+        return;
+    }
+
+    item->index = NULL;
+    if (index->slots != NULL)
+    {
+        index->hooks.deallocate(index->slots);
+    }
+    index->hooks.deallocate(index->items);
+    index->hooks.deallocate(index);
+}
+
+/* Delete a cJSON structure that was allocated with hooks. */
+static void delete_item(cJSON *item, const internal_hooks * const hooks)
 {
     cJSON *next = NULL;
     while (item != NULL)
     {
         next = item->next;
+        drop_index(item);
         if (!(item->type & cJSON_IsReference) && (item->child != NULL))
         {
-            cJSON_Delete(item->child);
+            delete_item(item->child, hooks);
         }
         if (!(item->type & cJSON_IsReference) && (item->valuestring != NULL))
         {
-            global_hooks.deallocate(item->valuestring);
+            hooks->deallocate(item->valuestring);
             item->valuestring = NULL;
         }
         if (!(item->type & cJSON_StringIsConst) && (item->string != NULL))
         {
-            global_hooks.deallocate(item->string);
+            hooks->deallocate(item->string);
             item->string = NULL;
         }
-        global_hooks.deallocate(item);
+        hooks->deallocate(item);
         item = next;
     }
 }
 
+/* Delete a cJSON structure. */
+CJSON_PUBLIC(void) cJSON_Delete(cJSON *item)
+{
+    delete_item(item, &global_hooks);
+}
+
 /* get the decimal point character of the current locale */
 static unsigned char get_decimal_point(void)
 {
@@ -560,22 +620,13 @@ static cJSON_bool compare_double(double a, double b)
     return (fabs(a - b) <= maxVal * DBL_EPSILON);
 }
 
-/* Render the number nicely from the given item into a string. */
-static cJSON_bool print_number(const cJSON * const item, printbuffer * const output_buffer)
+/* Render the number nicely from the given item into number_buffer, returns its length or -1 on failure */
+static int format_number(const cJSON * const item, unsigned char * const number_buffer, const size_t buffer_size)
 {
-    unsigned char *output_pointer = NULL;
     double d = item->valuedouble;
     int length = 0;
-    size_t i = 0;
-    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
-    unsigned char decimal_point = get_decimal_point();
     double test = 0.0;
 
-    if (output_buffer == NULL)
-    {
-        return false;
-    }
-
     /* This checks for NaN and Infinity */
     if (isnan(d) || isinf(d))
     {
@@ -599,7 +650,30 @@ static cJSON_bool print_number(const cJSON * const item, printbuffer * const out
     }
 
     /* sprintf failed or buffer overrun occurred */
-    if ((length < 0) || (length > (int)(sizeof(number_buffer) - 1)))
+    if ((length < 0) || (length > (int)(buffer_size - 1)))
+    {
+        return -1;
+    }
+
+    return length;
+}
+
+/* Render the number nicely from the given item into a string. */
+static cJSON_bool print_number(const cJSON * const item, printbuffer * const output_buffer)
+{
+    unsigned char *output_pointer = NULL;
+    int length = 0;
+    size_t i = 0;
+    unsigned char number_buffer[26] = {0}; /* temporary buffer to print the number into */
+    unsigned char decimal_point = get_decimal_point();
+
+    if (output_buffer == NULL)
+    {
+        return false;
+    }
+
+    length = format_number(item, number_buffer, sizeof(number_buffer));
+    if (length < 0)
     {
         return false;
     }
@@ -788,6 +862,232 @@ fail:
     return 0;
 }
 
+/* String scanning.
+ * scan_unescaped returns how many leading bytes contain neither '\"' nor '\\',
+ * scan_printable how many leading bytes can be printed without escaping.
+ * Both look at no more than length bytes. */
+static size_t scan_unescaped_bytewise(const unsigned char * const input, const size_t length)
+{
+    size_t i = 0;
+    for (i = 0; (i < length) && (input[i] != '\"') && (input[i] != '\\'); i++)
+    {
+    }
+
+    return i;
+}
+
+static size_t scan_printable_bytewise(const unsigned char * const input, const size_t length)
+{
+    size_t i = 0;
+    for (i = 0; (i < length) && (input[i] > 31) && (input[i] != '\"') && (input[i] != '\\'); i++)
+    {
+    }
+
+    return i;
+}
+
+/* whitespace in the cJSON sense is everything up to and including the space character */
+static size_t scan_whitespace_bytewise(const unsigned char * const input, const size_t length)
+{
+    size_t i = 0;
+    for (i = 0; (i < length) && (input[i] <= 32); i++)
+    {
+    }
+
+    return i;
+}
+
+#ifdef CJSON_SIMD_SSE2
+/* index of the lowest set bit, mask must not be 0 */
+static size_t first_set_bit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanForward(&index, mask);
+    return (size_t)index;
+#else
+    return (size_t)__builtin_ctz(mask);
+#endif
+}
+
+static size_t scan_unescaped_sse2(const unsigned char * const input, const size_t length)
+{
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    size_t offset = 0;
+
+    for (; (offset + 16) <= length; offset += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)(input + offset));
+        int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+        if (mask != 0)
+        {
+            return offset + first_set_bit((unsigned int)mask);
+        }
+    }
+
+    return offset + scan_unescaped_bytewise(input + offset, length - offset);
+}
+
+static size_t scan_printable_sse2(const unsigned char * const input, const size_t length)
+{
+    const __m128i quote = _mm_set1_epi8('\"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(31);
+    size_t offset = 0;
+
+    for (; (offset + 16) <= length; offset += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)(input + offset));
+        /* unsigned chunk <= 31 exactly where min(chunk, 31) == chunk */
+        __m128i special = _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk);
+        int mask = 0;
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, quote));
+        special = _mm_or_si128(special, _mm_cmpeq_epi8(chunk, backslash));
+        mask = _mm_movemask_epi8(special);
+        if (mask != 0)
+        {
+            return offset + first_set_bit((unsigned int)mask);
+        }
+    }
+
+    return offset + scan_printable_bytewise(input + offset, length - offset);
+}
+
+static size_t scan_whitespace_sse2(const unsigned char * const input, const size_t length)
+{
+    const __m128i space = _mm_set1_epi8(32);
+    size_t offset = 0;
+
+    for (; (offset + 16) <= length; offset += 16)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(const void*)(input + offset));
+        /* bits are set for everything that is not whitespace */
+        unsigned int mask = ~(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(chunk, space), chunk)) & 0xFFFFu;
+        if (mask != 0)
+        {
+            return offset + first_set_bit(mask);
+        }
+    }
+
+    return offset + scan_whitespace_bytewise(input + offset, length - offset);
+}
+#endif /* CJSON_SIMD_SSE2 */
+
+#ifdef CJSON_SIMD_AVX2
+__attribute__((target("avx2")))
+static size_t scan_unescaped_avx2(const unsigned char * const input, const size_t length)
+{
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    size_t offset = 0;
+
+    for (; (offset + 32) <= length; offset += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(const void*)(input + offset));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)));
+        if (mask != 0)
+        {
+            return offset + first_set_bit(mask);
+        }
+    }
+
+    return offset + scan_unescaped_sse2(input + offset, length - offset);
+}
+
+__attribute__((target("avx2")))
+static size_t scan_printable_avx2(const unsigned char * const input, const size_t length)
+{
+    const __m256i quote = _mm256_set1_epi8('\"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control = _mm256_set1_epi8(31);
+    size_t offset = 0;
+
+    for (; (offset + 32) <= length; offset += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(const void*)(input + offset));
+        __m256i special = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control), chunk);
+        unsigned int mask = 0;
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, quote));
+        special = _mm256_or_si256(special, _mm256_cmpeq_epi8(chunk, backslash));
+        mask = (unsigned int)_mm256_movemask_epi8(special);
+        if (mask != 0)
+        {
+            return offset + first_set_bit(mask);
+        }
+    }
+
+    return offset + scan_printable_sse2(input + offset, length - offset);
+}
+
+__attribute__((target("avx2")))
+static size_t scan_whitespace_avx2(const unsigned char * const input, const size_t length)
+{
+    const __m256i space = _mm256_set1_epi8(32);
+    size_t offset = 0;
+
+    for (; (offset + 32) <= length; offset += 32)
+    {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(const void*)(input + offset));
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(chunk, space), chunk));
+        if (mask != 0)
+        {
+            return offset + first_set_bit(mask);
+        }
+    }
+
+    return offset + scan_whitespace_sse2(input + offset, length - offset);
+}
+
+/* __builtin_cpu_supports only reads data that libgcc initializes at startup, so this is thread safe */
+#define cpu_has_avx2() (__builtin_cpu_supports("avx2"))
+#endif /* CJSON_SIMD_AVX2 */
+
+static size_t scan_unescaped(const unsigned char * const input, const size_t length)
+{
+#if defined(CJSON_SIMD_AVX2)
+    if ((length >= 32) && cpu_has_avx2())
+    {
+        return scan_unescaped_avx2(input, length);
+    }
+#endif
+#if defined(CJSON_SIMD_SSE2)
+    return scan_unescaped_sse2(input, length);
+#else
+    return scan_unescaped_bytewise(input, length);
+#endif
+}
+
+static size_t scan_printable(const unsigned char * const input, const size_t length)
+{
+#if defined(CJSON_SIMD_AVX2)
+    if ((length >= 32) && cpu_has_avx2())
+    {
+        return scan_printable_avx2(input, length);
+    }
+#endif
+#if defined(CJSON_SIMD_SSE2)
+    return scan_printable_sse2(input, length);
+#else
+    return scan_printable_bytewise(input, length);
+#endif
+}
+
+static size_t scan_whitespace(const unsigned char * const input, const size_t length)
+{
+#if defined(CJSON_SIMD_AVX2)
+    if ((length >= 32) && cpu_has_avx2())
+    {
+        return scan_whitespace_avx2(input, length);
+    }
+#endif
+#if defined(CJSON_SIMD_SSE2)
+    return scan_whitespace_sse2(input, length);
+#else
+    return scan_whitespace_bytewise(input, length);
+#endif
+}
+
 /* Parse the input text into an unescaped cinput, and populate item. */
 static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_buffer)
 {
@@ -817,9 +1117,13 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
                     goto fail;
                 }
                 skipped_bytes++;
-                input_end++;
+                input_end += 2;
+            }
+            else
+            {
+                /* skip the whole run of plain characters at once */
+                input_end += scan_unescaped(input_end, input_buffer->length - (size_t)(input_end - input_buffer->content));
             }
-            input_end++;
         }
         if (((size_t)(input_end - input_buffer->content) >= input_buffer->length) || (*input_end != '\"'))
         {
@@ -841,7 +1145,16 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
     {
         if (*input_pointer != '\\')
         {
-            *output_pointer++ = *input_pointer++;
+            /* copy the run up to the next escape sequence in one go */
+            size_t run_length = scan_unescaped(input_pointer, (size_t)(input_end - input_pointer));
+            if (run_length == 0)
+            {
+                /* a '\"' whose backslash was eaten by an invalid \u escape, copied as a plain character */
+                run_length = 1;
+            }
+            memcpy(output_pointer, input_pointer, run_length);
+            output_pointer += run_length;
+            input_pointer += run_length;
         }
         /* escape sequence */
         else
@@ -918,12 +1231,50 @@ fail:
     return false;
 }
 
+/* count the additional characters needed to escape input */
+static size_t count_escape_characters(const unsigned char * const input, const size_t input_length)
+{
+    const unsigned char *input_pointer = NULL;
+    const unsigned char *input_end = input + input_length;
+    size_t escape_characters = 0;
+
+    for (input_pointer = input + scan_printable(input, input_length); input_pointer < input_end; input_pointer++)
+    {
+        switch (*input_pointer)
+        {
+            case '\"':
+            case '\\':
+            case '\b':
+            case '\f':
+            case '\n':
+            case '\r':
+            case '\t':
+                /* one character escape sequence */
+                escape_characters++;
+                break;
+            default:
+                if (*input_pointer < 32)
+                {
+                    /* UTF-16 escape sequence uXXXX */
+                    escape_characters += 5;
+                }
+                break;
+        }
+        /* jump over the following run of characters that don't need escaping */
+        input_pointer += scan_printable(input_pointer + 1, (size_t)(input_end - input_pointer - 1));
+    }
+
+    return escape_characters;
+}
+
 /* Render the cstring provided to an escaped version that can be printed. */
 static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffer * const output_buffer)
 {
     const unsigned char *input_pointer = NULL;
+    const unsigned char *input_end = NULL;
     unsigned char *output = NULL;
     unsigned char *output_pointer = NULL;
+    size_t input_length = 0;
     size_t output_length = 0;
     /* numbers of additional characters needed for escaping */
     size_t escape_characters = 0;
@@ -946,31 +1297,11 @@ static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffe
         return true;
     }
 
-    /* set "flag" to 1 if something needs to be escaped */
-    for (input_pointer = input; *input_pointer; input_pointer++)
-    {
-        switch (*input_pointer)
-        {
-            case '\"':
-            case '\\':
-            case '\b':
-            case '\f':
-            case '\n':
-            case '\r':
-            case '\t':
-                /* one character escape sequence */
-                escape_characters++;
-                break;
-            default:
-                if (*input_pointer < 32)
-                {
-                    /* UTF-16 escape sequence uXXXX */
-                    escape_characters += 5;
-                }
-                break;
-        }
-    }
-    output_length = (size_t)(input_pointer - input) + escape_characters;
+    input_length = strlen((const char*)input);
+    input_end = input + input_length;
+
+    escape_characters = count_escape_characters(input, input_length);
+    output_length = input_length + escape_characters;
 
     output = ensure(output_buffer, output_length + sizeof("\"\""));
     if (output == NULL)
@@ -992,47 +1323,52 @@ static cJSON_bool print_string_ptr(const unsigned char * const input, printbuffe
     output[0] = '\"';
     output_pointer = output + 1;
     /* copy the string */
-    for (input_pointer = input; *input_pointer != '\0'; (void)input_pointer++, output_pointer++)
+    for (input_pointer = input; input_pointer < input_end; (void)input_pointer++, output_pointer++)
     {
-        if ((*input_pointer > 31) && (*input_pointer != '\"') && (*input_pointer != '\\'))
-        {
-            /* normal character, copy */
-            *output_pointer = *input_pointer;
-        }
-        else
+        size_t run_length = scan_printable(input_pointer, (size_t)(input_end - input_pointer));
+        if (run_length > 0)
         {
-            /* character needs to be escaped */
-            *output_pointer++ = '\\';
-            switch (*input_pointer)
+            /* normal characters, copy */
+            memcpy(output_pointer, input_pointer, run_length);
+            output_pointer += run_length;
+            input_pointer += run_length;
+            if (input_pointer == input_end)
             {
-                case '\\':
-                    *output_pointer = '\\';
-                    break;
-                case '\"':
-                    *output_pointer = '\"';
-                    break;
-                case '\b':
-                    *output_pointer = 'b';
-                    break;
-                case '\f':
-                    *output_pointer = 'f';
-                    break;
-                case '\n':
-                    *output_pointer = 'n';
-                    break;
-                case '\r':
-                    *output_pointer = 'r';
-                    break;
-                case '\t':
-                    *output_pointer = 't';
-                    break;
-                default:
-                    /* escape and print as unicode codepoint */
-                    sprintf((char*)output_pointer, "u%04x", *input_pointer);
-                    output_pointer += 4;
-                    break;
+                break;
             }
         }
+
+        /* character needs to be escaped */
+        *output_pointer++ = '\\';
+        switch (*input_pointer)
+        {
+            case '\\':
+                *output_pointer = '\\';
+                break;
+            case '\"':
+                *output_pointer = '\"';
+                break;
+            case '\b':
+                *output_pointer = 'b';
+                break;
+            case '\f':
+                *output_pointer = 'f';
+                break;
+            case '\n':
+                *output_pointer = 'n';
+                break;
+            case '\r':
+                *output_pointer = 'r';
+                break;
+            case '\t':
+                *output_pointer = 't';
+                break;
+            default:
+                /* escape and print as unicode codepoint */
+                sprintf((char*)output_pointer, "u%04x", *input_pointer);
+                output_pointer += 4;
+                break;
+        }
     }
     output[output_length + 1] = '\"';
     output[output_length + 2] = '\0';
@@ -1067,9 +1403,10 @@ static parse_buffer *buffer_skip_whitespace(parse_buffer * const buffer)
         return buffer;
     }
 
-    while (can_access_at_index(buffer, 0) && (buffer_at_offset(buffer)[0] <= 32))
+    /* most calls land directly on a token, only scan when there is something to skip */
+    if (buffer_at_offset(buffer)[0] <= 32)
     {
-       buffer->offset++;
+        buffer->offset += scan_whitespace(buffer_at_offset(buffer), buffer->length - buffer->offset);
     }
 
     if (buffer->offset == buffer->length)
@@ -1111,15 +1448,15 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return
     return cJSON_ParseWithLengthOpts(value, buffer_length, return_parse_end, require_null_terminated);
 }
 
-/* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+/* Parse an object - create a new root, and populate. Allocates with hooks and reports failures in parse_error. */
+static cJSON *parse(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated, const internal_hooks * const hooks, error * const parse_error)
 {
     parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
     cJSON *item = NULL;
 
     /* reset error position */
-    global_error.json = NULL;
-    global_error.position = 0;
+    parse_error->json = NULL;
+    parse_error->position = 0;
 
     if (value == NULL || 0 == buffer_length)
     {
@@ -1129,9 +1466,9 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer
     buffer.content = (const unsigned char*)value;
     buffer.length = buffer_length;
     buffer.offset = 0;
-    buffer.hooks = global_hooks;
+    buffer.hooks = *hooks;
 
-    item = cJSON_New_Item(&global_hooks);
+    item = cJSON_New_Item(hooks);
     if (item == NULL) /* memory fail */
     {
         goto fail;
@@ -1162,7 +1499,7 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer
 fail:
     if (item != NULL)
     {
-        cJSON_Delete(item);
+        delete_item(item, hooks);
     }
 
     if (value != NULL)
@@ -1185,12 +1522,17 @@ fail:
             *return_parse_end = (const char*)local_error.json + local_error.position;
         }
 
-        global_error = local_error;
+        *parse_error = local_error;
     }
 
     return NULL;
 }
 
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+    return parse(value, buffer_length, return_parse_end, require_null_terminated, &global_hooks, &global_error);
+}
+
 /* Default options for cJSON_Parse */
 CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
 {
@@ -1202,6 +1544,121 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_len
     return cJSON_ParseWithLengthOpts(value, buffer_length, 0, 0);
 }
 
+/* add to a printed length, 0 stands for failure (nothing prints as an empty string) */
+static size_t add_length(const size_t length, const size_t addition)
+{
+    if ((length == 0) || (length > INT_MAX) || (addition > (INT_MAX - length)))
+    {
+        return 0;
+    }
+
+    return length + addition;
+}
+
+/* number of characters print_value produces for item at the given nesting depth, 0 on failure.
+ * Printing a fractional number just to measure it costs as much as printing it, so unless exact
+ * is set those are counted with their maximum length instead and the result is an upper bound. */
+static size_t measure_value(const cJSON * const item, const cJSON_bool format, const cJSON_bool exact, const size_t depth)
+{
+    const cJSON *current_item = NULL;
+    unsigned char number_buffer[26] = {0};
+    size_t length = 0;
+    size_t key_length = 0;
+    size_t value_length = 0;
+    int number_length = 0;
+    int integer = 0;
+
+    switch ((item->type) & 0xFF)
+    {
+        case cJSON_NULL:
+        case cJSON_True:
+            return 4;
+
+        case cJSON_False:
+            return 5;
+
+        case cJSON_Number:
+            if (!isnan(item->valuedouble) && !isinf(item->valuedouble) && (item->valuedouble == (double)item->valueint))
+            {
+                /* count the digits instead of printing them */
+                length = (item->valueint < 0) ? 2 : 1;
+                for (integer = item->valueint; (integer >= 10) || (integer <= -10); integer /= 10)
+                {
+                    length++;
+                }
+                return length;
+            }
+            if (!exact)
+            {
+                return sizeof(number_buffer) - 1;
+            }
+            number_length = format_number(item, number_buffer, sizeof(number_buffer));
+            return (number_length < 0) ? 0 : (size_t)number_length;
+
+        case cJSON_Raw:
+            if (item->valuestring == NULL)
+            {
+                return 0;
+            }
+            return strlen(item->valuestring);
+
+        case cJSON_String:
+            if (item->valuestring == NULL)
+            {
+                return sizeof("\"\"") - 1;
+            }
+            length = strlen(item->valuestring);
+            length += count_escape_characters((const unsigned char*)item->valuestring, length);
+            return add_length(sizeof("\"\"") - 1, length);
+
+        case cJSON_Array:
+            length = sizeof("[]") - 1;
+            for (current_item = item->child; current_item != NULL; current_item = current_item->next)
+            {
+                value_length = measure_value(current_item, format, exact, depth + 1);
+                if (value_length == 0)
+                {
+                    return 0;
+                }
+                length = add_length(length, value_length);
+                if (current_item->next != NULL)
+                {
+                    length = add_length(length, format ? 2 : 1); /* ", " or "," */
+                }
+            }
+            return length;
+
+        case cJSON_Object:
+            /* "{" "\n" and depth tabs before "}" when formatted */
+            length = format ? (sizeof("{\n}") - 1 + depth) : (sizeof("{}") - 1);
+            for (current_item = item->child; current_item != NULL; current_item = current_item->next)
+            {
+                if (current_item->string == NULL)
+                {
+                    key_length = sizeof("\"\"") - 1;
+                }
+                else
+                {
+                    key_length = strlen(current_item->string);
+                    key_length += count_escape_characters((const unsigned char*)current_item->string, key_length) + sizeof("\"\"") - 1;
+                }
+                /* indentation, key, ":" "\t", value, "," and "\n" */
+                length = add_length(length, format ? (depth + 1 + key_length + 2) : (key_length + 1));
+                value_length = measure_value(current_item, format, exact, depth + 1);
+                if (value_length == 0)
+                {
+                    return 0;
+                }
+                length = add_length(length, value_length);
+                length = add_length(length, (size_t)(format ? 1 : 0) + (size_t)(current_item->next ? 1 : 0));
+            }
+            return length;
+
+        default:
+            return 0;
+    }
+}
+
 #define cjson_min(a, b) (((a) < (b)) ? (a) : (b))
 
 static unsigned char *print(const cJSON * const item, cJSON_bool format, const internal_hooks * const hooks)
@@ -1209,12 +1666,27 @@ static unsigned char *print(const cJSON * const item, cJSON_bool format, const i
     static const size_t default_buffer_size = 256;
     printbuffer buffer[1];
     unsigned char *printed = NULL;
+    size_t measured_length = 0;
 
     memset(buffer, 0, sizeof(buffer));
 
-    /* create buffer */
-    buffer->buffer = (unsigned char*) hooks->allocate(default_buffer_size);
     buffer->length = default_buffer_size;
+    if ((hooks->reallocate == NULL) && (item != NULL))
+    {
+        /* without realloc every growth of the buffer copies it, and so does the final
+         * shrink. Measure the output first instead, so it is printed into a single
+         * allocation that can be returned as it is. ensure always wants one byte
+         * more than the terminator. */
+        measured_length = measure_value(item, format, false, 0);
+        if (measured_length == 0)
+        {
+            goto fail;
+        }
+        buffer->length = measured_length + 2;
+    }
+
+    /* create buffer */
+    buffer->buffer = (unsigned char*) hooks->allocate(buffer->length);
     buffer->format = format;
     buffer->hooks = *hooks;
     if (buffer->buffer == NULL)
@@ -1238,6 +1710,12 @@ static unsigned char *print(const cJSON * const item, cJSON_bool format, const i
         }
         buffer->buffer = NULL;
     }
+    else if (measured_length != 0)
+    {
+        /* already in a buffer of (about) the right size */
+        printed = buffer->buffer;
+        buffer->buffer = NULL;
+    }
     else /* otherwise copy the JSON over to a new buffer */
     {
         printed = (unsigned char*) hooks->allocate(buffer->offset + 1);
@@ -1303,14 +1781,32 @@ CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON
     p.format = fmt;
     p.hooks = global_hooks;
 
-    if (!print_value(item, &p))
+    if (!print_value(item, &p))
+    {
+        global_hooks.deallocate(p.buffer);
+        p.buffer = NULL;
+        return NULL;
+    }
+
+    return (char*)p.buffer;
+}
+
+CJSON_PUBLIC(size_t) cJSON_GetPrintBufferSize(const cJSON *item, const cJSON_bool format)
+{
+    size_t printed_length = 0;
+
+    if (item == NULL)
     {
-        global_hooks.deallocate(p.buffer);
-        p.buffer = NULL;
-        return NULL;
+        return 0;
     }
 
-    return (char*)p.buffer;
+    printed_length = measure_value(item, format, true, 0);
+    if (printed_length == 0)
+    {
+        return 0;
+    }
+
+    return printed_length + 2;
 }
 
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format)
@@ -1553,7 +2049,7 @@ success:
 fail:
     if (head != NULL)
     {
-        cJSON_Delete(head);
+        delete_item(head, &input_buffer->hooks);
     }
 
     return false;
@@ -1733,7 +2229,7 @@ success:
 fail:
     if (head != NULL)
     {
-        cJSON_Delete(head);
+        delete_item(head, &input_buffer->hooks);
     }
 
     return false;
@@ -1853,6 +2349,182 @@ static cJSON_bool print_object(const cJSON * const item, printbuffer * const out
     return true;
 }
 
+static void* cast_away_const(const void* string);
+
+/* FNV-1a over the lower case key, so case insensitive matches land in the same probe sequence */
+static size_t hash_key(const unsigned char *key)
+{
+    size_t hash = (size_t)2166136261u;
+    for (; *key != '\0'; key++)
+    {
+        hash ^= (size_t)tolower(*key);
+        hash *= (size_t)16777619u;
+    }
+
+    return hash;
+}
+
+/* Add an item to the end of the index, there must be room for it. */
+static void index_insert(struct cJSON_Index * const index, cJSON * const item)
+{
+    index->items[index->count] = item;
+    index->count++;
+
+    if (index->slots != NULL)
+    {
+        size_t mask = index->capacity - 1;
+        size_t hash = hash_key((const unsigned char*)item->string);
+        size_t position = hash & mask;
+
+        /* linear probing keeps items with the same hash in insertion order, so the first child still wins */
+        while (index->slots[position].item != NULL)
+        {
+            position = (position + 1) & mask;
+        }
+
+        index->slots[position].hash = hash;
+        index->slots[position].item = item;
+    }
+}
+
+/* Index all children of an array or object. Leaves the item alone if that fails. */
+static cJSON_bool build_index(cJSON * const parent, const internal_hooks * const hooks)
+{
+    struct cJSON_Index *index = NULL;
+    cJSON *child = NULL;
+    size_t count = 0;
+    size_t capacity = 16;
+    cJSON_bool keyed = cJSON_IsObject(parent);
+
+    if (parent->index != NULL)
+    {
+        return true;
+    }
+    if (parent->type & cJSON_IsReference)
+    {
+        /* references share their children with another item, so we wouldn't see changes to them */
+        return false;
+    }
+
+    for (child = parent->child; child != NULL; child = child->next)
+    {
+        if (child->string == NULL)
+        {
+            keyed = false;
+        }
+        count++;
+    }
+
+    /* stay at most half full */
+    while (capacity < (count * 2))
+    {
+        capacity *= 2;
+    }
+
+    index = (struct cJSON_Index*)hooks->allocate(sizeof(struct cJSON_Index));
+    if (index == NULL)
+    {
+        return false;
+    }
+    memset(index, '\0', sizeof(struct cJSON_Index));
+    index->capacity = capacity;
+    index->hooks = *hooks;
+
+    index->items = (cJSON**)hooks->allocate((capacity / 2) * sizeof(cJSON*));
+    if (index->items == NULL)
+    {
+        hooks->deallocate(index);
+        return false;
+    }
+    if (keyed)
+    {
+        index->slots = (index_slot*)hooks->allocate(capacity * sizeof(index_slot));
+        if (index->slots == NULL)
+        {
+            hooks->deallocate(index->items);
+            hooks->deallocate(index);
+            return false;
+        }
+        memset(index->slots, '\0', capacity * sizeof(index_slot));
+    }
+
+    for (child = parent->child; child != NULL; child = child->next)
+    {
+        index_insert(index, child);
+    }
+
+    parent->index = index;
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_BuildIndex(cJSON *item)
+{
+    if ((item == NULL) || !(cJSON_IsArray(item) || cJSON_IsObject(item)))
+    {
+        return false;
+    }
+
+    return build_index(item, &global_hooks);
+}
+
+CJSON_PUBLIC(void) cJSON_DropIndex(cJSON *item)
+{
+    if (item == NULL)
+    {
+        return;
+    }
+
+    drop_index(item);
+}
+
+/* Keep the index up to date when an item is appended to an array or object. */
+static void index_append(cJSON * const parent, cJSON * const item)
+{
+    struct cJSON_Index *index = parent->index;
+    internal_hooks hooks;
+    if (index == NULL)
+    {
+        return;
+    }
+
+    if (((index->slots != NULL) && (item->string == NULL)) || (((index->count + 1) * 2) > index->capacity))
+    {
+        /* the item is already linked in, so a rebuild with the same hooks picks it up with more room */
+        hooks = index->hooks;
+        drop_index(parent);
+        build_index(parent, &hooks);
+        return;
+    }
+
+    index_insert(index, item);
+}
+
+static cJSON *index_lookup(const struct cJSON_Index * const index, const char * const name, const cJSON_bool case_sensitive)
+{
+    size_t mask = index->capacity - 1;
+    size_t hash = hash_key((const unsigned char*)name);
+    size_t position = hash & mask;
+
+    for (; index->slots[position].item != NULL; position = (position + 1) & mask)
+    {
+        cJSON *item = index->slots[position].item;
+        if (index->slots[position].hash != hash)
+        {
+            continue;
+        }
+
+        /* an exact match is also a case insensitive one, only fold case if that fails */
+        if ((strcmp(name, item->string) == 0)
+            || (!case_sensitive && (case_insensitive_strcmp((const unsigned char*)name, (const unsigned char*)item->string) == 0)))
+        {
+            return item;
+        }
+    }
+
+    return NULL;
+}
+
 /* Get Array size/item / object item. */
 CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array)
 {
@@ -1864,6 +2536,11 @@ CJSON_PUBLIC(int) cJSON_GetArraySize(const cJSON *array)
         return 0;
     }
 
+    if (array->index != NULL)
+    {
+        return (int)array->index->count;
+    }
+
     child = array->child;
 
     while(child != NULL)
@@ -1886,6 +2563,11 @@ static cJSON* get_array_item(const cJSON *array, size_t index)
         return NULL;
     }
 
+    if (array->index != NULL)
+    {
+        return (index < array->index->count) ? array->index->items[index] : NULL;
+    }
+
     current_child = array->child;
     while ((current_child != NULL) && (index > 0))
     {
@@ -1915,6 +2597,11 @@ static cJSON *get_object_item(const cJSON * const object, const char * const nam
         return NULL;
     }
 
+    if ((object->index != NULL) && (object->index->slots != NULL))
+    {
+        return index_lookup(object->index, name, case_sensitive);
+    }
+
     current_element = object->child;
     if (case_sensitive)
     {
@@ -1977,6 +2664,7 @@ static cJSON *create_reference(const cJSON *item, const internal_hooks * const h
 
     memcpy(reference, item, sizeof(cJSON));
     reference->string = NULL;
+    reference->index = NULL;
     reference->type |= cJSON_IsReference;
     reference->next = reference->prev = NULL;
     return reference;
@@ -2012,6 +2700,8 @@ static cJSON_bool add_item_to_array(cJSON *array, cJSON *item)
         }
     }
 
+    index_append(array, item);
+
     return true;
 }
 
@@ -2105,112 +2795,106 @@ CJSON_PUBLIC(cJSON_bool) cJSON_AddItemReferenceToObject(cJSON *object, const cha
     return add_item_to_object(object, string, create_reference(item, &global_hooks), &global_hooks, false);
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddNullToObject(cJSON * const object, const char * const name)
+/* add a freshly created item, or delete it if that fails */
+static cJSON *add_new_item_to_object(cJSON * const object, const char * const name, cJSON * const item, const cJSON_bool constant_key)
 {
-    cJSON *null = cJSON_CreateNull();
-    if (add_item_to_object(object, name, null, &global_hooks, false))
+    if (add_item_to_object(object, name, item, &global_hooks, constant_key))
     {
-        return null;
+        return item;
     }
 
-    cJSON_Delete(null);
+    cJSON_Delete(item);
     return NULL;
 }
 
-CJSON_PUBLIC(cJSON*) cJSON_AddTrueToObject(cJSON * const object, const char * const name)
+CJSON_PUBLIC(cJSON*) cJSON_AddNullToObject(cJSON * const object, const char * const name)
 {
-    cJSON *true_item = cJSON_CreateTrue();
-    if (add_item_to_object(object, name, true_item, &global_hooks, false))
-    {
-        return true_item;
-    }
+    return add_new_item_to_object(object, name, cJSON_CreateNull(), false);
+}
 
-    cJSON_Delete(true_item);
-    return NULL;
+CJSON_PUBLIC(cJSON*) cJSON_AddTrueToObject(cJSON * const object, const char * const name)
+{
+    return add_new_item_to_object(object, name, cJSON_CreateTrue(), false);
 }
 
 CJSON_PUBLIC(cJSON*) cJSON_AddFalseToObject(cJSON * const object, const char * const name)
 {
-    cJSON *false_item = cJSON_CreateFalse();
-    if (add_item_to_object(object, name, false_item, &global_hooks, false))
-    {
-        return false_item;
-    }
-
-    cJSON_Delete(false_item);
-    return NULL;
+    return add_new_item_to_object(object, name, cJSON_CreateFalse(), false);
 }
 
 CJSON_PUBLIC(cJSON*) cJSON_AddBoolToObject(cJSON * const object, const char * const name, const cJSON_bool boolean)
 {
-    cJSON *bool_item = cJSON_CreateBool(boolean);
-    if (add_item_to_object(object, name, bool_item, &global_hooks, false))
-    {
-        return bool_item;
-    }
-
-    cJSON_Delete(bool_item);
-    return NULL;
+    return add_new_item_to_object(object, name, cJSON_CreateBool(boolean), false);
 }
 
 CJSON_PUBLIC(cJSON*) cJSON_AddNumberToObject(cJSON * const object, const char * const name, const double number)
 {
-    cJSON *number_item = cJSON_CreateNumber(number);
-    if (add_item_to_object(object, name, number_item, &global_hooks, false))
-    {
-        return number_item;
-    }
-
-    cJSON_Delete(number_item);
-    return NULL;
+    return add_new_item_to_object(object, name, cJSON_CreateNumber(number), false);
 }
 
 CJSON_PUBLIC(cJSON*) cJSON_AddStringToObject(cJSON * const object, const char * const name, const char * const string)
 {
-    cJSON *string_item = cJSON_CreateString(string);
-    if (add_item_to_object(object, name, string_item, &global_hooks, false))
-    {
-        return string_item;
-    }
-
-    cJSON_Delete(string_item);
-    return NULL;
+    return add_new_item_to_object(object, name, cJSON_CreateString(string), false);
 }
 
 CJSON_PUBLIC(cJSON*) cJSON_AddRawToObject(cJSON * const object, const char * const name, const char * const raw)
 {
-    cJSON *raw_item = cJSON_CreateRaw(raw);
-    if (add_item_to_object(object, name, raw_item, &global_hooks, false))
-    {
-        return raw_item;
-    }
-
-    cJSON_Delete(raw_item);
-    return NULL;
+    return add_new_item_to_object(object, name, cJSON_CreateRaw(raw), false);
 }
 
 CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObject(cJSON * const object, const char * const name)
 {
-    cJSON *object_item = cJSON_CreateObject();
-    if (add_item_to_object(object, name, object_item, &global_hooks, false))
-    {
-        return object_item;
-    }
-
-    cJSON_Delete(object_item);
-    return NULL;
+    return add_new_item_to_object(object, name, cJSON_CreateObject(), false);
 }
 
 CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON * const object, const char * const name)
 {
-    cJSON *array = cJSON_CreateArray();
-    if (add_item_to_object(object, name, array, &global_hooks, false))
-    {
-        return array;
-    }
+    return add_new_item_to_object(object, name, cJSON_CreateArray(), false);
+}
 
-    cJSON_Delete(array);
-    return NULL;
+CJSON_PUBLIC(cJSON*) cJSON_AddNullToObjectCS(cJSON * const object, const char * const name)
+{
+    return add_new_item_to_object(object, name, cJSON_CreateNull(), true);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddTrueToObjectCS(cJSON * const object, const char * const name)
+{
+    return add_new_item_to_object(object, name, cJSON_CreateTrue(), true);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddFalseToObjectCS(cJSON * const object, const char * const name)
+{
+    return add_new_item_to_object(object, name, cJSON_CreateFalse(), true);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddBoolToObjectCS(cJSON * const object, const char * const name, const cJSON_bool boolean)
+{
+    return add_new_item_to_object(object, name, cJSON_CreateBool(boolean), true);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddNumberToObjectCS(cJSON * const object, const char * const name, const double number)
+{
+    return add_new_item_to_object(object, name, cJSON_CreateNumber(number), true);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddStringToObjectCS(cJSON * const object, const char * const name, const char * const string)
+{
+    return add_new_item_to_object(object, name, cJSON_CreateString(string), true);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddRawToObjectCS(cJSON * const object, const char * const name, const char * const raw)
+{
+    return add_new_item_to_object(object, name, cJSON_CreateRaw(raw), true);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObjectCS(cJSON * const object, const char * const name)
+{
+    return add_new_item_to_object(object, name, cJSON_CreateObject(), true);
+}
+
+CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObjectCS(cJSON * const object, const char * const name)
+{
+    return add_new_item_to_object(object, name, cJSON_CreateArray(), true);
 }
 
 CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const item)
@@ -2220,6 +2904,8 @@ CJSON_PUBLIC(cJSON *) cJSON_DetachItemViaPointer(cJSON *parent, cJSON * const it
         return NULL;
     }
 
+    drop_index(parent);
+
     if (item != parent->child)
     {
         /* not the first element */
@@ -2309,6 +2995,8 @@ CJSON_PUBLIC(cJSON_bool) cJSON_InsertItemInArray(cJSON *array, int which, cJSON
         return false;
     }
 
+    drop_index(array);
+
     newitem->next = after_inserted;
     newitem->prev = after_inserted->prev;
     after_inserted->prev = newitem;
@@ -2335,6 +3023,8 @@ CJSON_PUBLIC(cJSON_bool) cJSON_ReplaceItemViaPointer(cJSON * const parent, cJSON
         return true;
     }
 
+    drop_index(parent);
+
     replacement->next = item->next;
     replacement->prev = item->prev;
 
@@ -3142,6 +3832,119 @@ CJSON_PUBLIC(cJSON_bool) cJSON_Compare(const cJSON * const a, const cJSON * cons
     }
 }
 
+struct cJSON_Context
+{
+    internal_hooks hooks;
+    error error;
+    int options;
+};
+
+CJSON_PUBLIC(cJSON_Context *) cJSON_CreateContext(const cJSON_Hooks *hooks, int options)
+{
+    internal_hooks context_hooks;
+    cJSON_Context *context = NULL;
+
+    set_hooks(&context_hooks, hooks);
+
+    context = (cJSON_Context*)context_hooks.allocate(sizeof(cJSON_Context));
+    if (context == NULL)
+    {
+        return NULL;
+    }
+    memset(context, '\0', sizeof(cJSON_Context));
+
+    context->hooks = context_hooks;
+    context->options = options;
+
+    return context;
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteContext(cJSON_Context *context)
+{
+    if (context == NULL)
+    {
+        return;
+    }
+
+    context->hooks.deallocate(context);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ContextParse(cJSON_Context *context, const char *value)
+{
+    if ((context == NULL) || (value == NULL))
+    {
+        return NULL;
+    }
+
+    /* Adding null character size due to require_null_terminated. */
+    return cJSON_ContextParseWithLength(context, value, strlen(value) + sizeof(""));
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ContextParseWithLength(cJSON_Context *context, const char *value, size_t buffer_length)
+{
+    return cJSON_ContextParseWithLengthOpts(context, value, buffer_length, NULL);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ContextParseWithLengthOpts(cJSON_Context *context, const char *value, size_t buffer_length, const char **return_parse_end)
+{
+    if (context == NULL)
+    {
+        return NULL;
+    }
+
+    return parse(value, buffer_length, return_parse_end, (context->options & cJSON_ContextRequireNullTerminated) != 0, &context->hooks, &context->error);
+}
+
+CJSON_PUBLIC(const char *) cJSON_ContextGetErrorPtr(const cJSON_Context *context)
+{
+    if ((context == NULL) || (context->error.json == NULL))
+    {
+        return NULL;
+    }
+
+    return (const char*) (context->error.json + context->error.position);
+}
+
+CJSON_PUBLIC(char *) cJSON_ContextPrint(cJSON_Context *context, const cJSON *item)
+{
+    if (context == NULL)
+    {
+        return NULL;
+    }
+
+    return (char*)print(item, (context->options & cJSON_ContextFormat) != 0, &context->hooks);
+}
+
+CJSON_PUBLIC(void) cJSON_ContextDelete(cJSON_Context *context, cJSON *item)
+{
+    if (context == NULL)
+    {
+        return;
+    }
+
+    delete_item(item, &context->hooks);
+}
+
+CJSON_PUBLIC(void) cJSON_ContextFree(cJSON_Context *context, void *object)
+{
+    if ((context == NULL) || (object == NULL))
+    {
+        return;
+    }
+
+    context->hooks.deallocate(object);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSON_ContextBuildIndex(cJSON_Context *context, cJSON *item)
+{
+    if ((context == NULL) || (item == NULL) || !(cJSON_IsArray(item) || cJSON_IsObject(item)))
+    {
+        return false;
+    }
+
+    return build_index(item, &context->hooks);
+}
+
 CJSON_PUBLIC(void *) cJSON_malloc(size_t size)
 {
     return global_hooks.allocate(size);
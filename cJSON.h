@@ -120,6 +120,9 @@ typedef struct cJSON
 
     /* The item's name string, if this item is the child of, or is in the list of subitems of an object. */
     char *string;
+
+    /* Lookup index over the children, only set by cJSON_BuildIndex/cJSON_ContextBuildIndex. Don't touch it, see cJSON_BuildIndex. */
+    struct cJSON_Index *index;
 } cJSON;
 
 typedef struct cJSON_Hooks
@@ -159,8 +162,11 @@ CJSON_PUBLIC(char *) cJSON_PrintUnformatted(const cJSON *item);
 /* Render a cJSON entity to text using a buffered strategy. prebuffer is a guess at the final size. guessing well reduces reallocation. fmt=0 gives unformatted, =1 gives formatted */
 CJSON_PUBLIC(char *) cJSON_PrintBuffered(const cJSON *item, int prebuffer, cJSON_bool fmt);
 /* Render a cJSON entity to text using a buffer already allocated in memory with given length. Returns 1 on success and 0 on failure. */
-/* NOTE: cJSON is not always 100% accurate in estimating how much memory it will use, so to be safe allocate 5 bytes more than you actually need */
+/* NOTE: cJSON is not always 100% accurate in estimating how much memory it will use, so to be safe allocate 5 bytes more than you actually need,
+ * or ask cJSON_GetPrintBufferSize for the exact size */
 CJSON_PUBLIC(cJSON_bool) cJSON_PrintPreallocated(cJSON *item, char *buffer, const int length, const cJSON_bool format);
+/* Returns the buffer size cJSON_PrintPreallocated needs to print item (the printed length plus 2), or 0 if item can't be printed. */
+CJSON_PUBLIC(size_t) cJSON_GetPrintBufferSize(const cJSON *item, const cJSON_bool format);
 /* Delete a cJSON entity and all subentities. */
 CJSON_PUBLIC(void) cJSON_Delete(cJSON *item);
 
@@ -172,6 +178,16 @@ CJSON_PUBLIC(cJSON *) cJSON_GetArrayItem(const cJSON *array, int index);
 CJSON_PUBLIC(cJSON *) cJSON_GetObjectItem(const cJSON * const object, const char * const string);
 CJSON_PUBLIC(cJSON *) cJSON_GetObjectItemCaseSensitive(const cJSON * const object, const char * const string);
 CJSON_PUBLIC(cJSON_bool) cJSON_HasObjectItem(const cJSON *object, const char *string);
+/* Index the children of an array or object, so cJSON_GetArrayItem, cJSON_GetArraySize and cJSON_GetObjectItem on it
+ * are O(1). The index is allocated with the global hooks (cJSON_ContextBuildIndex uses a context's) and freed with
+ * the item. Appending through the cJSON API keeps it up to date, detaching, inserting or replacing children drops it,
+ * so call this again afterwards. Call cJSON_DropIndex before changing ->child, ->next or ->string by hand.
+ * Returns false if the index can't be built (out of memory, or item is a reference or not an array or object);
+ * lookups then keep walking the children. Only items you index this way are indexed, never nested ones.
+ * Building, dropping and updating the index writes to the tree, so an indexed tree is only safe to read from several
+ * threads while nobody builds, drops or appends to it. */
+CJSON_PUBLIC(cJSON_bool) cJSON_BuildIndex(cJSON *item);
+CJSON_PUBLIC(void) cJSON_DropIndex(cJSON *item);
 /* For analysing failed parses. This returns a pointer to the parse error. You'll probably need to look a few chars back to make sense of it. Defined when cJSON_Parse() returns 0. 0 when cJSON_Parse() succeeds. */
 CJSON_PUBLIC(const char *) cJSON_GetErrorPtr(void);
 
@@ -270,6 +286,17 @@ CJSON_PUBLIC(cJSON*) cJSON_AddStringToObject(cJSON * const object, const char *
 CJSON_PUBLIC(cJSON*) cJSON_AddRawToObject(cJSON * const object, const char * const name, const char * const raw);
 CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObject(cJSON * const object, const char * const name);
 CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObject(cJSON * const object, const char * const name);
+/* Same as above, but the name is used as is instead of being copied, like cJSON_AddItemToObjectCS.
+ * Meant for keys that are string literals or otherwise outlive the object. */
+CJSON_PUBLIC(cJSON*) cJSON_AddNullToObjectCS(cJSON * const object, const char * const name);
+CJSON_PUBLIC(cJSON*) cJSON_AddTrueToObjectCS(cJSON * const object, const char * const name);
+CJSON_PUBLIC(cJSON*) cJSON_AddFalseToObjectCS(cJSON * const object, const char * const name);
+CJSON_PUBLIC(cJSON*) cJSON_AddBoolToObjectCS(cJSON * const object, const char * const name, const cJSON_bool boolean);
+CJSON_PUBLIC(cJSON*) cJSON_AddNumberToObjectCS(cJSON * const object, const char * const name, const double number);
+CJSON_PUBLIC(cJSON*) cJSON_AddStringToObjectCS(cJSON * const object, const char * const name, const char * const string);
+CJSON_PUBLIC(cJSON*) cJSON_AddRawToObjectCS(cJSON * const object, const char * const name, const char * const raw);
+CJSON_PUBLIC(cJSON*) cJSON_AddObjectToObjectCS(cJSON * const object, const char * const name);
+CJSON_PUBLIC(cJSON*) cJSON_AddArrayToObjectCS(cJSON * const object, const char * const name);
 
 /* When assigning an integer value, it needs to be propagated to valuedouble too. */
 #define cJSON_SetIntValue(object, number) ((object) ? (object)->valueint = (object)->valuedouble = (number) : (number))
@@ -293,6 +320,34 @@ CJSON_PUBLIC(char*) cJSON_SetValuestring(cJSON *object, const char *valuestring)
 CJSON_PUBLIC(void *) cJSON_malloc(size_t size);
 CJSON_PUBLIC(void) cJSON_free(void *object);
 
+/* A context carries its own allocation hooks, error position and options, so that several threads can parse,
+ * print and delete documents at the same time, each with its own allocator, without touching the global state
+ * behind cJSON_InitHooks and cJSON_GetErrorPtr.
+ * Trees parsed through a context have to be deleted with cJSON_ContextDelete on the same context, and strings
+ * printed through it freed with cJSON_ContextFree. The other functions (cJSON_Create*, cJSON_Add*, ...) still use
+ * the global hooks, so only mix them into a context's tree if both sets of hooks can free each other's memory.
+ * A single context must not be used by several threads at once. */
+typedef struct cJSON_Context cJSON_Context;
+
+/* Options for cJSON_CreateContext */
+#define cJSON_ContextRequireNullTerminated (1 << 0) /* like require_null_terminated of cJSON_ParseWithOpts */
+#define cJSON_ContextFormat (1 << 1) /* cJSON_ContextPrint formats like cJSON_Print instead of cJSON_PrintUnformatted */
+
+/* hooks == NULL uses malloc/free. The context itself is allocated with its hooks. */
+CJSON_PUBLIC(cJSON_Context *) cJSON_CreateContext(const cJSON_Hooks *hooks, int options);
+CJSON_PUBLIC(void) cJSON_DeleteContext(cJSON_Context *context);
+CJSON_PUBLIC(cJSON *) cJSON_ContextParse(cJSON_Context *context, const char *value);
+CJSON_PUBLIC(cJSON *) cJSON_ContextParseWithLength(cJSON_Context *context, const char *value, size_t buffer_length);
+/* return_parse_end works as in cJSON_ParseWithLengthOpts */
+CJSON_PUBLIC(cJSON *) cJSON_ContextParseWithLengthOpts(cJSON_Context *context, const char *value, size_t buffer_length, const char **return_parse_end);
+/* Same as cJSON_GetErrorPtr for the last parse through this context, NULL if it succeeded. */
+CJSON_PUBLIC(const char *) cJSON_ContextGetErrorPtr(const cJSON_Context *context);
+CJSON_PUBLIC(char *) cJSON_ContextPrint(cJSON_Context *context, const cJSON *item);
+CJSON_PUBLIC(void) cJSON_ContextDelete(cJSON_Context *context, cJSON *item);
+CJSON_PUBLIC(void) cJSON_ContextFree(cJSON_Context *context, void *object);
+/* cJSON_BuildIndex with the context's hooks */
+CJSON_PUBLIC(cJSON_bool) cJSON_ContextBuildIndex(cJSON_Context *context, cJSON *item);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,189 @@
+/*
+  Field descriptor binding for cJSON, see cJSON_Bind.h
+*/
+
+/* disable warnings about old C89 functions in MSVC */
+#if !defined(_CRT_SECURE_NO_DEPRECATE) && defined(_MSC_VER)
+#define _CRT_SECURE_NO_DEPRECATE
+#endif
+
+#include <string.h>
+#include <limits.h>
+
+#include "cJSON_Bind.h"
+
+/* define our own boolean type */
+#ifdef true
+#undef true
+#endif
+#define true ((cJSON_bool)1)
+
+#ifdef false
+#undef false
+#endif
+#define false ((cJSON_bool)0)
+
+#define member(field, target, type) ((type*)(void*)((unsigned char*)(target) + (field)->offset))
+
+/* use saturation in case of overflow, like cJSON_SetNumberHelper does for valueint */
+static int number_to_int(const double number)
+{
+    if (number >= INT_MAX)
+    {
+        return INT_MAX;
+    }
+    if (number <= (double)INT_MIN)
+    {
+        return INT_MIN;
+    }
+
+    return (int)number;
+}
+
+CJSON_PUBLIC(const cJSONBind_Field *) cJSONBind_FindField(const cJSONBind_Field *fields, size_t count, const char *name)
+{
+    size_t i = 0;
+
+    if ((fields == NULL) || (name == NULL))
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (strcmp(fields[i].name, name) == 0)
+        {
+            return &fields[i];
+        }
+    }
+
+    return NULL;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONBind_SetNumber(const cJSONBind_Field *field, void *target, double number)
+{
+    if ((field == NULL) || (target == NULL))
+    {
+        return false;
+    }
+
+    switch (field->type)
+    {
+        case cJSONBind_Int:
+            *member(field, target, int) = number_to_int(number);
+            return true;
+
+        case cJSONBind_Double:
+            *member(field, target, double) = number;
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONBind_SetArrayNumber(const cJSONBind_Field *field, void *target, size_t index, double number)
+{
+    if ((field == NULL) || (target == NULL) || (field->type != cJSONBind_IntArray) || (index >= field->size))
+    {
+        return false;
+    }
+
+    member(field, target, int)[index] = number_to_int(number);
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONBind_SetString(const cJSONBind_Field *field, void *target, const char *string)
+{
+    char *destination = NULL;
+    size_t length = 0;
+
+    if ((field == NULL) || (target == NULL) || (string == NULL) || (field->type != cJSONBind_String) || (field->size == 0))
+    {
+        return false;
+    }
+
+    destination = member(field, target, char);
+    length = strlen(string);
+    if (length >= field->size)
+    {
+        length = field->size - 1;
+    }
+    memcpy(destination, string, length);
+    destination[length] = '\0';
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONBind_SetBool(const cJSONBind_Field *field, void *target, cJSON_bool boolean)
+{
+    if ((field == NULL) || (target == NULL) || (field->type != cJSONBind_Bool))
+    {
+        return false;
+    }
+
+    *member(field, target, cJSON_bool) = boolean ? true : false;
+
+    return true;
+}
+
+static cJSON_bool decode_value(const cJSONBind_Field * const field, void * const target, const cJSON * const item)
+{
+    const cJSON *element = NULL;
+    size_t index = 0;
+
+    switch (field->type)
+    {
+        case cJSONBind_Int:
+        case cJSONBind_Double:
+            return cJSON_IsNumber(item) && cJSONBind_SetNumber(field, target, item->valuedouble);
+
+        case cJSONBind_Bool:
+            return cJSON_IsBool(item) && cJSONBind_SetBool(field, target, cJSON_IsTrue(item));
+
+        case cJSONBind_String:
+            return cJSON_IsString(item) && cJSONBind_SetString(field, target, item->valuestring);
+
+        case cJSONBind_IntArray:
+            if (!cJSON_IsArray(item))
+            {
+                return false;
+            }
+            for (element = item->child; (element != NULL) && (index < field->size); element = element->next, index++)
+            {
+                if (!cJSON_IsNumber(element))
+                {
+                    return false;
+                }
+                cJSONBind_SetArrayNumber(field, target, index, element->valuedouble);
+            }
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONBind_DecodeObject(const cJSON *object, const cJSONBind_Field *fields, size_t count, void *target)
+{
+    const cJSON *item = NULL;
+    const cJSONBind_Field *field = NULL;
+    cJSON_bool success = true;
+
+    if (!cJSON_IsObject(object) || (target == NULL))
+    {
+        return false;
+    }
+
+    for (item = object->child; item != NULL; item = item->next)
+    {
+        field = cJSONBind_FindField(fields, count, item->string);
+        if ((field != NULL) && !decode_value(field, target, item))
+        {
+            success = false;
+        }
+    }
+
+    return success;
+}
@@ -0,0 +1,56 @@
+/*
+  Field descriptor binding for cJSON.
+
+  A table of cJSONBind_Field entries describes where the members of a JSON
+  object live inside a C struct (name, offset, type, size), so values can be
+  decoded straight into the struct, from a cJSON tree or from the callbacks of
+  the streaming parser, with bounded copies and no per-field lookup code.
+*/
+
+#ifndef cJSON_Bind__h
+#define cJSON_Bind__h
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include "cJSON.h"
+
+typedef enum
+{
+    cJSONBind_Int, /* int, saturated the same way as valueint */
+    cJSONBind_Double, /* double */
+    cJSONBind_Bool, /* cJSON_bool */
+    cJSONBind_String, /* char[size], truncated to size - 1 characters */
+    cJSONBind_IntArray /* int[size], extra elements are ignored */
+} cJSONBind_Type;
+
+typedef struct cJSONBind_Field
+{
+    const char *name;
+    size_t offset; /* offsetof() the member in the target struct */
+    cJSONBind_Type type;
+    size_t size; /* buffer size for strings, element count for arrays, unused otherwise */
+} cJSONBind_Field;
+
+/* Find the field bound to a key (case sensitive). Returns NULL if the key isn't bound. */
+CJSON_PUBLIC(const cJSONBind_Field *) cJSONBind_FindField(const cJSONBind_Field *fields, size_t count, const char *name);
+
+/* Store a single value into the member of target described by field.
+ * Return false if the value doesn't fit the field's type (or index is out of range for arrays). */
+CJSON_PUBLIC(cJSON_bool) cJSONBind_SetNumber(const cJSONBind_Field *field, void *target, double number);
+CJSON_PUBLIC(cJSON_bool) cJSONBind_SetArrayNumber(const cJSONBind_Field *field, void *target, size_t index, double number);
+CJSON_PUBLIC(cJSON_bool) cJSONBind_SetString(const cJSONBind_Field *field, void *target, const char *string);
+CJSON_PUBLIC(cJSON_bool) cJSONBind_SetBool(const cJSONBind_Field *field, void *target, cJSON_bool boolean);
+
+/* Decode every bound member of object into target, walking the object once. Members without a field are skipped.
+ * Returns false if object isn't an object or a bound member has the wrong type; the other members are still decoded. */
+CJSON_PUBLIC(cJSON_bool) cJSONBind_DecodeObject(const cJSON *object, const cJSONBind_Field *fields, size_t count, void *target);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
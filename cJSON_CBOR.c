@@ -0,0 +1,733 @@
+/*
+  CBOR encoding of cJSON trees, see cJSON_CBOR.h
+*/
+
+/* disable warnings about old C89 functions in MSVC */
+#if !defined(_CRT_SECURE_NO_DEPRECATE) && defined(_MSC_VER)
+#define _CRT_SECURE_NO_DEPRECATE
+#endif
+
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "cJSON_CBOR.h"
+
+/* define our own boolean type */
+#ifdef true
+#undef true
+#endif
+#define true ((cJSON_bool)1)
+
+#ifdef false
+#undef false
+#endif
+#define false ((cJSON_bool)0)
+
+/* major types */
+#define CBOR_UNSIGNED 0
+#define CBOR_NEGATIVE 1
+#define CBOR_BYTES 2
+#define CBOR_TEXT 3
+#define CBOR_ARRAY 4
+#define CBOR_MAP 5
+#define CBOR_TAG 6
+#define CBOR_SIMPLE 7
+
+/* additional information in the initial byte */
+#define CBOR_FALSE 20
+#define CBOR_TRUE 21
+#define CBOR_NULL 22
+#define CBOR_UNDEFINED 23
+#define CBOR_HALF 25
+#define CBOR_SINGLE 26
+#define CBOR_DOUBLE 27
+#define CBOR_INDEFINITE 31
+
+#define CBOR_BREAK 0xFF
+
+#define TWO_POW_32 4294967296.0
+
+typedef struct
+{
+    unsigned char *buffer;
+    size_t length;
+    size_t offset;
+} cbor_buffer;
+
+typedef struct
+{
+    const unsigned char *content;
+    size_t length;
+    size_t offset;
+} cbor_input;
+
+/* make room for needed more bytes, growing the buffer through the global hooks */
+static cJSON_bool ensure(cbor_buffer * const output, const size_t needed)
+{
+    unsigned char *new_buffer = NULL;
+    size_t new_length = 0;
+
+    if (needed > ((size_t)-1 - output->offset))
+    {
+        return false;
+    }
+    if ((output->offset + needed) <= output->length)
+    {
+        return true;
+    }
+
+    new_length = output->length;
+    while (new_length < (output->offset + needed))
+    {
+        if (new_length > ((size_t)-1 / 2))
+        {
+            new_length = output->offset + needed;
+            break;
+        }
+        new_length *= 2;
+    }
+
+    new_buffer = (unsigned char*)cJSON_malloc(new_length);
+    if (new_buffer == NULL)
+    {
+        return false;
+    }
+    memcpy(new_buffer, output->buffer, output->offset);
+    cJSON_free(output->buffer);
+
+    output->buffer = new_buffer;
+    output->length = new_length;
+    return true;
+}
+
+/* write an initial byte with the shortest encoding of argument after it */
+static cJSON_bool put_head(cbor_buffer * const output, const unsigned char major, const size_t argument)
+{
+    unsigned char *out = NULL;
+    unsigned char info = 0;
+    size_t size = 0;
+    size_t value = argument;
+    size_t i = 0;
+
+    if (argument < 24)
+    {
+        info = (unsigned char)argument;
+    }
+    else if (argument <= 0xFF)
+    {
+        info = 24;
+        size = 1;
+    }
+    else if (argument <= 0xFFFF)
+    {
+        info = 25;
+        size = 2;
+    }
+    else if (argument <= 0xFFFFFFFFUL)
+    {
+        info = 26;
+        size = 4;
+    }
+    else
+    {
+        info = 27;
+        size = 8;
+    }
+
+    if (!ensure(output, size + 1))
+    {
+        return false;
+    }
+
+    out = output->buffer + output->offset;
+    out[0] = (unsigned char)((major << 5) | info);
+    for (i = size; i > 0; i--)
+    {
+        out[i] = (unsigned char)(value & 0xFF);
+        value >>= 8;
+    }
+    output->offset += size + 1;
+
+    return true;
+}
+
+static cJSON_bool put_bytes(cbor_buffer * const output, const unsigned char * const bytes, const size_t length)
+{
+    if (!ensure(output, length))
+    {
+        return false;
+    }
+    if (length > 0)
+    {
+        memcpy(output->buffer + output->offset, bytes, length);
+    }
+    output->offset += length;
+
+    return true;
+}
+
+static cJSON_bool is_negative_zero(const double number)
+{
+    const double positive_zero = 0.0;
+    return (number == 0.0) && (memcmp(&number, &positive_zero, sizeof(number)) != 0);
+}
+
+/* Split number into the biased exponent and the mantissa of an IEEE 754 format with the given field widths.
+ * number has to be representable in that format, the mantissa is returned as a whole double. */
+static void split_float(const double number, const int exponent_bits, const int mantissa_bits, unsigned long *sign, unsigned long *exponent, double *mantissa)
+{
+    const long bias = (1L << (exponent_bits - 1)) - 1;
+    double magnitude = fabs(number);
+    double fraction = 0;
+    int binary_exponent = 0;
+
+    *sign = ((number < 0) || is_negative_zero(number)) ? 1 : 0;
+    *exponent = 0;
+    *mantissa = 0;
+
+    if (number != number)
+    {
+        /* quiet NaN */
+        *sign = 0;
+        *exponent = (1UL << exponent_bits) - 1;
+        *mantissa = ldexp(1.0, mantissa_bits - 1);
+    }
+    else if (magnitude > DBL_MAX)
+    {
+        *exponent = (1UL << exponent_bits) - 1;
+    }
+    else if (magnitude != 0)
+    {
+        fraction = frexp(magnitude, &binary_exponent);
+        if ((binary_exponent - 1 + bias) <= 0)
+        {
+            /* subnormal */
+            *mantissa = ldexp(magnitude, (int)(bias - 1 + mantissa_bits));
+        }
+        else
+        {
+            *exponent = (unsigned long)(binary_exponent - 1 + bias);
+            *mantissa = ldexp(fraction * 2 - 1, mantissa_bits);
+        }
+    }
+}
+
+/* Rebuild a number from the fields of an IEEE 754 format with the given widths. */
+static double join_float(const unsigned long sign, const unsigned long exponent, const double mantissa, const int exponent_bits, const int mantissa_bits)
+{
+    const long bias = (1L << (exponent_bits - 1)) - 1;
+    double number = 0;
+
+    if (exponent == ((1UL << exponent_bits) - 1))
+    {
+        number = (mantissa == 0) ? HUGE_VAL : (HUGE_VAL - HUGE_VAL);
+    }
+    else if (exponent == 0)
+    {
+        number = ldexp(mantissa, (int)(1 - bias - mantissa_bits));
+    }
+    else
+    {
+        number = ldexp(mantissa + ldexp(1.0, mantissa_bits), (int)((long)exponent - bias - mantissa_bits));
+    }
+
+    return sign ? -number : number;
+}
+
+static void put_big_endian(unsigned char * const out, unsigned long value, const size_t size)
+{
+    size_t i = 0;
+    for (i = size; i > 0; i--)
+    {
+        out[i - 1] = (unsigned char)(value & 0xFF);
+        value >>= 8;
+    }
+}
+
+static cJSON_bool encode_number(cbor_buffer * const output, const double number)
+{
+    unsigned char bytes[9];
+    unsigned long sign = 0;
+    unsigned long exponent = 0;
+    unsigned long high = 0;
+    double mantissa = 0;
+
+    /* whole numbers in 32 bits are the common case and take at most 5 bytes */
+    if ((number == floor(number)) && (number >= -TWO_POW_32) && (number < TWO_POW_32) && !is_negative_zero(number))
+    {
+        if (number < 0)
+        {
+            return put_head(output, CBOR_NEGATIVE, (size_t)(-1.0 - number));
+        }
+        return put_head(output, CBOR_UNSIGNED, (size_t)number);
+    }
+
+    if ((number != number) || ((fabs(number) <= FLT_MAX) && ((double)(float)number == number)) || (fabs(number) > DBL_MAX))
+    {
+        split_float(number, 8, 23, &sign, &exponent, &mantissa);
+        bytes[0] = (CBOR_SIMPLE << 5) | CBOR_SINGLE;
+        put_big_endian(bytes + 1, (sign << 31) | (exponent << 23) | (unsigned long)mantissa, 4);
+        return put_bytes(output, bytes, 5);
+    }
+
+    split_float(number, 11, 52, &sign, &exponent, &mantissa);
+    high = (unsigned long)floor(mantissa / TWO_POW_32);
+    bytes[0] = (CBOR_SIMPLE << 5) | CBOR_DOUBLE;
+    put_big_endian(bytes + 1, (sign << 31) | (exponent << 20) | high, 4);
+    put_big_endian(bytes + 5, (unsigned long)(mantissa - (double)high * TWO_POW_32), 4);
+    return put_bytes(output, bytes, 9);
+}
+
+/* a NULL string is encoded as "", the same way cJSON_Print prints it */
+static cJSON_bool encode_string(cbor_buffer * const output, const char * const string)
+{
+    size_t length = (string == NULL) ? 0 : strlen(string);
+
+    return put_head(output, CBOR_TEXT, length) && put_bytes(output, (const unsigned char*)string, length);
+}
+
+static cJSON_bool encode_item(const cJSON * const item, cbor_buffer * const output)
+{
+    const cJSON *child = NULL;
+    size_t count = 0;
+
+    switch ((item->type) & 0xFF)
+    {
+        case cJSON_NULL:
+            return put_head(output, CBOR_SIMPLE, CBOR_NULL);
+
+        case cJSON_False:
+            return put_head(output, CBOR_SIMPLE, CBOR_FALSE);
+
+        case cJSON_True:
+            return put_head(output, CBOR_SIMPLE, CBOR_TRUE);
+
+        case cJSON_Number:
+            return encode_number(output, item->valuedouble);
+
+        case cJSON_String:
+            return encode_string(output, item->valuestring);
+
+        case cJSON_Array:
+        case cJSON_Object:
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                count++;
+            }
+            if (!put_head(output, (item->type & cJSON_Object) ? CBOR_MAP : CBOR_ARRAY, count))
+            {
+                return false;
+            }
+            for (child = item->child; child != NULL; child = child->next)
+            {
+                if ((item->type & cJSON_Object) && !encode_string(output, child->string))
+                {
+                    return false;
+                }
+                if (!encode_item(child, output))
+                {
+                    return false;
+                }
+            }
+            return true;
+
+        /* raw JSON text has no CBOR equivalent */
+        default:
+            return false;
+    }
+}
+
+CJSON_PUBLIC(unsigned char *) cJSONCBOR_Encode(const cJSON *item, size_t *length)
+{
+    cbor_buffer output;
+
+    if ((item == NULL) || (length == NULL))
+    {
+        return NULL;
+    }
+
+    output.length = 256;
+    output.offset = 0;
+    output.buffer = (unsigned char*)cJSON_malloc(output.length);
+    if (output.buffer == NULL)
+    {
+        return NULL;
+    }
+
+    if (!encode_item(item, &output))
+    {
+        cJSON_free(output.buffer);
+        return NULL;
+    }
+
+    *length = output.offset;
+    return output.buffer;
+}
+
+/* Read an initial byte and the argument after it. 64 bit arguments are split into high and low 32 bits.
+ * Indefinite lengths leave the argument at 0. */
+static cJSON_bool read_head(cbor_input * const input, unsigned char *major, unsigned char *info, unsigned long *high, unsigned long *low)
+{
+    size_t size = 0;
+    size_t i = 0;
+    unsigned char initial = 0;
+
+    if (input->offset >= input->length)
+    {
+        return false;
+    }
+
+    initial = input->content[input->offset++];
+    *major = (unsigned char)(initial >> 5);
+    *info = (unsigned char)(initial & 0x1F);
+    *high = 0;
+    *low = 0;
+
+    switch (*info)
+    {
+        case 24:
+            size = 1;
+            break;
+        case 25:
+            size = 2;
+            break;
+        case 26:
+            size = 4;
+            break;
+        case 27:
+            size = 8;
+            break;
+        case CBOR_INDEFINITE:
+            return true;
+        default:
+            if (*info >= 24)
+            {
+                /* reserved */
+                return false;
+            }
+            *low = *info;
+            return true;
+    }
+
+    if ((input->length - input->offset) < size)
+    {
+        return false;
+    }
+    for (i = 0; i < size; i++)
+    {
+        if ((size == 8) && (i < 4))
+        {
+            *high = (*high << 8) | input->content[input->offset + i];
+        }
+        else
+        {
+            *low = (*low << 8) | input->content[input->offset + i];
+        }
+    }
+    input->offset += size;
+
+    return true;
+}
+
+static cJSON_bool argument_to_size(const unsigned long high, const unsigned long low, size_t *size)
+{
+    if ((high != 0) && (sizeof(size_t) <= 4))
+    {
+        return false;
+    }
+
+    *size = (((size_t)high << 16) << 16) | (size_t)low;
+    return true;
+}
+
+/* Decode the text string whose head has just been read into a new null terminated buffer. */
+static char *decode_string(cbor_input * const input, const unsigned char info, const unsigned long high, const unsigned long low)
+{
+    char *string = NULL;
+    size_t length = 0;
+    size_t chunk_length = 0;
+    size_t start = 0;
+    size_t copied = 0;
+    unsigned char major = 0;
+    unsigned char chunk_info = 0;
+    unsigned long chunk_high = 0;
+    unsigned long chunk_low = 0;
+
+    if (info != CBOR_INDEFINITE)
+    {
+        if (!argument_to_size(high, low, &length) || (length > (input->length - input->offset)) || (length == (size_t)-1))
+        {
+            return NULL;
+        }
+        if (memchr(input->content + input->offset, '\0', length) != NULL)
+        {
+            return NULL;
+        }
+
+        string = (char*)cJSON_malloc(length + 1);
+        if (string == NULL)
+        {
+            return NULL;
+        }
+        memcpy(string, input->content + input->offset, length);
+        string[length] = '\0';
+        input->offset += length;
+
+        return string;
+    }
+
+    /* an indefinite length string is a sequence of definite length chunks up to a break,
+     * walk it once to get the total length and a second time to copy the chunks */
+    start = input->offset;
+    for (;;)
+    {
+        if (input->offset >= input->length)
+        {
+            return NULL;
+        }
+        if (input->content[input->offset] == CBOR_BREAK)
+        {
+            break;
+        }
+        if (!read_head(input, &major, &chunk_info, &chunk_high, &chunk_low) || (major != CBOR_TEXT) || (chunk_info == CBOR_INDEFINITE))
+        {
+            return NULL;
+        }
+        if (!argument_to_size(chunk_high, chunk_low, &chunk_length) || (chunk_length > (input->length - input->offset)))
+        {
+            return NULL;
+        }
+        if (memchr(input->content + input->offset, '\0', chunk_length) != NULL)
+        {
+            return NULL;
+        }
+        input->offset += chunk_length;
+        /* the chunks lie inside the input, so their sum can't overflow */
+        length += chunk_length;
+    }
+
+    if (length == (size_t)-1)
+    {
+        return NULL;
+    }
+    string = (char*)cJSON_malloc(length + 1);
+    if (string == NULL)
+    {
+        return NULL;
+    }
+
+    input->offset = start;
+    while (input->content[input->offset] != CBOR_BREAK)
+    {
+        read_head(input, &major, &chunk_info, &chunk_high, &chunk_low);
+        argument_to_size(chunk_high, chunk_low, &chunk_length);
+        memcpy(string + copied, input->content + input->offset, chunk_length);
+        input->offset += chunk_length;
+        copied += chunk_length;
+    }
+    string[copied] = '\0';
+    /* skip the break */
+    input->offset++;
+
+    return string;
+}
+
+static cJSON *decode_item(cbor_input * const input, const size_t depth);
+
+static cJSON *decode_container(cbor_input * const input, const unsigned char major, const unsigned char info, const unsigned long high, const unsigned long low, const size_t depth)
+{
+    cJSON *container = NULL;
+    cJSON *tail = NULL;
+    cJSON *child = NULL;
+    char *key = NULL;
+    size_t count = 0;
+    size_t i = 0;
+    unsigned char key_major = 0;
+    unsigned char key_info = 0;
+    unsigned long key_high = 0;
+    unsigned long key_low = 0;
+    const cJSON_bool indefinite = (info == CBOR_INDEFINITE);
+
+    if (!indefinite)
+    {
+        /* every entry takes at least one byte per key and value, reject counts the input can't hold */
+        if (!argument_to_size(high, low, &count) || (count > ((input->length - input->offset) / ((major == CBOR_MAP) ? 2 : 1))))
+        {
+            return NULL;
+        }
+    }
+
+    container = (major == CBOR_MAP) ? cJSON_CreateObject() : cJSON_CreateArray();
+    if (container == NULL)
+    {
+        return NULL;
+    }
+
+    for (i = 0; indefinite || (i < count); i++)
+    {
+        if (indefinite)
+        {
+            if (input->offset >= input->length)
+            {
+                goto fail;
+            }
+            if (input->content[input->offset] == CBOR_BREAK)
+            {
+                input->offset++;
+                break;
+            }
+        }
+
+        if (major == CBOR_MAP)
+        {
+            if (!read_head(input, &key_major, &key_info, &key_high, &key_low) || (key_major != CBOR_TEXT))
+            {
+                goto fail;
+            }
+            key = decode_string(input, key_info, key_high, key_low);
+            if (key == NULL)
+            {
+                goto fail;
+            }
+        }
+
+        child = decode_item(input, depth + 1);
+        if (child == NULL)
+        {
+            goto fail;
+        }
+        child->string = key;
+        key = NULL;
+
+        /* append, the head's prev points at the tail like in a parsed tree */
+        if (tail == NULL)
+        {
+            container->child = child;
+        }
+        else
+        {
+            tail->next = child;
+            child->prev = tail;
+        }
+        tail = child;
+        container->child->prev = tail;
+    }
+
+    return container;
+
+fail:
+    if (key != NULL)
+    {
+        cJSON_free(key);
+    }
+    cJSON_Delete(container);
+
+    return NULL;
+}
+
+static cJSON *decode_item(cbor_input * const input, const size_t depth)
+{
+    cJSON *item = NULL;
+    char *string = NULL;
+    unsigned char major = 0;
+    unsigned char info = 0;
+    unsigned long high = 0;
+    unsigned long low = 0;
+
+    if (depth > CJSON_NESTING_LIMIT)
+    {
+        return NULL;
+    }
+    if (!read_head(input, &major, &info, &high, &low))
+    {
+        return NULL;
+    }
+    if ((info == CBOR_INDEFINITE) && ((major == CBOR_UNSIGNED) || (major == CBOR_NEGATIVE) || (major == CBOR_TAG) || (major == CBOR_SIMPLE)))
+    {
+        /* a break outside of an indefinite length item, or nothing to be indefinite about */
+        return NULL;
+    }
+
+    switch (major)
+    {
+        case CBOR_UNSIGNED:
+            return cJSON_CreateNumber((double)high * TWO_POW_32 + (double)low);
+
+        case CBOR_NEGATIVE:
+            return cJSON_CreateNumber(-1.0 - ((double)high * TWO_POW_32 + (double)low));
+
+        case CBOR_TEXT:
+            string = decode_string(input, info, high, low);
+            if (string == NULL)
+            {
+                return NULL;
+            }
+            item = cJSON_CreateNull();
+            if (item == NULL)
+            {
+                cJSON_free(string);
+                return NULL;
+            }
+            item->type = cJSON_String;
+            item->valuestring = string;
+            return item;
+
+        case CBOR_ARRAY:
+        case CBOR_MAP:
+            return decode_container(input, major, info, high, low, depth);
+
+        case CBOR_TAG:
+            /* the tagged item is taken as is */
+            return decode_item(input, depth + 1);
+
+        case CBOR_SIMPLE:
+            switch (info)
+            {
+                case CBOR_FALSE:
+                    return cJSON_CreateFalse();
+                case CBOR_TRUE:
+                    return cJSON_CreateTrue();
+                case CBOR_NULL:
+                case CBOR_UNDEFINED:
+                    return cJSON_CreateNull();
+                case CBOR_HALF:
+                    return cJSON_CreateNumber(join_float((low >> 15) & 1, (low >> 10) & 0x1F, (double)(low & 0x3FF), 5, 10));
+                case CBOR_SINGLE:
+                    return cJSON_CreateNumber(join_float((low >> 31) & 1, (low >> 23) & 0xFF, (double)(low & 0x7FFFFF), 8, 23));
+                case CBOR_DOUBLE:
+                    return cJSON_CreateNumber(join_float((high >> 31) & 1, (high >> 20) & 0x7FF, (double)(high & 0xFFFFF) * TWO_POW_32 + (double)low, 11, 52));
+                default:
+                    return NULL;
+            }
+
+        /* byte strings have no JSON equivalent */
+        default:
+            return NULL;
+    }
+}
+
+CJSON_PUBLIC(cJSON *) cJSONCBOR_Decode(const unsigned char *data, size_t length)
+{
+    cbor_input input;
+    cJSON *item = NULL;
+
+    if (data == NULL)
+    {
+        return NULL;
+    }
+
+    input.content = data;
+    input.length = length;
+    input.offset = 0;
+
+    item = decode_item(&input, 0);
+    if ((item != NULL) && (input.offset != input.length))
+    {
+        /* trailing bytes */
+        cJSON_Delete(item);
+        return NULL;
+    }
+
+    return item;
+}
@@ -0,0 +1,36 @@
+/*
+  CBOR (RFC 8949) encoding of cJSON trees.
+
+  Numbers are stored as binary integers or floats and strings with a length
+  prefix, so a tree encodes smaller than its JSON text and decodes without
+  any number conversion or escape handling.
+*/
+
+#ifndef cJSON_CBOR__h
+#define cJSON_CBOR__h
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include "cJSON.h"
+
+/* Encode a tree. Whole numbers that fit in 32 bits become CBOR integers, other numbers
+ * single or double precision floats, whichever holds them exactly.
+ * Returns a buffer of *length bytes to be freed with cJSON_free, or NULL if the tree
+ * contains cJSON_Raw or invalid items or memory ran out. */
+CJSON_PUBLIC(unsigned char *) cJSONCBOR_Encode(const cJSON *item, size_t *length);
+
+/* Decode exactly one CBOR data item into a tree to be freed with cJSON_Delete.
+ * Indefinite lengths, tags (which are ignored) and half precision floats are understood,
+ * undefined decodes to null. Byte strings, map keys that aren't text, strings containing
+ * a NUL character and nesting deeper than CJSON_NESTING_LIMIT are rejected. Returns NULL on failure. */
+CJSON_PUBLIC(cJSON *) cJSONCBOR_Decode(const unsigned char *data, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,417 @@
+/*
+  Parallel parsing of large top-level JSON arrays, see cJSON_Parallel.h
+*/
+
+/* disable warnings about old C89 functions in MSVC */
+#if !defined(_CRT_SECURE_NO_DEPRECATE) && defined(_MSC_VER)
+#define _CRT_SECURE_NO_DEPRECATE
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "cJSON_Parallel.h"
+
+/* define our own boolean type */
+#ifdef true
+#undef true
+#endif
+#define true ((cJSON_bool)1)
+
+#ifdef false
+#undef false
+#endif
+#define false ((cJSON_bool)0)
+
+#define PARALLEL_MAX_THREADS 64
+
+typedef struct
+{
+    const char *start;
+    size_t length;
+} element_slice;
+
+typedef struct
+{
+    const element_slice *slices;
+    cJSON **items; /* parsed element i goes to items[i] */
+    size_t first;
+    size_t end;
+    cJSON_bool failed;
+} parse_job;
+
+/* the trees have to be freed by cJSON_Delete, so the workers allocate through the global hooks */
+static void * CJSON_CDECL parallel_malloc(size_t size)
+{
+    return cJSON_malloc(size);
+}
+
+static void CJSON_CDECL parallel_free(void *pointer)
+{
+    cJSON_free(pointer);
+}
+
+static cJSON_bool is_whitespace(const unsigned char c)
+{
+    return c <= 32;
+}
+
+/* Record where every element of the top-level array starts and ends, without whitespace around it.
+ * Only strings and brackets are tracked, the elements themselves are validated when they are parsed.
+ * Returns false if value isn't a single top-level array with balanced brackets. */
+static cJSON_bool find_elements(const unsigned char * const value, const size_t length, element_slice **slices, size_t *count)
+{
+    size_t capacity = 0;
+    size_t position = 0;
+    size_t depth = 0;
+    size_t start = 0;
+    size_t end = 0;
+    cJSON_bool in_string = false;
+    element_slice *new_slices = NULL;
+    unsigned char c = '\0';
+
+    *slices = NULL;
+    *count = 0;
+
+    /* skip the UTF-8 BOM, like cJSON_Parse does */
+    if ((length >= 3) && (strncmp((const char*)value, "\xEF\xBB\xBF", 3) == 0))
+    {
+        position = 3;
+    }
+    while ((position < length) && is_whitespace(value[position]) && (value[position] != '\0'))
+    {
+        position++;
+    }
+    if ((position >= length) || (value[position] != '['))
+    {
+        return false;
+    }
+    depth = 1;
+    position++;
+    start = position;
+
+    for (; position < length; position++)
+    {
+        c = value[position];
+        if (in_string)
+        {
+            if (c == '\\')
+            {
+                position++;
+            }
+            else if (c == '\"')
+            {
+                in_string = false;
+            }
+            continue;
+        }
+
+        switch (c)
+        {
+            case '\"':
+                in_string = true;
+                break;
+
+            case '[':
+            case '{':
+                if (++depth > CJSON_NESTING_LIMIT)
+                {
+                    goto fail;
+                }
+                break;
+
+            case ']':
+            case '}':
+                depth--;
+                if ((depth == 0) && (c != ']'))
+                {
+                    goto fail;
+                }
+                break;
+
+            case '\0':
+                goto fail;
+
+            default:
+                break;
+        }
+
+        /* a comma or the closing bracket of the top-level array ends an element */
+        if (!((depth == 1) && (c == ',')) && (depth != 0))
+        {
+            continue;
+        }
+
+        while ((start < position) && is_whitespace(value[start]))
+        {
+            start++;
+        }
+        end = position;
+        while ((end > start) && is_whitespace(value[end - 1]))
+        {
+            end--;
+        }
+
+        if (end == start)
+        {
+            /* only "[]" may be empty */
+            if ((c != ']') || (*count != 0))
+            {
+                goto fail;
+            }
+        }
+        else
+        {
+            if (*count == capacity)
+            {
+                capacity = (capacity == 0) ? 256 : (capacity * 2);
+                new_slices = (element_slice*)cJSON_malloc(capacity * sizeof(element_slice));
+                if (new_slices == NULL)
+                {
+                    goto fail;
+                }
+                if (*slices != NULL)
+                {
+                    memcpy(new_slices, *slices, *count * sizeof(element_slice));
+                    cJSON_free(*slices);
+                }
+                *slices = new_slices;
+            }
+            (*slices)[*count].start = (const char*)value + start;
+            (*slices)[*count].length = end - start;
+            (*count)++;
+        }
+
+        if (depth == 0)
+        {
+            break;
+        }
+        start = position + 1;
+    }
+
+    if (depth != 0)
+    {
+        goto fail;
+    }
+
+    /* only whitespace may follow the array */
+    for (position++; (position < length) && (value[position] != '\0'); position++)
+    {
+        if (!is_whitespace(value[position]))
+        {
+            goto fail;
+        }
+    }
+
+    return true;
+
+fail:
+    if (*slices != NULL)
+    {
+        cJSON_free(*slices);
+        *slices = NULL;
+    }
+    *count = 0;
+
+    return false;
+}
+
+static void run_job(parse_job * const job)
+{
+    cJSON_Hooks hooks = { parallel_malloc, parallel_free };
+    cJSON_Context *context = NULL;
+    const char *parse_end = NULL;
+    size_t i = 0;
+
+    context = cJSON_CreateContext(&hooks, 0);
+    if (context == NULL)
+    {
+        job->failed = true;
+        return;
+    }
+
+    for (i = job->first; i < job->end; i++)
+    {
+        job->items[i] = cJSON_ContextParseWithLengthOpts(context, job->slices[i].start, job->slices[i].length, &parse_end);
+        if ((job->items[i] == NULL) || (parse_end != (job->slices[i].start + job->slices[i].length)))
+        {
+            job->failed = true;
+            break;
+        }
+    }
+
+    cJSON_DeleteContext(context);
+}
+
+#if defined(_WIN32)
+static unsigned __stdcall job_thread(void *job)
+{
+    run_job((parse_job*)job);
+    return 0;
+}
+#else
+static void *job_thread(void *job)
+{
+    run_job((parse_job*)job);
+    return NULL;
+}
+#endif
+
+/* run every job but the first on a thread of its own, the first one on the calling thread */
+static void run_jobs(parse_job * const jobs, const size_t job_count)
+{
+#if defined(_WIN32)
+    HANDLE threads[PARALLEL_MAX_THREADS];
+#else
+    pthread_t threads[PARALLEL_MAX_THREADS];
+#endif
+    cJSON_bool started[PARALLEL_MAX_THREADS];
+    size_t i = 0;
+
+    for (i = 1; i < job_count; i++)
+    {
+#if defined(_WIN32)
+        threads[i] = (HANDLE)_beginthreadex(NULL, 0, job_thread, &jobs[i], 0, NULL);
+        started[i] = (threads[i] != 0);
+#else
+        started[i] = (pthread_create(&threads[i], NULL, job_thread, &jobs[i]) == 0);
+#endif
+        if (!started[i])
+        {
+            /* no more threads, do it here instead */
+            run_job(&jobs[i]);
+        }
+    }
+
+    run_job(&jobs[0]);
+
+    for (i = 1; i < job_count; i++)
+    {
+        if (!started[i])
+        {
+            continue;
+        }
+#if defined(_WIN32)
+        WaitForSingleObject(threads[i], INFINITE);
+        CloseHandle(threads[i]);
+#else
+        pthread_join(threads[i], NULL);
+#endif
+    }
+}
+
+CJSON_PUBLIC(cJSON *) cJSONParallel_ParseArray(const char *value, size_t buffer_length, int thread_count)
+{
+    parse_job jobs[PARALLEL_MAX_THREADS];
+    element_slice *slices = NULL;
+    cJSON **items = NULL;
+    cJSON *array = NULL;
+    size_t count = 0;
+    size_t job_count = 0;
+    size_t job_limit = 0;
+    size_t bytes = 0;
+    size_t total_bytes = 0;
+    size_t i = 0;
+    cJSON_bool failed = false;
+
+    if ((value == NULL) || (buffer_length < CJSON_PARALLEL_MIN_LENGTH) || (thread_count <= 1))
+    {
+        return cJSON_ParseWithLength(value, buffer_length);
+    }
+
+    if (!find_elements((const unsigned char*)value, buffer_length, &slices, &count) || (count < 2))
+    {
+        /* not an array worth splitting, or invalid: let the serial parser decide */
+        if (slices != NULL)
+        {
+            cJSON_free(slices);
+        }
+        return cJSON_ParseWithLength(value, buffer_length);
+    }
+
+    items = (cJSON**)cJSON_malloc(count * sizeof(cJSON*));
+    array = cJSON_CreateArray();
+    if ((items == NULL) || (array == NULL))
+    {
+        goto fail;
+    }
+    memset(items, '\0', count * sizeof(cJSON*));
+
+    /* split the elements into runs of about the same number of bytes */
+    job_limit = (size_t)thread_count;
+    if (job_limit > PARALLEL_MAX_THREADS)
+    {
+        job_limit = PARALLEL_MAX_THREADS;
+    }
+    for (i = 0; i < count; i++)
+    {
+        total_bytes += slices[i].length;
+    }
+    memset(jobs, '\0', sizeof(jobs));
+    job_count = 1;
+    for (i = 0; i < count; i++)
+    {
+        bytes += slices[i].length;
+        jobs[job_count - 1].end = i + 1;
+        if ((job_count < job_limit) && ((i + 1) < count) && (bytes >= ((total_bytes / job_limit) * job_count)))
+        {
+            jobs[job_count].first = i + 1;
+            job_count++;
+        }
+    }
+    for (i = 0; i < job_count; i++)
+    {
+        jobs[i].slices = slices;
+        jobs[i].items = items;
+    }
+
+    run_jobs(jobs, job_count);
+
+    for (i = 0; i < job_count; i++)
+    {
+        failed = failed || jobs[i].failed;
+    }
+    if (failed)
+    {
+        goto fail;
+    }
+
+    /* link the elements in order, the head's prev points to the tail like in parse_array */
+    for (i = 0; i < count; i++)
+    {
+        if (i > 0)
+        {
+            items[i - 1]->next = items[i];
+            items[i]->prev = items[i - 1];
+        }
+    }
+    items[0]->prev = items[count - 1];
+    array->child = items[0];
+
+    cJSON_free(items);
+    cJSON_free(slices);
+
+    return array;
+
+fail:
+    if (items != NULL)
+    {
+        for (i = 0; i < count; i++)
+        {
+            cJSON_Delete(items[i]);
+        }
+        cJSON_free(items);
+    }
+    cJSON_free(slices);
+    cJSON_Delete(array);
+
+    /* run the serial parser for the failure, so cJSON_GetErrorPtr points at the error */
+    return cJSON_ParseWithLength(value, buffer_length);
+}
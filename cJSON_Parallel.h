@@ -0,0 +1,34 @@
+/*
+  Parallel parsing of large top-level JSON arrays for cJSON.
+
+  A quick structural scan finds where each element of the top-level array
+  starts and ends, the elements are then parsed on several threads into
+  separate subtrees, and those are linked into one array in their original
+  order.
+*/
+
+#ifndef cJSON_Parallel__h
+#define cJSON_Parallel__h
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "cJSON.h"
+
+/* Inputs shorter than this are parsed on the calling thread, starting threads would cost more than it saves. */
+#ifndef CJSON_PARALLEL_MIN_LENGTH
+#define CJSON_PARALLEL_MIN_LENGTH (64 * 1024)
+#endif
+
+/* Parse value like cJSON_ParseWithLength, splitting the elements of a top-level array over up to thread_count threads.
+ * The result is the same tree, allocated with the hooks set by cJSON_InitHooks, so it is freed with cJSON_Delete.
+ * Anything else than a large array is parsed on the calling thread. Returns NULL if value isn't valid JSON. */
+CJSON_PUBLIC(cJSON *) cJSONParallel_ParseArray(const char *value, size_t buffer_length, int thread_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
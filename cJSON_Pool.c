@@ -0,0 +1,370 @@
+/*
+  Pooled allocator for cJSON, see cJSON_Pool.h
+*/
+
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#include "cJSON_Pool.h"
+
+#if defined(_MSC_VER)
+#define POOL_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__) || defined(__clang__)
+#define POOL_THREAD_LOCAL __thread
+#else
+#define POOL_THREAD_LOCAL _Thread_local
+#endif
+
+#if defined(_WIN32)
+typedef SRWLOCK pool_lock;
+#define POOL_LOCK_INIT SRWLOCK_INIT
+#define lock_pool(lock) AcquireSRWLockExclusive(lock)
+#define unlock_pool(lock) ReleaseSRWLockExclusive(lock)
+#else
+typedef pthread_mutex_t pool_lock;
+#define POOL_LOCK_INIT PTHREAD_MUTEX_INITIALIZER
+#define lock_pool(lock) pthread_mutex_lock(lock)
+#define unlock_pool(lock) pthread_mutex_unlock(lock)
+#endif
+
+/* block sizes are multiples of this, a cJSON node (72 bytes on 64 bit platforms) lands in the 80 byte class */
+#define POOL_GRANULARITY 16
+#define POOL_CLASS_COUNT 8 /* up to 128 bytes */
+#define POOL_LARGE POOL_CLASS_COUNT /* class of blocks that come straight from malloc */
+#define POOL_SLAB_SIZE (64 * 1024) /* what the size classes take from malloc at once */
+#define POOL_BATCH 64 /* blocks moved between a thread's cache and the shared lists at once */
+#define POOL_CACHE_LIMIT (4 * POOL_BATCH) /* more free blocks than this in a thread's cache go back to the shared list */
+
+/* sits in front of every block and tells free which size class it belongs to */
+typedef union
+{
+    size_t size_class;
+    double alignment_double;
+    void *alignment_pointer;
+} block_header;
+
+typedef struct free_block
+{
+    struct free_block *next;
+} free_block;
+
+typedef struct
+{
+    free_block *head;
+    size_t count;
+} free_list;
+
+typedef struct
+{
+    pool_lock lock;
+    free_list free;
+} shared_class;
+
+static shared_class shared_classes[POOL_CLASS_COUNT] = {
+    { POOL_LOCK_INIT, { NULL, 0 } }, { POOL_LOCK_INIT, { NULL, 0 } },
+    { POOL_LOCK_INIT, { NULL, 0 } }, { POOL_LOCK_INIT, { NULL, 0 } },
+    { POOL_LOCK_INIT, { NULL, 0 } }, { POOL_LOCK_INIT, { NULL, 0 } },
+    { POOL_LOCK_INIT, { NULL, 0 } }, { POOL_LOCK_INIT, { NULL, 0 } }
+};
+
+/* the slab that new blocks are carved from */
+static pool_lock slab_lock = POOL_LOCK_INIT;
+static unsigned char *slab_position = NULL;
+static size_t slab_remaining = 0;
+
+static POOL_THREAD_LOCAL free_list thread_cache[POOL_CLASS_COUNT];
+static POOL_THREAD_LOCAL int thread_registered = 0;
+
+#if defined(_WIN32)
+static INIT_ONCE exit_hook_once = INIT_ONCE_STATIC_INIT;
+static DWORD exit_hook = FLS_OUT_OF_INDEXES;
+#else
+static pthread_once_t exit_hook_once = PTHREAD_ONCE_INIT;
+static pthread_key_t exit_hook;
+#endif
+
+static size_t block_size(const size_t size_class)
+{
+    return sizeof(block_header) + ((size_class + 1) * POOL_GRANULARITY);
+}
+
+/* carve up to count new blocks of a class out of the current slab */
+static free_block *carve_blocks(const size_t size_class, size_t count, size_t *carved)
+{
+    const size_t size = block_size(size_class);
+    free_block *head = NULL;
+    block_header *header = NULL;
+
+    *carved = 0;
+
+    lock_pool(&slab_lock);
+    if (slab_remaining < size)
+    {
+        /* the rest of the old slab is too small for this class and stays unused */
+        slab_position = (unsigned char*)malloc(POOL_SLAB_SIZE);
+        slab_remaining = (slab_position == NULL) ? 0 : POOL_SLAB_SIZE;
+    }
+    while ((count > 0) && (slab_remaining >= size))
+    {
+        header = (block_header*)(void*)slab_position;
+        header->size_class = size_class;
+        ((free_block*)(void*)(header + 1))->next = head;
+        head = (free_block*)(void*)(header + 1);
+
+        slab_position += size;
+        slab_remaining -= size;
+        count--;
+        (*carved)++;
+    }
+    unlock_pool(&slab_lock);
+
+    return head;
+}
+
+/* give every block of the calling thread's cache back to the shared lists */
+static void flush_thread_cache(void)
+{
+    free_list *cache = NULL;
+    free_block *last = NULL;
+    size_t size_class = 0;
+
+    for (size_class = 0; size_class < POOL_CLASS_COUNT; size_class++)
+    {
+        cache = &thread_cache[size_class];
+        if (cache->head == NULL)
+        {
+            continue;
+        }
+        for (last = cache->head; last->next != NULL; last = last->next)
+        {
+        }
+
+        lock_pool(&shared_classes[size_class].lock);
+        last->next = shared_classes[size_class].free.head;
+        shared_classes[size_class].free.head = cache->head;
+        shared_classes[size_class].free.count += cache->count;
+        unlock_pool(&shared_classes[size_class].lock);
+
+        cache->head = NULL;
+        cache->count = 0;
+    }
+}
+
+/* make sure a thread's cache isn't lost when the thread exits */
+#if defined(_WIN32)
+static VOID WINAPI exit_callback(PVOID value)
+{
+    if (value != NULL)
+    {
+        flush_thread_cache();
+    }
+}
+
+static BOOL CALLBACK create_exit_hook(PINIT_ONCE once, PVOID parameter, PVOID *context)
+{
+    (void)once;
+    (void)parameter;
+    (void)context;
+    exit_hook = FlsAlloc(exit_callback);
+    return TRUE;
+}
+
+static void register_thread(void)
+{
+    InitOnceExecuteOnce(&exit_hook_once, create_exit_hook, NULL, NULL);
+    if (exit_hook != FLS_OUT_OF_INDEXES)
+    {
+        FlsSetValue(exit_hook, (PVOID)1);
+    }
+    thread_registered = 1;
+}
+#else
+static void exit_callback(void *value)
+{
+    (void)value;
+    flush_thread_cache();
+}
+
+static void create_exit_hook(void)
+{
+    pthread_key_create(&exit_hook, exit_callback);
+}
+
+static void register_thread(void)
+{
+    pthread_once(&exit_hook_once, create_exit_hook);
+    pthread_setspecific(exit_hook, &thread_registered);
+    thread_registered = 1;
+}
+#endif
+
+/* fill an empty thread cache from the shared list, or from the slab when that is empty too */
+static void refill_cache(free_list * const cache, const size_t size_class)
+{
+    shared_class * const shared = &shared_classes[size_class];
+    free_block *last = NULL;
+    size_t count = 0;
+
+    lock_pool(&shared->lock);
+    if (shared->free.head != NULL)
+    {
+        cache->head = shared->free.head;
+        for (last = shared->free.head, count = 1; (count < POOL_BATCH) && (last->next != NULL); count++)
+        {
+            last = last->next;
+        }
+        shared->free.head = last->next;
+        shared->free.count -= count;
+        last->next = NULL;
+        cache->count = count;
+    }
+    unlock_pool(&shared->lock);
+
+    if (cache->head == NULL)
+    {
+        cache->head = carve_blocks(size_class, POOL_BATCH, &cache->count);
+    }
+}
+
+/* hand a batch from a full thread cache back to the shared list */
+static void drain_cache(free_list * const cache, const size_t size_class)
+{
+    shared_class * const shared = &shared_classes[size_class];
+    free_block *first = cache->head;
+    free_block *last = cache->head;
+    size_t count = 1;
+
+    for (; count < POOL_BATCH; count++)
+    {
+        last = last->next;
+    }
+    cache->head = last->next;
+    cache->count -= count;
+
+    lock_pool(&shared->lock);
+    last->next = shared->free.head;
+    shared->free.head = first;
+    shared->free.count += count;
+    unlock_pool(&shared->lock);
+}
+
+static void * CJSON_CDECL pool_malloc(size_t size)
+{
+    free_list *cache = NULL;
+    free_block *block = NULL;
+    block_header *header = NULL;
+    size_t size_class = 0;
+
+    if (size == 0)
+    {
+        size = 1;
+    }
+
+    size_class = (size - 1) / POOL_GRANULARITY;
+    if (size_class >= POOL_CLASS_COUNT)
+    {
+        /* large blocks carry their size in a second header in front of the class */
+        if (size > ((size_t)-1 - 2 * sizeof(block_header)))
+        {
+            return NULL;
+        }
+        header = (block_header*)malloc(2 * sizeof(block_header) + size);
+        if (header == NULL)
+        {
+            return NULL;
+        }
+        header[0].size_class = size;
+        header[1].size_class = POOL_LARGE;
+        return header + 2;
+    }
+
+    cache = &thread_cache[size_class];
+    if (cache->head == NULL)
+    {
+        if (!thread_registered)
+        {
+            register_thread();
+        }
+        refill_cache(cache, size_class);
+        if (cache->head == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    block = cache->head;
+    cache->head = block->next;
+    cache->count--;
+
+    return block;
+}
+
+static void CJSON_CDECL pool_free(void *pointer)
+{
+    block_header *header = NULL;
+    free_list *cache = NULL;
+    free_block *block = (free_block*)pointer;
+    size_t size_class = 0;
+
+    if (pointer == NULL)
+    {
+        return;
+    }
+
+    header = (block_header*)pointer - 1;
+    size_class = header->size_class;
+    if (size_class == POOL_LARGE)
+    {
+        free(header - 1);
+        return;
+    }
+
+    /* blocks freed by another thread than the one that allocated them just move to this thread's cache */
+    if (!thread_registered)
+    {
+        register_thread();
+    }
+    cache = &thread_cache[size_class];
+    block->next = cache->head;
+    cache->head = block;
+    cache->count++;
+
+    if (cache->count > POOL_CACHE_LIMIT)
+    {
+        drain_cache(cache, size_class);
+    }
+}
+
+CJSON_PUBLIC(void) cJSONPool_GetHooks(cJSON_Hooks *hooks)
+{
+    if (hooks == NULL)
+    {
+        return;
+    }
+
+    hooks->malloc_fn = pool_malloc;
+    hooks->free_fn = pool_free;
+}
+
+CJSON_PUBLIC(size_t) cJSONPool_BlockSize(const void *pointer)
+{
+    const block_header *header = NULL;
+
+    if (pointer == NULL)
+    {
+        return 0;
+    }
+
+    header = (const block_header*)pointer - 1;
+    if (header->size_class == POOL_LARGE)
+    {
+        return header[-1].size_class;
+    }
+    return (header->size_class + 1) * POOL_GRANULARITY;
+}
@@ -0,0 +1,43 @@
+/*
+  Pooled allocator for cJSON.
+
+  Every cJSON node has the same size and most keys and string values are
+  short, so instead of going through malloc/free for each of them the pool
+  hands out blocks from per size class free lists. Each thread keeps a small
+  cache of free blocks per class and only takes the pool's lock to move whole
+  batches between its cache and the shared lists. Large requests still go to
+  malloc.
+
+  Install it once, before anything has been allocated through cJSON:
+
+      cJSON_Hooks hooks;
+      cJSONPool_GetHooks(&hooks);
+      cJSON_InitHooks(&hooks);
+
+  Memory taken from the system for the size classes is kept for reuse for the
+  lifetime of the process. Everything allocated through the pool must also be
+  freed through it, so don't switch hooks while pool blocks are still alive.
+*/
+
+#ifndef cJSON_Pool__h
+#define cJSON_Pool__h
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "cJSON.h"
+
+/* Fill hooks with the pool's malloc_fn and free_fn, for cJSON_InitHooks or cJSON_CreateContext. */
+CJSON_PUBLIC(void) cJSONPool_GetHooks(cJSON_Hooks *hooks);
+
+/* Usable size of a block the pool handed out: its size class, or the requested size for blocks
+   too large for any class. For accounting without wrapping the blocks, 0 for NULL. */
+CJSON_PUBLIC(size_t) cJSONPool_BlockSize(const void *pointer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,1299 @@
+/*
+  Streaming parser and writer for cJSON, see cJSON_Stream.h
+*/
+
+/* disable warnings about old C89 functions in MSVC */
+#if !defined(_CRT_SECURE_NO_DEPRECATE) && defined(_MSC_VER)
+#define _CRT_SECURE_NO_DEPRECATE
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+#include <limits.h>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#ifdef ENABLE_LOCALES
+#include <locale.h>
+#endif
+
+#include "cJSON_Stream.h"
+
+/* define our own boolean type */
+#ifdef true
+#undef true
+#endif
+#define true ((cJSON_bool)1)
+
+#ifdef false
+#undef false
+#endif
+#define false ((cJSON_bool)0)
+
+/* define isnan and isinf for ANSI C, if in C99 or above, isnan and isinf has been defined in math.h */
+#ifndef isinf
+#define isinf(d) (isnan((d - d)) && !isnan(d))
+#endif
+#ifndef isnan
+#define isnan(d) (d != d)
+#endif
+
+/* size of the buffer cJSONStream_ParseFile reads into */
+#define STREAM_READ_SIZE 4096
+
+/* numbers longer than this are rejected, same as in cJSON's parse_number */
+#define STREAM_NUMBER_LENGTH 63
+
+typedef enum
+{
+    expect_value,
+    expect_value_or_end, /* right after '[' */
+    expect_key_or_end, /* right after '{' */
+    expect_key, /* after a ',' in an object */
+    expect_colon,
+    expect_comma_or_end, /* after a value in an array or object */
+    expect_nothing /* the document is complete, only whitespace may follow */
+} stream_state;
+
+typedef enum
+{
+    token_none,
+    token_string,
+    token_number,
+    token_literal
+} stream_token;
+
+struct cJSON_StreamParser
+{
+    cJSON_StreamHandler handler;
+    void *user_data;
+
+    stream_state state;
+    stream_token token; /* token that is being read, it may span several chunks */
+    cJSON_bool token_is_key;
+    cJSON_bool escaped; /* the last byte of the string token was an unescaped backslash */
+    const char *literal; /* "true", "false" or "null" */
+    size_t literal_position;
+
+    /* raw bytes of the current string or number token */
+    unsigned char *buffer;
+    size_t buffer_length;
+    size_t buffer_size;
+
+    /* '{' or '[' for every container that is still open */
+    unsigned char containers[CJSON_NESTING_LIMIT];
+    size_t depth;
+
+    size_t offset; /* bytes consumed before the current chunk */
+    size_t error_offset;
+    size_t bom_length;
+    cJSON_bool failed;
+};
+
+/* get the decimal point character of the current locale */
+static unsigned char get_decimal_point(void)
+{
+#ifdef ENABLE_LOCALES
+    struct lconv *lconv = localeconv();
+    return (unsigned char) lconv->decimal_point[0];
+#else
+    return '.';
+#endif
+}
+
+CJSON_PUBLIC(cJSON_StreamParser *) cJSONStream_CreateParser(const cJSON_StreamHandler *handler, void *user_data)
+{
+    cJSON_StreamParser *parser = NULL;
+
+    if (handler == NULL)
+    {
+        return NULL;
+    }
+
+    parser = (cJSON_StreamParser*)cJSON_malloc(sizeof(cJSON_StreamParser));
+    if (parser == NULL)
+    {
+        return NULL;
+    }
+    memset(parser, '\0', sizeof(cJSON_StreamParser));
+
+    parser->handler = *handler;
+    parser->user_data = user_data;
+    parser->state = expect_value;
+    parser->token = token_none;
+
+    return parser;
+}
+
+CJSON_PUBLIC(void) cJSONStream_DeleteParser(cJSON_StreamParser *parser)
+{
+    if (parser == NULL)
+    {
+        return;
+    }
+
+    if (parser->buffer != NULL)
+    {
+        cJSON_free(parser->buffer);
+    }
+    cJSON_free(parser);
+}
+
+CJSON_PUBLIC(size_t) cJSONStream_GetErrorOffset(const cJSON_StreamParser *parser)
+{
+    if (parser == NULL)
+    {
+        return 0;
+    }
+
+    return parser->error_offset;
+}
+
+/* append to the token buffer, always leaving room for a terminating '\0' */
+static cJSON_bool buffer_append(cJSON_StreamParser * const parser, const unsigned char * const bytes, const size_t length)
+{
+    size_t needed = parser->buffer_length + length + sizeof("");
+
+    if (needed > parser->buffer_size)
+    {
+        unsigned char *new_buffer = NULL;
+        size_t new_size = (parser->buffer_size > 0) ? parser->buffer_size : 64;
+        while (new_size < needed)
+        {
+            new_size *= 2;
+        }
+
+        new_buffer = (unsigned char*)cJSON_malloc(new_size);
+        if (new_buffer == NULL)
+        {
+            return false;
+        }
+        if (parser->buffer != NULL)
+        {
+            memcpy(new_buffer, parser->buffer, parser->buffer_length);
+            cJSON_free(parser->buffer);
+        }
+        parser->buffer = new_buffer;
+        parser->buffer_size = new_size;
+    }
+
+    memcpy(parser->buffer + parser->buffer_length, bytes, length);
+    parser->buffer_length += length;
+
+    return true;
+}
+
+/* parse 4 digit hexadecimal number */
+static unsigned parse_hex4(const unsigned char * const input)
+{
+    unsigned int h = 0;
+    size_t i = 0;
+
+    for (i = 0; i < 4; i++)
+    {
+        h <<= 4;
+        if ((input[i] >= '0') && (input[i] <= '9'))
+        {
+            h += (unsigned int) input[i] - '0';
+        }
+        else if ((input[i] >= 'A') && (input[i] <= 'F'))
+        {
+            h += (unsigned int) 10 + input[i] - 'A';
+        }
+        else if ((input[i] >= 'a') && (input[i] <= 'f'))
+        {
+            h += (unsigned int) 10 + input[i] - 'a';
+        }
+        else /* invalid */
+        {
+            return 0;
+        }
+    }
+
+    return h;
+}
+
+/* converts one or two \uXXXX sequences to UTF-8, returns how many input bytes were used or 0 on failure */
+static size_t utf16_literal_to_utf8(const unsigned char * const input, const unsigned char * const input_end, unsigned char **output)
+{
+    unsigned long codepoint = 0;
+    unsigned int first_code = 0;
+    size_t sequence_length = 6;
+    size_t utf8_length = 0;
+    size_t position = 0;
+    unsigned char first_byte_mark = 0;
+
+    if ((input_end - input) < 6)
+    {
+        return 0;
+    }
+
+    first_code = parse_hex4(input + 2);
+    if ((first_code >= 0xDC00) && (first_code <= 0xDFFF))
+    {
+        return 0;
+    }
+
+    codepoint = first_code;
+    if ((first_code >= 0xD800) && (first_code <= 0xDBFF))
+    {
+        /* UTF16 surrogate pair */
+        unsigned int second_code = 0;
+        if (((input_end - input) < 12) || (input[6] != '\\') || (input[7] != 'u'))
+        {
+            return 0;
+        }
+        second_code = parse_hex4(input + 8);
+        if ((second_code < 0xDC00) || (second_code > 0xDFFF))
+        {
+            return 0;
+        }
+
+        codepoint = 0x10000 + (((first_code & 0x3FF) << 10) | (second_code & 0x3FF));
+        sequence_length = 12;
+    }
+
+    if (codepoint < 0x80)
+    {
+        utf8_length = 1;
+    }
+    else if (codepoint < 0x800)
+    {
+        utf8_length = 2;
+        first_byte_mark = 0xC0;
+    }
+    else if (codepoint < 0x10000)
+    {
+        utf8_length = 3;
+        first_byte_mark = 0xE0;
+    }
+    else
+    {
+        utf8_length = 4;
+        first_byte_mark = 0xF0;
+    }
+
+    for (position = utf8_length - 1; position > 0; position--)
+    {
+        (*output)[position] = (unsigned char)((codepoint | 0x80) & 0xBF);
+        codepoint >>= 6;
+    }
+    (*output)[0] = (unsigned char)((utf8_length > 1) ? ((codepoint | first_byte_mark) & 0xFF) : (codepoint & 0x7F));
+    *output += utf8_length;
+
+    return sequence_length;
+}
+
+/* Unescape the string token in place, the result is never longer than the input. */
+static cJSON_bool unescape_buffer(cJSON_StreamParser * const parser)
+{
+    const unsigned char *input = parser->buffer;
+    const unsigned char *input_end = parser->buffer + parser->buffer_length;
+    unsigned char *output = parser->buffer;
+
+    while (input < input_end)
+    {
+        const unsigned char *escape = (const unsigned char*)memchr(input, '\\', (size_t)(input_end - input));
+        if (escape == NULL)
+        {
+            escape = input_end;
+        }
+        memmove(output, input, (size_t)(escape - input));
+        output += escape - input;
+        input = escape;
+        if (input == input_end)
+        {
+            break;
+        }
+
+        if ((input_end - input) < 2)
+        {
+            return false;
+        }
+        switch (input[1])
+        {
+            case 'b':
+                *output++ = '\b';
+                break;
+            case 'f':
+                *output++ = '\f';
+                break;
+            case 'n':
+                *output++ = '\n';
+                break;
+            case 'r':
+                *output++ = '\r';
+                break;
+            case 't':
+                *output++ = '\t';
+                break;
+            case '\"':
+            case '\\':
+            case '/':
+                *output++ = input[1];
+                break;
+
+            case 'u':
+            {
+                size_t sequence_length = utf16_literal_to_utf8(input, input_end, &output);
+                if (sequence_length == 0)
+                {
+                    return false;
+                }
+                input += sequence_length;
+                continue;
+            }
+
+            default:
+                return false;
+        }
+        input += 2;
+    }
+
+    *output = '\0';
+    parser->buffer_length = (size_t)(output - parser->buffer);
+
+    return true;
+}
+
+/* a value (scalar or whole container) has been read */
+static void value_done(cJSON_StreamParser * const parser)
+{
+    parser->state = (parser->depth == 0) ? expect_nothing : expect_comma_or_end;
+}
+
+static cJSON_bool open_container(cJSON_StreamParser * const parser, const unsigned char bracket)
+{
+    cJSON_bool (*callback)(void *user_data) = (bracket == '{') ? parser->handler.start_object : parser->handler.start_array;
+
+    if (parser->depth >= CJSON_NESTING_LIMIT)
+    {
+        return false; /* too deeply nested */
+    }
+    parser->containers[parser->depth++] = bracket;
+    parser->state = (bracket == '{') ? expect_key_or_end : expect_value_or_end;
+
+    return (callback == NULL) || callback(parser->user_data);
+}
+
+static cJSON_bool close_container(cJSON_StreamParser * const parser, const unsigned char bracket)
+{
+    cJSON_bool (*callback)(void *user_data) = NULL;
+
+    if ((parser->depth == 0) || (parser->containers[parser->depth - 1] != ((bracket == '}') ? '{' : '[')))
+    {
+        return false;
+    }
+    parser->depth--;
+    value_done(parser);
+
+    callback = (bracket == '}') ? parser->handler.end_object : parser->handler.end_array;
+    return (callback == NULL) || callback(parser->user_data);
+}
+
+static cJSON_bool finish_string(cJSON_StreamParser * const parser)
+{
+    parser->token = token_none;
+    /* make sure there is a buffer to terminate, even for "" */
+    if (!buffer_append(parser, (const unsigned char*)"", 0) || !unescape_buffer(parser))
+    {
+        return false;
+    }
+
+    if (parser->token_is_key)
+    {
+        parser->state = expect_colon;
+        return (parser->handler.key == NULL) || parser->handler.key(parser->user_data, (const char*)parser->buffer, parser->buffer_length);
+    }
+
+    value_done(parser);
+    return (parser->handler.string == NULL) || parser->handler.string(parser->user_data, (const char*)parser->buffer, parser->buffer_length);
+}
+
+static cJSON_bool finish_number(cJSON_StreamParser * const parser)
+{
+    unsigned char decimal_point = get_decimal_point();
+    char *after_end = NULL;
+    double number = 0;
+    size_t i = 0;
+
+    parser->token = token_none;
+
+    /* strtod wants the decimal point of the current locale */
+    for (i = 0; i < parser->buffer_length; i++)
+    {
+        if (parser->buffer[i] == '.')
+        {
+            parser->buffer[i] = decimal_point;
+        }
+    }
+    parser->buffer[parser->buffer_length] = '\0';
+
+    number = strtod((const char*)parser->buffer, &after_end);
+    if ((after_end == (char*)parser->buffer) || (after_end != (char*)parser->buffer + parser->buffer_length))
+    {
+        return false;
+    }
+
+    value_done(parser);
+    return (parser->handler.number == NULL) || parser->handler.number(parser->user_data, number);
+}
+
+static cJSON_bool finish_literal(cJSON_StreamParser * const parser)
+{
+    const char *literal = parser->literal;
+
+    parser->token = token_none;
+    value_done(parser);
+
+    if (literal[0] == 'n')
+    {
+        return (parser->handler.null == NULL) || parser->handler.null(parser->user_data);
+    }
+
+    return (parser->handler.boolean == NULL) || parser->handler.boolean(parser->user_data, (literal[0] == 't') ? true : false);
+}
+
+/* the first byte of a value */
+static cJSON_bool start_value(cJSON_StreamParser * const parser, const unsigned char c)
+{
+    switch (c)
+    {
+        case '{':
+        case '[':
+            return open_container(parser, c);
+
+        case '\"':
+            parser->token = token_string;
+            parser->token_is_key = false;
+            parser->escaped = false;
+            parser->buffer_length = 0;
+            return true;
+
+        case 't':
+            parser->literal = "true";
+            break;
+        case 'f':
+            parser->literal = "false";
+            break;
+        case 'n':
+            parser->literal = "null";
+            break;
+
+        default:
+            if ((c == '-') || ((c >= '0') && (c <= '9')))
+            {
+                parser->token = token_number;
+                parser->buffer_length = 0;
+                return buffer_append(parser, &c, 1);
+            }
+            return false;
+    }
+
+    parser->token = token_literal;
+    parser->literal_position = 1;
+    return true;
+}
+
+/* a structural byte or the start of a token, whitespace has already been skipped */
+static cJSON_bool handle_byte(cJSON_StreamParser * const parser, const unsigned char c)
+{
+    switch (parser->state)
+    {
+        case expect_value_or_end:
+            if (c == ']')
+            {
+                return close_container(parser, c);
+            }
+            return start_value(parser, c);
+
+        case expect_value:
+            return start_value(parser, c);
+
+        case expect_key_or_end:
+            if (c == '}')
+            {
+                return close_container(parser, c);
+            }
+            /* fall through */
+        case expect_key:
+            if (c != '\"')
+            {
+                return false;
+            }
+            parser->token = token_string;
+            parser->token_is_key = true;
+            parser->escaped = false;
+            parser->buffer_length = 0;
+            return true;
+
+        case expect_colon:
+            if (c != ':')
+            {
+                return false;
+            }
+            parser->state = expect_value;
+            return true;
+
+        case expect_comma_or_end:
+            if (c == ',')
+            {
+                parser->state = (parser->containers[parser->depth - 1] == '{') ? expect_key : expect_value;
+                return true;
+            }
+            if ((c == '}') || (c == ']'))
+            {
+                return close_container(parser, c);
+            }
+            return false;
+
+        case expect_nothing:
+        default:
+            return false;
+    }
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Feed(cJSON_StreamParser *parser, const char *chunk, size_t length)
+{
+    const unsigned char *input = (const unsigned char*)chunk;
+    size_t i = 0;
+
+    if ((parser == NULL) || parser->failed)
+    {
+        return false;
+    }
+    if ((chunk == NULL) && (length > 0))
+    {
+        goto fail;
+    }
+
+    /* skip the UTF-8 BOM (byte order mark) at the beginning of the document */
+    for (; (i < length) && ((parser->offset + i) < 3) && (parser->bom_length == (parser->offset + i)); i++)
+    {
+        if (input[i] != (unsigned char)"\xEF\xBB\xBF"[parser->offset + i])
+        {
+            if (parser->bom_length > 0)
+            {
+                goto fail;
+            }
+            break;
+        }
+        parser->bom_length++;
+    }
+
+    while (i < length)
+    {
+        const unsigned char c = input[i];
+
+        switch (parser->token)
+        {
+            case token_string:
+                if (parser->escaped)
+                {
+                    parser->escaped = false;
+                    if (!buffer_append(parser, &c, 1))
+                    {
+                        goto fail;
+                    }
+                    i++;
+                }
+                else if (c == '\\')
+                {
+                    parser->escaped = true;
+                    if (!buffer_append(parser, &c, 1))
+                    {
+                        goto fail;
+                    }
+                    i++;
+                }
+                else if (c == '\"')
+                {
+                    if (!finish_string(parser))
+                    {
+                        goto fail;
+                    }
+                    i++;
+                }
+                else
+                {
+                    /* take the whole run up to the next quote or backslash */
+                    size_t run_end = i + 1;
+                    while ((run_end < length) && (input[run_end] != '\"') && (input[run_end] != '\\'))
+                    {
+                        run_end++;
+                    }
+                    if (!buffer_append(parser, input + i, run_end - i))
+                    {
+                        goto fail;
+                    }
+                    i = run_end;
+                }
+                continue;
+
+            case token_number:
+                if (((c >= '0') && (c <= '9')) || (c == '+') || (c == '-') || (c == '.') || (c == 'e') || (c == 'E'))
+                {
+                    if ((parser->buffer_length >= STREAM_NUMBER_LENGTH) || !buffer_append(parser, &c, 1))
+                    {
+                        goto fail;
+                    }
+                    i++;
+                    continue;
+                }
+                if (!finish_number(parser))
+                {
+                    goto fail;
+                }
+                /* c has not been consumed yet */
+                break;
+
+            case token_literal:
+                if (c != (unsigned char)parser->literal[parser->literal_position])
+                {
+                    goto fail;
+                }
+                i++;
+                parser->literal_position++;
+                if ((parser->literal[parser->literal_position] == '\0') && !finish_literal(parser))
+                {
+                    goto fail;
+                }
+                continue;
+
+            case token_none:
+            default:
+                break;
+        }
+
+        /* skip whitespace and cr/lf */
+        if (c <= 32)
+        {
+            i++;
+            continue;
+        }
+
+        if (!handle_byte(parser, c))
+        {
+            goto fail;
+        }
+        i++;
+    }
+
+    parser->offset += length;
+    return true;
+
+fail:
+    parser->failed = true;
+    parser->error_offset = parser->offset + i;
+    return false;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Finish(cJSON_StreamParser *parser)
+{
+    if ((parser == NULL) || parser->failed)
+    {
+        return false;
+    }
+
+    /* a number at the very end of the input has nothing after it to end it */
+    if ((parser->token == token_number) && !finish_number(parser))
+    {
+        goto fail;
+    }
+
+    if ((parser->token != token_none) || (parser->state != expect_nothing))
+    {
+        goto fail; /* input ended unexpectedly */
+    }
+
+    return true;
+
+fail:
+    parser->failed = true;
+    parser->error_offset = parser->offset;
+    return false;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_ParseFile(FILE *file, const cJSON_StreamHandler *handler, void *user_data)
+{
+    char chunk[STREAM_READ_SIZE];
+    cJSON_StreamParser *parser = NULL;
+    cJSON_bool success = false;
+    size_t length = 0;
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    parser = cJSONStream_CreateParser(handler, user_data);
+    if (parser == NULL)
+    {
+        return false;
+    }
+
+    while ((length = fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        if (!cJSONStream_Feed(parser, chunk, length))
+        {
+            goto end;
+        }
+    }
+
+    success = !ferror(file) && cJSONStream_Finish(parser);
+
+end:
+    cJSONStream_DeleteParser(parser);
+
+    return success;
+}
+
+struct cJSON_StreamWriter
+{
+    FILE *file; /* either file is set or fd is used */
+    int fd;
+    cJSON_bool format;
+
+    /* for every container that is still open: '{' or '[' and whether it has members yet */
+    unsigned char containers[CJSON_NESTING_LIMIT];
+    cJSON_bool has_members[CJSON_NESTING_LIMIT];
+    size_t depth;
+    cJSON_bool after_key; /* a key has been written and its value is due */
+    cJSON_bool done; /* a complete top level value has been written */
+    cJSON_bool failed;
+
+    size_t length;
+    unsigned char buffer[CJSON_STREAM_BUFFER_SIZE];
+};
+
+static cJSON_StreamWriter *create_writer(FILE *file, int fd, cJSON_bool format)
+{
+    cJSON_StreamWriter *writer = (cJSON_StreamWriter*)cJSON_malloc(sizeof(cJSON_StreamWriter));
+    if (writer == NULL)
+    {
+        return NULL;
+    }
+    memset(writer, '\0', sizeof(cJSON_StreamWriter) - sizeof(writer->buffer));
+
+    writer->file = file;
+    writer->fd = fd;
+    writer->format = format;
+
+    return writer;
+}
+
+CJSON_PUBLIC(cJSON_StreamWriter *) cJSONStream_CreateFileWriter(FILE *file, cJSON_bool format)
+{
+    if (file == NULL)
+    {
+        return NULL;
+    }
+
+    return create_writer(file, -1, format);
+}
+
+CJSON_PUBLIC(cJSON_StreamWriter *) cJSONStream_CreateFdWriter(int fd, cJSON_bool format)
+{
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    return create_writer(NULL, fd, format);
+}
+
+CJSON_PUBLIC(void) cJSONStream_DeleteWriter(cJSON_StreamWriter *writer)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+
+    cJSON_free(writer);
+}
+
+/* hand bytes to the file or descriptor, bypassing the buffer */
+static cJSON_bool write_out(cJSON_StreamWriter * const writer, const unsigned char *bytes, size_t length)
+{
+    if (writer->file != NULL)
+    {
+        return fwrite(bytes, 1, length, writer->file) == length;
+    }
+
+    while (length > 0)
+    {
+#if defined(_WIN32)
+        int written = _write(writer->fd, bytes, (length > INT_MAX) ? INT_MAX : (unsigned int)length);
+#else
+        ssize_t written = write(writer->fd, bytes, length);
+        if ((written < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+#endif
+        if (written <= 0)
+        {
+            return false;
+        }
+        bytes += written;
+        length -= (size_t)written;
+    }
+
+    return true;
+}
+
+static cJSON_bool flush_buffer(cJSON_StreamWriter * const writer)
+{
+    if (writer->length == 0)
+    {
+        return true;
+    }
+
+    if (!write_out(writer, writer->buffer, writer->length))
+    {
+        writer->failed = true;
+        return false;
+    }
+    writer->length = 0;
+
+    return true;
+}
+
+static cJSON_bool put_bytes(cJSON_StreamWriter * const writer, const unsigned char *bytes, size_t length)
+{
+    if ((writer->length + length) > sizeof(writer->buffer))
+    {
+        if (!flush_buffer(writer))
+        {
+            return false;
+        }
+
+        /* too big to ever fit, don't copy it around */
+        if (length > sizeof(writer->buffer))
+        {
+            if (!write_out(writer, bytes, length))
+            {
+                writer->failed = true;
+                return false;
+            }
+            return true;
+        }
+    }
+
+    memcpy(writer->buffer + writer->length, bytes, length);
+    writer->length += length;
+
+    return true;
+}
+
+static cJSON_bool put_byte(cJSON_StreamWriter * const writer, const unsigned char c)
+{
+    if ((writer->length == sizeof(writer->buffer)) && !flush_buffer(writer))
+    {
+        return false;
+    }
+    writer->buffer[writer->length++] = c;
+
+    return true;
+}
+
+static cJSON_bool put_tabs(cJSON_StreamWriter * const writer, size_t count)
+{
+    while (count-- > 0)
+    {
+        if (!put_byte(writer, '\t'))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* write a string in quotes, escaped the same way as cJSON's print_string_ptr */
+static cJSON_bool put_string(cJSON_StreamWriter * const writer, const unsigned char *input)
+{
+    const unsigned char *run = NULL;
+    unsigned char escape[7];
+
+    if (!put_byte(writer, '\"'))
+    {
+        return false;
+    }
+
+    if (input != NULL)
+    {
+        for (run = input; *input != '\0'; input++)
+        {
+            if ((*input >= 32) && (*input != '\"') && (*input != '\\'))
+            {
+                continue;
+            }
+
+            if (!put_bytes(writer, run, (size_t)(input - run)))
+            {
+                return false;
+            }
+            run = input + 1;
+
+            escape[0] = '\\';
+            escape[2] = '\0';
+            switch (*input)
+            {
+                case '\\':
+                    escape[1] = '\\';
+                    break;
+                case '\"':
+                    escape[1] = '\"';
+                    break;
+                case '\b':
+                    escape[1] = 'b';
+                    break;
+                case '\f':
+                    escape[1] = 'f';
+                    break;
+                case '\n':
+                    escape[1] = 'n';
+                    break;
+                case '\r':
+                    escape[1] = 'r';
+                    break;
+                case '\t':
+                    escape[1] = 't';
+                    break;
+                default:
+                    /* escape and print as unicode codepoint */
+                    sprintf((char*)escape + 1, "u%04x", *input);
+                    break;
+            }
+            if (!put_bytes(writer, escape, strlen((const char*)escape)))
+            {
+                return false;
+            }
+        }
+
+        if (!put_bytes(writer, run, (size_t)(input - run)))
+        {
+            return false;
+        }
+    }
+
+    return put_byte(writer, '\"');
+}
+
+/* check that a value may come now and write whatever separates it from the previous one */
+static cJSON_bool begin_value(cJSON_StreamWriter * const writer)
+{
+    size_t current = 0;
+
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+
+    if (writer->depth == 0)
+    {
+        if (writer->done)
+        {
+            goto fail; /* only one top level value */
+        }
+        return true;
+    }
+
+    current = writer->depth - 1;
+    if (writer->containers[current] == '{')
+    {
+        if (!writer->after_key)
+        {
+            goto fail; /* cJSONStream_Key has to come first */
+        }
+        writer->after_key = false;
+        return true;
+    }
+
+    if (writer->has_members[current])
+    {
+        if (!put_byte(writer, ','))
+        {
+            return false;
+        }
+        if (writer->format && !put_byte(writer, ' '))
+        {
+            return false;
+        }
+    }
+    writer->has_members[current] = true;
+
+    return true;
+
+fail:
+    writer->failed = true;
+    return false;
+}
+
+static void end_value(cJSON_StreamWriter * const writer)
+{
+    if (writer->depth == 0)
+    {
+        writer->done = true;
+    }
+}
+
+static cJSON_bool begin_container(cJSON_StreamWriter * const writer, const unsigned char bracket)
+{
+    if (!begin_value(writer))
+    {
+        return false;
+    }
+
+    if (writer->depth >= CJSON_NESTING_LIMIT)
+    {
+        writer->failed = true;
+        return false;
+    }
+
+    writer->containers[writer->depth] = bracket;
+    writer->has_members[writer->depth] = false;
+    writer->depth++;
+
+    if (!put_byte(writer, bracket))
+    {
+        return false;
+    }
+    if ((bracket == '{') && writer->format)
+    {
+        return put_byte(writer, '\n');
+    }
+
+    return true;
+}
+
+static cJSON_bool end_container(cJSON_StreamWriter * const writer, const unsigned char bracket)
+{
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+
+    if ((writer->depth == 0) || (writer->containers[writer->depth - 1] != bracket) || writer->after_key)
+    {
+        writer->failed = true;
+        return false;
+    }
+    writer->depth--;
+
+    if ((bracket == '{') && writer->format)
+    {
+        if (writer->has_members[writer->depth] && !put_byte(writer, '\n'))
+        {
+            return false;
+        }
+        if (!put_tabs(writer, writer->depth))
+        {
+            return false;
+        }
+    }
+
+    if (!put_byte(writer, (bracket == '{') ? '}' : ']'))
+    {
+        return false;
+    }
+    end_value(writer);
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_BeginObject(cJSON_StreamWriter *writer)
+{
+    return begin_container(writer, '{');
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_EndObject(cJSON_StreamWriter *writer)
+{
+    return end_container(writer, '{');
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_BeginArray(cJSON_StreamWriter *writer)
+{
+    return begin_container(writer, '[');
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_EndArray(cJSON_StreamWriter *writer)
+{
+    return end_container(writer, '[');
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Key(cJSON_StreamWriter *writer, const char *key)
+{
+    size_t current = 0;
+
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+
+    if ((key == NULL) || (writer->depth == 0) || (writer->containers[writer->depth - 1] != '{') || writer->after_key)
+    {
+        writer->failed = true;
+        return false;
+    }
+    current = writer->depth - 1;
+
+    if (writer->has_members[current])
+    {
+        if (!put_byte(writer, ','))
+        {
+            return false;
+        }
+        if (writer->format && !put_byte(writer, '\n'))
+        {
+            return false;
+        }
+    }
+    writer->has_members[current] = true;
+
+    if (writer->format && !put_tabs(writer, writer->depth))
+    {
+        return false;
+    }
+    if (!put_string(writer, (const unsigned char*)key) || !put_byte(writer, ':'))
+    {
+        return false;
+    }
+    if (writer->format && !put_byte(writer, '\t'))
+    {
+        return false;
+    }
+    writer->after_key = true;
+
+    return true;
+}
+
+static cJSON_bool put_literal(cJSON_StreamWriter * const writer, const char * const literal)
+{
+    if (!begin_value(writer) || !put_bytes(writer, (const unsigned char*)literal, strlen(literal)))
+    {
+        return false;
+    }
+    end_value(writer);
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Int(cJSON_StreamWriter *writer, int number)
+{
+    char number_buffer[26];
+
+    sprintf(number_buffer, "%d", number);
+
+    return put_literal(writer, number_buffer);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Number(cJSON_StreamWriter *writer, double number)
+{
+    unsigned char number_buffer[26] = {0};
+    unsigned char decimal_point = get_decimal_point();
+    int valueint = 0;
+    int length = 0;
+    int i = 0;
+    double test = 0.0;
+
+    /* the same rules as cJSON_CreateNumber followed by print_number */
+    if (number >= INT_MAX)
+    {
+        valueint = INT_MAX;
+    }
+    else if (number <= (double)INT_MIN)
+    {
+        valueint = INT_MIN;
+    }
+    else
+    {
+        valueint = (int)number;
+    }
+
+    if (isnan(number) || isinf(number))
+    {
+        return put_literal(writer, "null");
+    }
+    else if (number == (double)valueint)
+    {
+        length = sprintf((char*)number_buffer, "%d", valueint);
+    }
+    else
+    {
+        length = sprintf((char*)number_buffer, "%1.15g", number);
+        if ((sscanf((char*)number_buffer, "%lg", &test) != 1)
+            || (fabs(test - number) > ((fabs(test) > fabs(number)) ? fabs(test) : fabs(number)) * DBL_EPSILON))
+        {
+            length = sprintf((char*)number_buffer, "%1.17g", number);
+        }
+    }
+
+    if ((length < 0) || (length > (int)(sizeof(number_buffer) - 1)))
+    {
+        if (writer != NULL)
+        {
+            writer->failed = true;
+        }
+        return false;
+    }
+
+    for (i = 0; i < length; i++)
+    {
+        if (number_buffer[i] == decimal_point)
+        {
+            number_buffer[i] = '.';
+        }
+    }
+
+    return put_literal(writer, (const char*)number_buffer);
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_String(cJSON_StreamWriter *writer, const char *string)
+{
+    if (!begin_value(writer) || !put_string(writer, (const unsigned char*)string))
+    {
+        return false;
+    }
+    end_value(writer);
+
+    return true;
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Bool(cJSON_StreamWriter *writer, cJSON_bool boolean)
+{
+    return put_literal(writer, boolean ? "true" : "false");
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Null(cJSON_StreamWriter *writer)
+{
+    return put_literal(writer, "null");
+}
+
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Flush(cJSON_StreamWriter *writer)
+{
+    if ((writer == NULL) || writer->failed)
+    {
+        return false;
+    }
+
+    if (!flush_buffer(writer))
+    {
+        return false;
+    }
+    if ((writer->file != NULL) && (fflush(writer->file) != 0))
+    {
+        writer->failed = true;
+        return false;
+    }
+
+    return true;
+}
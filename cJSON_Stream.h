@@ -0,0 +1,87 @@
+/*
+  Streaming companion to cJSON.
+
+  The parser takes JSON text in chunks of any size and reports what it finds
+  through callbacks (SAX style), and the writer renders JSON through a fixed
+  size buffer straight into a FILE or file descriptor. Neither of them ever
+  builds a cJSON tree.
+*/
+
+#ifndef cJSON_Stream__h
+#define cJSON_Stream__h
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdio.h>
+#include "cJSON.h"
+
+/* Callbacks for the streaming parser. Every one of them may be NULL.
+ * Returning false from a callback stops the parse, which then counts as failed.
+ * key and string are null terminated (length doesn't count the terminator) and are only valid during the call. */
+typedef struct cJSON_StreamHandler
+{
+    cJSON_bool (*start_object)(void *user_data);
+    cJSON_bool (*end_object)(void *user_data);
+    cJSON_bool (*start_array)(void *user_data);
+    cJSON_bool (*end_array)(void *user_data);
+    cJSON_bool (*key)(void *user_data, const char *key, size_t length);
+    cJSON_bool (*string)(void *user_data, const char *string, size_t length);
+    cJSON_bool (*number)(void *user_data, double number);
+    cJSON_bool (*boolean)(void *user_data, cJSON_bool boolean);
+    cJSON_bool (*null)(void *user_data);
+} cJSON_StreamHandler;
+
+typedef struct cJSON_StreamParser cJSON_StreamParser;
+
+/* Create a parser for one JSON document. Free it with cJSONStream_DeleteParser. */
+CJSON_PUBLIC(cJSON_StreamParser *) cJSONStream_CreateParser(const cJSON_StreamHandler *handler, void *user_data);
+/* Feed the next chunk of the document. Returns false as soon as the input is invalid or a callback stopped the parse. */
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Feed(cJSON_StreamParser *parser, const char *chunk, size_t length);
+/* Tell the parser that the input is complete. Returns true if it was exactly one valid JSON value. */
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Finish(cJSON_StreamParser *parser);
+/* Offset in the whole input at which parsing failed. */
+CJSON_PUBLIC(size_t) cJSONStream_GetErrorOffset(const cJSON_StreamParser *parser);
+CJSON_PUBLIC(void) cJSONStream_DeleteParser(cJSON_StreamParser *parser);
+
+/* Parse a whole file through a fixed size read buffer. */
+CJSON_PUBLIC(cJSON_bool) cJSONStream_ParseFile(FILE *file, const cJSON_StreamHandler *handler, void *user_data);
+
+/* Size of the writer's output buffer. */
+#ifndef CJSON_STREAM_BUFFER_SIZE
+#define CJSON_STREAM_BUFFER_SIZE 4096
+#endif
+
+typedef struct cJSON_StreamWriter cJSON_StreamWriter;
+
+/* Create a writer that renders into a buffer of CJSON_STREAM_BUFFER_SIZE bytes and writes it out whenever it is full.
+ * format=1 gives the same layout as cJSON_Print, format=0 the same as cJSON_PrintUnformatted.
+ * The file or descriptor stays open when the writer is deleted. */
+CJSON_PUBLIC(cJSON_StreamWriter *) cJSONStream_CreateFileWriter(FILE *file, cJSON_bool format);
+CJSON_PUBLIC(cJSON_StreamWriter *) cJSONStream_CreateFdWriter(int fd, cJSON_bool format);
+
+/* Emit the next piece of the document. Inside an object every value has to be preceded by cJSONStream_Key.
+ * All of these return false once anything went wrong (misplaced call, write error, nesting limit) and do nothing after that. */
+CJSON_PUBLIC(cJSON_bool) cJSONStream_BeginObject(cJSON_StreamWriter *writer);
+CJSON_PUBLIC(cJSON_bool) cJSONStream_EndObject(cJSON_StreamWriter *writer);
+CJSON_PUBLIC(cJSON_bool) cJSONStream_BeginArray(cJSON_StreamWriter *writer);
+CJSON_PUBLIC(cJSON_bool) cJSONStream_EndArray(cJSON_StreamWriter *writer);
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Key(cJSON_StreamWriter *writer, const char *key);
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Int(cJSON_StreamWriter *writer, int number);
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Number(cJSON_StreamWriter *writer, double number);
+CJSON_PUBLIC(cJSON_bool) cJSONStream_String(cJSON_StreamWriter *writer, const char *string);
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Bool(cJSON_StreamWriter *writer, cJSON_bool boolean);
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Null(cJSON_StreamWriter *writer);
+
+/* Write out everything that is still buffered. Returns true if the whole document so far has been written without error. */
+CJSON_PUBLIC(cJSON_bool) cJSONStream_Flush(cJSON_StreamWriter *writer);
+/* Free the writer without flushing it. */
+CJSON_PUBLIC(void) cJSONStream_DeleteWriter(cJSON_StreamWriter *writer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,148 @@
+#include <stdlib.h>
+#include <math.h>
+#include "grade_aggregates.h"
+#include "memory_stats.h"
+
+#define MaxGrade 100
+
+// Besides the totals every cell counts how many students have each grade, so the
+// minimum and maximum can move up or down when a student leaves without a rescan
+// of the class: at most MaxGrade counts are looked at. Grades outside 0-100 are
+// counted at the nearest end for the minimum and maximum only.
+typedef struct {
+    GradeTotals totals;
+    int students[MaxGrade + 1];
+} GradeCell;
+
+// Cells are allocated a class at a time, when the class gets its first student, so a
+// school only pays for the classes it has
+typedef struct {
+    GradeCell courses[SUBJECTS];
+} ClassCells;
+
+struct GradeAggregates {
+    ClassCells *classes[MAX_GRADES][MAX_CLASSES];
+};
+
+static int Clamp(int grade) {
+    return grade < 0 ? 0 : grade > MaxGrade ? MaxGrade : grade;
+}
+
+static GradeCell *CellOf(GradeAggregates *aggregates, const Student *student, int course) {
+    return &aggregates->classes[student->grade - 1][student->class - 1]->courses[course];
+}
+
+static void CellAdd(GradeCell *cell, int grade) {
+    GradeTotals *totals = &cell->totals;
+    int clamped = Clamp(grade);
+    if (totals->count == 0 || clamped < totals->min) totals->min = clamped;
+    if (totals->count == 0 || clamped > totals->max) totals->max = clamped;
+    totals->count++;
+    totals->sum += grade;
+    totals->sumOfSquares += (long long)grade * grade;
+    cell->students[clamped]++;
+}
+
+static void CellRemove(GradeCell *cell, int grade) {
+    GradeTotals *totals = &cell->totals;
+    int clamped = Clamp(grade);
+    totals->count--;
+    totals->sum -= grade;
+    totals->sumOfSquares -= (long long)grade * grade;
+    cell->students[clamped]--;
+    if (totals->count == 0) return;
+
+    while (cell->students[totals->min] == 0) totals->min++;
+    while (cell->students[totals->max] == 0) totals->max--;
+}
+
+GradeAggregates *AggregatesCreate(void) {
+    GradeAggregates *aggregates = calloc(1, sizeof(GradeAggregates));
+    if (aggregates) MEMORY_ADD(MemoryAggregates, sizeof(GradeAggregates));
+    return aggregates;
+}
+
+void AggregatesFree(GradeAggregates *aggregates) {
+    if (!aggregates) return;
+    for (int grade = 0; grade < MAX_GRADES; grade++) {
+        for (int class = 0; class < MAX_CLASSES; class++) {
+            if (aggregates->classes[grade][class]) {
+                MEMORY_REMOVE(MemoryAggregates, sizeof(ClassCells));
+                free(aggregates->classes[grade][class]);
+            }
+        }
+    }
+    MEMORY_REMOVE(MemoryAggregates, sizeof(GradeAggregates));
+    free(aggregates);
+}
+
+int AggregatesReserve(GradeAggregates *aggregates, int grade, int class) {
+    if (!aggregates) return 0;
+    ClassCells **cells = &aggregates->classes[grade - 1][class - 1];
+    if (*cells) return 1;
+
+    *cells = calloc(1, sizeof(ClassCells));
+    if (!*cells) return 0;
+    MEMORY_ADD(MemoryAggregates, sizeof(ClassCells));
+    return 1;
+}
+
+void AggregatesAdd(GradeAggregates *aggregates, const Student *student) {
+    if (!aggregates) return;
+    for (int course = 0; course < SUBJECTS; course++) {
+        CellAdd(CellOf(aggregates, student, course), student->grades[course]);
+    }
+}
+
+void AggregatesRemove(GradeAggregates *aggregates, const Student *student) {
+    if (!aggregates) return;
+    for (int course = 0; course < SUBJECTS; course++) {
+        CellRemove(CellOf(aggregates, student, course), student->grades[course]);
+    }
+}
+
+void AggregatesChange(GradeAggregates *aggregates, const Student *student, int course, int oldGrade) {
+    if (!aggregates) return;
+    GradeCell *cell = CellOf(aggregates, student, course);
+    CellAdd(cell, student->grades[course]);
+    CellRemove(cell, oldGrade);
+}
+
+GradeTotals AggregatesQuery(const GradeAggregates *aggregates, int grade, int class, int course) {
+    GradeTotals result = {0};
+    if (!aggregates || grade < 0 || grade > MAX_GRADES || class < 0 || class > MAX_CLASSES ||
+        course < 0 || course >= SUBJECTS) {
+        return result;
+    }
+
+    int firstGrade = grade ? grade - 1 : 0, lastGrade = grade ? grade - 1 : MAX_GRADES - 1;
+    int firstClass = class ? class - 1 : 0, lastClass = class ? class - 1 : MAX_CLASSES - 1;
+    for (int g = firstGrade; g <= lastGrade; g++) {
+        for (int c = firstClass; c <= lastClass; c++) {
+            if (!aggregates->classes[g][c]) continue;
+            const GradeTotals *totals = &aggregates->classes[g][c]->courses[course].totals;
+            if (totals->count == 0) continue;
+            if (result.count == 0 || totals->min < result.min) result.min = totals->min;
+            if (result.count == 0 || totals->max > result.max) result.max = totals->max;
+            result.count += totals->count;
+            result.sum += totals->sum;
+            result.sumOfSquares += totals->sumOfSquares;
+        }
+    }
+    return result;
+}
+
+double AggregatesMean(const GradeTotals *totals) {
+    return totals->count ? (double)totals->sum / totals->count : 0;
+}
+
+double AggregatesVariance(const GradeTotals *totals) {
+    if (totals->count == 0) return 0;
+    // n * sum(x^2) - sum(x)^2 is exact in integers, only the final division rounds
+    long long spread = totals->count * totals->sumOfSquares - totals->sum * totals->sum;
+    return (double)spread / ((double)totals->count * totals->count);
+}
+
+double AggregatesStdDev(const GradeTotals *totals) {
+    return sqrt(AggregatesVariance(totals));
+}
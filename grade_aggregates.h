@@ -0,0 +1,40 @@
+#ifndef CHECKPOINT_GRADE_AGGREGATES_H
+#define CHECKPOINT_GRADE_AGGREGATES_H
+
+#include "student_management_system.h"
+
+// Running totals of the course grades per grade level, class and course, kept up
+// to date on every insert, delete and grade change. Unlike the heaps' overall_grade
+// they count every student exactly once, so averages don't drift.
+typedef struct GradeAggregates GradeAggregates;
+
+typedef struct {
+    long long sum;
+    long long sumOfSquares;
+    int count;
+    int min;    // only meaningful when count > 0
+    int max;
+} GradeTotals;
+
+GradeAggregates *AggregatesCreate(void);
+void AggregatesFree(GradeAggregates *aggregates);
+
+// Allocates the cells of grade level 1-12 and class 1-10 unless they exist, returns 0 when out
+// of memory. Has to succeed before a student of that class is added.
+int AggregatesReserve(GradeAggregates *aggregates, int grade, int class);
+
+// Counts all the course grades of a student that was inserted / is about to be deleted
+void AggregatesAdd(GradeAggregates *aggregates, const Student *student);
+void AggregatesRemove(GradeAggregates *aggregates, const Student *student);
+// The student's grade in course was oldGrade and is now student->grades[course]
+void AggregatesChange(GradeAggregates *aggregates, const Student *student, int course, int oldGrade);
+
+// Totals of course 0-9 over grade level 1-12 and class 1-10, 0 for either meaning all of them
+GradeTotals AggregatesQuery(const GradeAggregates *aggregates, int grade, int class, int course);
+
+// Population mean, variance and standard deviation, 0 for no students
+double AggregatesMean(const GradeTotals *totals);
+double AggregatesVariance(const GradeTotals *totals);
+double AggregatesStdDev(const GradeTotals *totals);
+
+#endif //CHECKPOINT_GRADE_AGGREGATES_H
@@ -0,0 +1,38 @@
+#include <stdlib.h>
+#include "student_management_system.h"
+#include "cJSON.h"
+#include "cJSON_Pool.h"
+#include "operation_stats.h"
+#include "memory_stats.h"
+#include "trace_events.h"
+
+int main() {
+    // Serve cJSON's nodes and short strings from the pool instead of malloc.
+    // Has to happen before anything is allocated through cJSON.
+    cJSON_Hooks hooks;
+    cJSONPool_GetHooks(&hooks);
+    // Count what cJSON allocates for the memory report, by the pool's own block sizes so the
+    // blocks stay in the size classes they'd have without the accounting
+    MemoryWrapJsonHooks(&hooks, cJSONPool_BlockSize);
+    cJSON_InitHooks(&hooks);
+
+    // CHECKPOINT_STATS_INTERVAL=N appends the statistics to CHECKPOINT_STATS_FILE
+    // (stats.log by default) every N seconds while operations are running
+    const char *interval = getenv("CHECKPOINT_STATS_INTERVAL");
+    if (interval) {
+        const char *path = getenv("CHECKPOINT_STATS_FILE");
+        StatsSetDumpInterval(atoi(interval), path ? path : "stats.log");
+    }
+
+    // CHECKPOINT_TRACE_FILE=trace.json records spans of the loading phases for chrome://tracing
+    // or ui.perfetto.dev, CHECKPOINT_TRACE_SAMPLE=N keeps every Nth roster line (1000 by default)
+    const char *tracePath = getenv("CHECKPOINT_TRACE_FILE");
+    if (tracePath) {
+        const char *sample = getenv("CHECKPOINT_TRACE_SAMPLE");
+        TraceStart(tracePath, sample ? atoi(sample) : 1000);
+    }
+
+    menu();
+    TraceStop();
+    return 0;
+}
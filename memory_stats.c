@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "memory_stats.h"
+
+#if CHECKPOINT_STATS
+
+// cJSON may allocate from the parallel parser's worker threads, so the counters are atomic
+#if defined(__STDC_NO_ATOMICS__)
+typedef size_t Counter;
+#define CounterAdd(counter, amount) ((void)(*(counter) += (amount)))
+#define CounterAddFetch(counter, amount) (*(counter) += (amount))
+#define CounterSub(counter, amount) (*(counter) -= (amount))
+#define CounterLoad(counter) (*(counter))
+#define CounterRaiseTo(counter, value) do { if (*(counter) < (value)) *(counter) = (value); } while (0)
+#else
+#include <stdatomic.h>
+typedef _Atomic size_t Counter;
+#define CounterAdd(counter, amount) ((void)atomic_fetch_add((counter), (amount)))
+// The counter's value after adding, for the peak
+#define CounterAddFetch(counter, amount) (atomic_fetch_add((counter), (amount)) + (amount))
+#define CounterSub(counter, amount) ((void)atomic_fetch_sub((counter), (amount)))
+#define CounterLoad(counter) atomic_load(counter)
+#define CounterRaiseTo(counter, value) do { \
+        size_t seen = atomic_load(counter); \
+        while (seen < (value) && !atomic_compare_exchange_weak((counter), &seen, (value))); \
+    } while (0)
+#endif
+
+typedef struct {
+    Counter bytes;
+    Counter objects;
+    Counter peakBytes;
+    Counter allocations;   // objects ever allocated
+} MemoryUsage;
+
+static const char *SubsystemNames[MemorySubsystemCount] = {
+    "students", "class arrays", "hash buckets", "school", "heap matrix", "name index", "aggregates", "cJSON"
+};
+
+static MemoryUsage Usage[MemorySubsystemCount];
+
+// Size header in front of every block handed to cJSON. It keeps the alignment cJSON needs
+// for its doubles and pointers, which is all the pool guarantees too.
+typedef union {
+    size_t size;
+    double number;
+    void *pointer;
+} JsonBlockHeader;
+
+static void *(*InnerMalloc)(size_t size);
+static void (*InnerFree)(void *pointer);
+static size_t (*InnerBlockSize)(const void *pointer);
+
+void MemoryAdd(MemorySubsystem subsystem, size_t bytes) {
+    MemoryUsage *usage = &Usage[subsystem];
+    size_t total = CounterAddFetch(&usage->bytes, bytes);
+    CounterAdd(&usage->objects, 1);
+    CounterAdd(&usage->allocations, 1);
+    CounterRaiseTo(&usage->peakBytes, total);
+}
+
+void MemoryRemove(MemorySubsystem subsystem, size_t bytes) {
+    MemoryUsage *usage = &Usage[subsystem];
+    CounterSub(&usage->bytes, bytes);
+    CounterSub(&usage->objects, 1);
+}
+
+void MemoryResize(MemorySubsystem subsystem, size_t oldBytes, size_t newBytes) {
+    if (oldBytes == newBytes) return;
+    if (oldBytes == 0) {
+        MemoryAdd(subsystem, newBytes);
+        return;
+    }
+    if (newBytes == 0) {
+        MemoryRemove(subsystem, oldBytes);
+        return;
+    }
+
+    MemoryUsage *usage = &Usage[subsystem];
+    if (newBytes >= oldBytes) {
+        size_t total = CounterAddFetch(&usage->bytes, newBytes - oldBytes);
+        CounterRaiseTo(&usage->peakBytes, total);
+    } else {
+        CounterSub(&usage->bytes, oldBytes - newBytes);
+    }
+}
+
+static void *CJSON_CDECL CountingMalloc(size_t size) {
+    if (size > (size_t)-1 - sizeof(JsonBlockHeader)) return NULL;
+
+    JsonBlockHeader *header = InnerMalloc(sizeof(JsonBlockHeader) + size);
+    if (!header) return NULL;
+    header->size = size;
+    MemoryAdd(MemoryJson, size);
+    return header + 1;
+}
+
+static void CJSON_CDECL CountingFree(void *pointer) {
+    if (!pointer) return;
+
+    JsonBlockHeader *header = (JsonBlockHeader *)pointer - 1;
+    MemoryRemove(MemoryJson, header->size);
+    InnerFree(header);
+}
+
+// With an allocator that knows its block sizes the blocks are passed through as requested
+static void *CJSON_CDECL SizedMalloc(size_t size) {
+    void *pointer = InnerMalloc(size);
+    if (pointer) MemoryAdd(MemoryJson, InnerBlockSize(pointer));
+    return pointer;
+}
+
+static void CJSON_CDECL SizedFree(void *pointer) {
+    if (!pointer) return;
+    MemoryRemove(MemoryJson, InnerBlockSize(pointer));
+    InnerFree(pointer);
+}
+
+void MemoryWrapJsonHooks(cJSON_Hooks *hooks, size_t (*blockSize)(const void *pointer)) {
+    InnerMalloc = hooks->malloc_fn ? hooks->malloc_fn : malloc;
+    InnerFree = hooks->free_fn ? hooks->free_fn : free;
+    InnerBlockSize = blockSize;
+    hooks->malloc_fn = blockSize ? SizedMalloc : CountingMalloc;
+    hooks->free_fn = blockSize ? SizedFree : CountingFree;
+}
+
+static void PrintBytes(FILE *out, size_t bytes) {
+    if (bytes >= (size_t)1 << 30) {
+        fprintf(out, " %10.2f GB", (double)bytes / (double)((size_t)1 << 30));
+    } else if (bytes >= (size_t)1 << 20) {
+        fprintf(out, " %10.2f MB", (double)bytes / (double)((size_t)1 << 20));
+    } else {
+        fprintf(out, " %10.2f KB", (double)bytes / 1024.0);
+    }
+}
+
+void MemoryPrint(FILE *out) {
+    size_t totalBytes = 0;
+
+    fprintf(out, "%-14s %13s %13s %12s %14s\n", "memory", "current", "peak", "objects", "allocations");
+    for (int subsystem = 0; subsystem < MemorySubsystemCount; subsystem++) {
+        MemoryUsage *usage = &Usage[subsystem];
+        size_t bytes = CounterLoad(&usage->bytes);
+        totalBytes += bytes;
+
+        fprintf(out, "%-14s", SubsystemNames[subsystem]);
+        PrintBytes(out, bytes);
+        PrintBytes(out, CounterLoad(&usage->peakBytes));
+        fprintf(out, " %12zu %14zu\n", (size_t)CounterLoad(&usage->objects), (size_t)CounterLoad(&usage->allocations));
+    }
+    fprintf(out, "%-14s", "total");
+    PrintBytes(out, totalBytes);
+    fprintf(out, "\n");
+
+    // What every student costs, to size hosts for bigger rosters
+    size_t students = CounterLoad(&Usage[MemoryStudents].objects);
+    if (students > 0) {
+        size_t perStudent = CounterLoad(&Usage[MemoryStudents].bytes) + CounterLoad(&Usage[MemoryClassArrays].bytes) +
+                            CounterLoad(&Usage[MemoryHashBuckets].bytes);
+        fprintf(out, "per student: %.1f bytes (record, class array slot and hash bucket, heaps are per course)\n",
+                (double)perStudent / (double)students);
+    }
+    fprintf(out, "sizes are requested bytes, allocator overhead is not included\n");
+}
+
+#else
+
+void MemoryAdd(MemorySubsystem subsystem, size_t bytes) {
+    (void)subsystem;
+    (void)bytes;
+}
+
+void MemoryRemove(MemorySubsystem subsystem, size_t bytes) {
+    (void)subsystem;
+    (void)bytes;
+}
+
+void MemoryResize(MemorySubsystem subsystem, size_t oldBytes, size_t newBytes) {
+    (void)subsystem;
+    (void)oldBytes;
+    (void)newBytes;
+}
+
+void MemoryWrapJsonHooks(cJSON_Hooks *hooks, size_t (*blockSize)(const void *pointer)) {
+    (void)hooks;
+    (void)blockSize;
+}
+
+void MemoryPrint(FILE *out) {
+    fprintf(out, "Memory accounting was compiled out (CHECKPOINT_STATS=0).\n");
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef CHECKPOINT_MEMORY_STATS_H
+#define CHECKPOINT_MEMORY_STATS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "cJSON.h"
+#include "operation_stats.h"
+
+// Byte and object counts per memory consumer, compiled out together with the
+// rest of the statistics when CHECKPOINT_STATS is 0
+typedef enum {
+    MemoryStudents,      // Student records
+    MemoryClassArrays,   // Class::students pointer arrays
+    MemoryHashBuckets,   // bucket array of each School's hash table
+    MemorySchool,        // School itself: class headers and heap pointers
+    MemoryHeaps,         // FixedSizeMaxHeap blocks of the heap matrix
+    MemoryNameIndex,     // trie nodes and student lists of each School's name index
+    MemoryAggregates,    // grade totals per grade level, class and course of each School
+    MemoryJson,          // everything allocated through cJSON: trees, stream buffers, printed text
+    MemorySubsystemCount
+} MemorySubsystem;
+
+#if CHECKPOINT_STATS
+#define MEMORY_ADD(subsystem, bytes) MemoryAdd(subsystem, bytes)
+#define MEMORY_REMOVE(subsystem, bytes) MemoryRemove(subsystem, bytes)
+#define MEMORY_RESIZE(subsystem, oldBytes, newBytes) MemoryResize(subsystem, oldBytes, newBytes)
+#else
+#define MEMORY_ADD(subsystem, bytes) ((void)0)
+#define MEMORY_REMOVE(subsystem, bytes) ((void)0)
+#define MEMORY_RESIZE(subsystem, oldBytes, newBytes) ((void)0)
+#endif
+
+// An object of bytes was allocated / freed / reallocated. A resize from or to 0 bytes
+// counts as allocating or freeing the object, for arrays that start out empty.
+void MemoryAdd(MemorySubsystem subsystem, size_t bytes);
+void MemoryRemove(MemorySubsystem subsystem, size_t bytes);
+void MemoryResize(MemorySubsystem subsystem, size_t oldBytes, size_t newBytes);
+
+// Wraps the hooks (as filled by cJSONPool_GetHooks, or malloc/free when hooks has none) so that
+// everything cJSON allocates is counted as MemoryJson. blockSize, like cJSONPool_BlockSize, tells
+// the size of an allocated block, so the blocks keep their requested size and are counted as
+// what the allocator really reserves. Without it each block carries a small size header instead.
+// Call it before cJSON_InitHooks and before anything is allocated through cJSON. Does nothing
+// when the statistics are compiled out.
+void MemoryWrapJsonHooks(cJSON_Hooks *hooks, size_t (*blockSize)(const void *pointer));
+
+// Current and peak bytes and objects per subsystem
+void MemoryPrint(FILE *out);
+
+#endif //CHECKPOINT_MEMORY_STATS_H
@@ -0,0 +1,392 @@
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "name_index.h"
+#include "memory_stats.h"
+
+// Longest query or name the index compares, names are shorter than MAX_NAME anyway
+#define MaxWord 64
+
+// Nodes live in one array and point at each other by index, so growing the
+// array never invalidates a link. Children are a sibling list in letter order.
+typedef struct {
+    int firstChild;   // -1 when there is none
+    int nextSibling;  // -1 when there is none
+    int posting;      // students whose name ends here, -1 when no name does
+    char letter;
+} NameNode;
+
+typedef struct {
+    Student **students;
+    int count;
+    int capacity;
+} NamePosting;
+
+struct NameIndex {
+    NameNode *nodes;        // nodes[0] is the root, the empty name
+    int nodeCount;
+    int nodeCapacity;
+    NamePosting *postings;
+    int postingCount;
+    int postingCapacity;
+};
+
+static char Fold(char c) {
+    return (char)tolower((unsigned char)c);
+}
+
+static int SameName(const char *a, const char *b) {
+    while (*a && Fold(*a) == Fold(*b)) {
+        a++;
+        b++;
+    }
+    return Fold(*a) == Fold(*b);
+}
+
+// Lower cased copy of word cut to MaxWord - 1 letters, returns its length
+static int FoldWord(const char *word, char folded[MaxWord]) {
+    int length = 0;
+    while (word[length] && length < MaxWord - 1) {
+        folded[length] = Fold(word[length]);
+        length++;
+    }
+    folded[length] = '\0';
+    return length;
+}
+
+static int NewNode(NameIndex *index, char letter) {
+    if (index->nodeCount == index->nodeCapacity) {
+        int capacity = index->nodeCapacity ? index->nodeCapacity * 2 : 64;
+        NameNode *nodes = realloc(index->nodes, capacity * sizeof(NameNode));
+        if (!nodes) return -1;
+        MEMORY_RESIZE(MemoryNameIndex, index->nodeCapacity * sizeof(NameNode), capacity * sizeof(NameNode));
+        index->nodes = nodes;
+        index->nodeCapacity = capacity;
+    }
+
+    NameNode *node = &index->nodes[index->nodeCount];
+    node->firstChild = -1;
+    node->nextSibling = -1;
+    node->posting = -1;
+    node->letter = letter;
+    return index->nodeCount++;
+}
+
+static int FindChild(const NameIndex *index, int parent, char letter) {
+    int child = index->nodes[parent].firstChild;
+    while (child != -1 && index->nodes[child].letter < letter) {
+        child = index->nodes[child].nextSibling;
+    }
+    return child != -1 && index->nodes[child].letter == letter ? child : -1;
+}
+
+// The child of parent for letter, created in its place in the sibling list if needed
+static int FindOrAddChild(NameIndex *index, int parent, char letter) {
+    int previous = -1;
+    int child = index->nodes[parent].firstChild;
+    while (child != -1 && index->nodes[child].letter < letter) {
+        previous = child;
+        child = index->nodes[child].nextSibling;
+    }
+    if (child != -1 && index->nodes[child].letter == letter) return child;
+
+    int added = NewNode(index, letter);
+    if (added == -1) return -1;
+    index->nodes[added].nextSibling = child;
+    if (previous == -1)
+        index->nodes[parent].firstChild = added;
+    else
+        index->nodes[previous].nextSibling = added;
+    return added;
+}
+
+static int NewPosting(NameIndex *index) {
+    if (index->postingCount == index->postingCapacity) {
+        int capacity = index->postingCapacity ? index->postingCapacity * 2 : 16;
+        NamePosting *postings = realloc(index->postings, capacity * sizeof(NamePosting));
+        if (!postings) return -1;
+        MEMORY_RESIZE(MemoryNameIndex, index->postingCapacity * sizeof(NamePosting), capacity * sizeof(NamePosting));
+        index->postings = postings;
+        index->postingCapacity = capacity;
+    }
+
+    NamePosting *posting = &index->postings[index->postingCount];
+    posting->students = NULL;
+    posting->count = 0;
+    posting->capacity = 0;
+    return index->postingCount++;
+}
+
+static int AddName(NameIndex *index, const char *name, Student *student) {
+    int node = 0;
+    for (; *name; name++) {
+        node = FindOrAddChild(index, node, Fold(*name));
+        if (node == -1) return 0;
+    }
+    if (node == 0) return 1;   // empty names aren't searchable
+
+    if (index->nodes[node].posting == -1) {
+        int posting = NewPosting(index);
+        if (posting == -1) return 0;
+        index->nodes[node].posting = posting;
+    }
+
+    NamePosting *posting = &index->postings[index->nodes[node].posting];
+    if (posting->count == posting->capacity) {
+        int capacity = posting->capacity ? posting->capacity * 2 : 2;
+        Student **students = realloc(posting->students, capacity * sizeof(Student *));
+        if (!students) return 0;
+        MEMORY_RESIZE(MemoryNameIndex, posting->capacity * sizeof(Student *), capacity * sizeof(Student *));
+        posting->students = students;
+        posting->capacity = capacity;
+    }
+    posting->students[posting->count++] = student;
+    return 1;
+}
+
+// Nodes stay when their last student goes, a name that was used once tends to come back
+static void RemoveName(NameIndex *index, const char *name, const Student *student) {
+    int node = 0;
+    for (; *name && node != -1; name++) {
+        node = FindChild(index, node, Fold(*name));
+    }
+    if (node <= 0 || index->nodes[node].posting == -1) return;
+
+    NamePosting *posting = &index->postings[index->nodes[node].posting];
+    for (int i = 0; i < posting->count; i++) {
+        if (posting->students[i] == student) {
+            posting->students[i] = posting->students[--posting->count];
+            return;
+        }
+    }
+}
+
+NameIndex *NameIndexCreate(void) {
+    NameIndex *index = calloc(1, sizeof(NameIndex));
+    if (!index) return NULL;
+    MEMORY_ADD(MemoryNameIndex, sizeof(NameIndex));
+
+    if (NewNode(index, '\0') == -1) {
+        NameIndexFree(index);
+        return NULL;
+    }
+    return index;
+}
+
+void NameIndexFree(NameIndex *index) {
+    if (!index) return;
+
+    for (int i = 0; i < index->postingCount; i++) {
+        MEMORY_RESIZE(MemoryNameIndex, index->postings[i].capacity * sizeof(Student *), 0);
+        free(index->postings[i].students);
+    }
+    MEMORY_RESIZE(MemoryNameIndex, index->postingCapacity * sizeof(NamePosting), 0);
+    free(index->postings);
+    MEMORY_RESIZE(MemoryNameIndex, index->nodeCapacity * sizeof(NameNode), 0);
+    free(index->nodes);
+    MEMORY_REMOVE(MemoryNameIndex, sizeof(NameIndex));
+    free(index);
+}
+
+int NameIndexAdd(NameIndex *index, Student *student) {
+    if (!index || !student) return 0;
+    if (!AddName(index, student->first_name, student)) return 0;
+    // "Levi Levi" is listed once, or every search for Levi would return the student twice
+    if (SameName(student->first_name, student->last_name)) return 1;
+    if (!AddName(index, student->last_name, student)) {
+        RemoveName(index, student->first_name, student);
+        return 0;
+    }
+    return 1;
+}
+
+void NameIndexRemove(NameIndex *index, Student *student) {
+    if (!index || !student) return;
+    RemoveName(index, student->first_name, student);
+    if (!SameName(student->first_name, student->last_name))
+        RemoveName(index, student->last_name, student);
+}
+
+// Matches collected by one search, sorted by distance and at most max long.
+// Without matches it only counts students, up to max.
+typedef struct {
+    NameMatch *matches;
+    int count;
+    int max;
+    NameScore score;
+    const void *context;
+} MatchList;
+
+// A student found through both names keeps its better distance
+static void AddMatch(MatchList *list, Student *student, int distance) {
+    // Nothing at or past the worst kept distance can get in, checked first as most candidates end here
+    if (list->count == list->max && list->matches[list->max - 1].distance <= distance) return;
+
+    if (list->score) {
+        distance = list->score(student, list->context);
+        if (distance < 0) return;
+        if (list->count == list->max && list->matches[list->max - 1].distance <= distance) return;
+    }
+
+    for (int i = 0; i < list->count; i++) {
+        if (list->matches[i].student != student) continue;
+        if (list->matches[i].distance <= distance) return;
+        // Found closer, take it out and insert it again below
+        memmove(&list->matches[i], &list->matches[i + 1], (list->count - i - 1) * sizeof(NameMatch));
+        list->count--;
+        break;
+    }
+
+    int at = list->count;
+    while (at > 0 && list->matches[at - 1].distance > distance) at--;
+
+    int moved = list->count < list->max ? list->count - at : list->max - at - 1;
+    memmove(&list->matches[at + 1], &list->matches[at], moved * sizeof(NameMatch));
+    list->matches[at].student = student;
+    list->matches[at].distance = distance;
+    if (list->count < list->max) list->count++;
+}
+
+static void AddPosting(const NameIndex *index, int node, int distance, MatchList *list) {
+    int posting = index->nodes[node].posting;
+    if (posting == -1) return;
+    if (!list->matches) {
+        list->count += index->postings[posting].count;
+        return;
+    }
+    for (int i = 0; i < index->postings[posting].count; i++) {
+        AddMatch(list, index->postings[posting].students[i], distance);
+    }
+}
+
+// Whether nothing that is still to come could change the list: it is full of
+// exact matches, or when counting, the count reached its limit
+static int ListDone(const MatchList *list) {
+    if (list->count < list->max) return 0;
+    return !list->matches || list->matches[list->max - 1].distance == 0;
+}
+
+static void CollectPrefix(const NameIndex *index, int node, MatchList *list) {
+    AddPosting(index, node, 0, list);
+    for (int child = index->nodes[node].firstChild; child != -1; child = index->nodes[child].nextSibling) {
+        if (ListDone(list)) return;
+        CollectPrefix(index, child, list);
+    }
+}
+
+// Node a prefix leads to, -1 when no name starts with it
+static int FindPrefix(const NameIndex *index, const char *prefix) {
+    int node = 0;
+    for (; *prefix && node != -1; prefix++) {
+        node = FindChild(index, node, Fold(*prefix));
+    }
+    return node;
+}
+
+int NameIndexPrefix(const NameIndex *index, const char *prefix, NameScore score, const void *context,
+                    NameMatch *matches, int max) {
+    if (!index || !prefix || max <= 0) return 0;
+
+    int node = FindPrefix(index, prefix);
+    if (node == -1) return 0;
+
+    MatchList list = {matches, 0, max, score, context};
+    CollectPrefix(index, node, &list);
+    return list.count;
+}
+
+// Levenshtein distance computed one trie level at a time: previous is the row of
+// the parent's name against the word, each child adds one row. A branch ends
+// as soon as every entry of its row is over maxEdits.
+static void FuzzyWalk(const NameIndex *index, int node, const char *word, int length, const int *previous,
+                      int maxEdits, MatchList *list) {
+    int row[MaxWord];
+    for (int child = index->nodes[node].firstChild; child != -1; child = index->nodes[child].nextSibling) {
+        if (!list->matches && list->count >= list->max) return;
+        char letter = index->nodes[child].letter;
+        row[0] = previous[0] + 1;
+        int smallest = row[0];
+        for (int j = 1; j <= length; j++) {
+            int best = previous[j - 1] + (word[j - 1] != letter);
+            if (previous[j] + 1 < best) best = previous[j] + 1;
+            if (row[j - 1] + 1 < best) best = row[j - 1] + 1;
+            row[j] = best;
+            if (best < smallest) smallest = best;
+        }
+
+        if (row[length] <= maxEdits)
+            AddPosting(index, child, row[length], list);
+        if (smallest <= maxEdits)
+            FuzzyWalk(index, child, word, length, row, maxEdits, list);
+    }
+}
+
+int NameIndexFuzzy(const NameIndex *index, const char *word, int maxEdits, NameScore score, const void *context,
+                   NameMatch *matches, int max) {
+    if (!index || !word || max <= 0 || maxEdits < 0) return 0;
+
+    char folded[MaxWord];
+    int length = FoldWord(word, folded);
+    int row[MaxWord];
+    for (int j = 0; j <= length; j++) {
+        row[j] = j;
+    }
+
+    MatchList list = {matches, 0, max, score, context};
+    FuzzyWalk(index, 0, folded, length, row, maxEdits, &list);
+    return list.count;
+}
+
+int NameIndexCount(const NameIndex *index, const char *word, int maxEdits, int limit) {
+    if (!index || !word || limit <= 0) return 0;
+
+    MatchList list = {NULL, 0, limit, NULL, NULL};
+    int node = FindPrefix(index, word);
+    if (node != -1) CollectPrefix(index, node, &list);
+
+    char folded[MaxWord];
+    int length = FoldWord(word, folded);
+    int row[MaxWord];
+    for (int j = 0; j <= length; j++) {
+        row[j] = j;
+    }
+    if (list.count < limit && maxEdits >= 0)
+        FuzzyWalk(index, 0, folded, length, row, maxEdits, &list);
+    return list.count < limit ? list.count : limit;
+}
+
+int NameIndexDistance(const char *name, const char *query, int maxEdits) {
+    int m = 0;
+    while (query[m] && Fold(name[m]) == Fold(query[m])) m++;
+    if (!query[m]) return 0;
+
+    // Most names are ruled out by their length alone
+    int n = (int)strlen(name);
+    m += (int)strlen(query + m);
+    if (n >= MaxWord || m >= MaxWord || n - m > maxEdits || m - n > maxEdits) return -1;
+
+    int rows[2][MaxWord];
+    int *previous = rows[0], *row = rows[1];
+    for (int j = 0; j <= m; j++) {
+        previous[j] = j;
+    }
+    for (int i = 1; i <= n; i++) {
+        char letter = Fold(name[i - 1]);
+        row[0] = i;
+        int smallest = row[0];
+        for (int j = 1; j <= m; j++) {
+            int best = previous[j - 1] + (letter != Fold(query[j - 1]));
+            if (previous[j] + 1 < best) best = previous[j] + 1;
+            if (row[j - 1] + 1 < best) best = row[j - 1] + 1;
+            row[j] = best;
+            if (best < smallest) smallest = best;
+        }
+        // Rows never get smaller, so most names are ruled out after a few letters
+        if (smallest > maxEdits) return -1;
+
+        int *swap = previous;
+        previous = row;
+        row = swap;
+    }
+    return previous[m] <= maxEdits ? previous[m] : -1;
+}
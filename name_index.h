@@ -0,0 +1,46 @@
+#ifndef CHECKPOINT_NAME_INDEX_H
+#define CHECKPOINT_NAME_INDEX_H
+
+#include "student_management_system.h"
+
+// Trie over the lower cased first and last names of a school's students, for
+// prefix autocomplete and typo tolerant lookups. Every node that ends a name
+// keeps the students carrying that name, so a match costs a walk over the
+// query's letters instead of a scan of the roster.
+typedef struct NameIndex NameIndex;
+
+typedef struct {
+    Student *student;
+    int distance;   // edits between the query and the name, 0 for prefix matches
+} NameMatch;
+
+// Optional check a matching student has to pass, returning the distance to rank
+// it by instead of the index's, or -1 to leave it out. Used to match a first and
+// a last name together.
+typedef int (*NameScore)(const Student *student, const void *context);
+
+NameIndex *NameIndexCreate(void);
+void NameIndexFree(NameIndex *index);
+
+// Indexes the student under its first and its last name. Returns 0 when out of memory.
+int NameIndexAdd(NameIndex *index, Student *student);
+void NameIndexRemove(NameIndex *index, Student *student);
+
+// Students with a first or last name starting with prefix, in alphabetical
+// order of the names. Returns how many of max were written.
+int NameIndexPrefix(const NameIndex *index, const char *prefix, NameScore score, const void *context,
+                    NameMatch *matches, int max);
+
+// Students with a first or last name at most maxEdits insertions, deletions or
+// substitutions away from word, closest first
+int NameIndexFuzzy(const NameIndex *index, const char *word, int maxEdits, NameScore score, const void *context,
+                   NameMatch *matches, int max);
+
+// How many students a prefix plus fuzzy search for word would look at, without
+// reading any of them. Counting stops at limit. Picks the cheaper word of a query.
+int NameIndexCount(const NameIndex *index, const char *word, int maxEdits, int limit);
+
+// How far name is from query, 0 when query is a prefix of it, -1 when it is more than maxEdits away
+int NameIndexDistance(const char *name, const char *query, int maxEdits);
+
+#endif //CHECKPOINT_NAME_INDEX_H
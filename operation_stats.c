@@ -0,0 +1,237 @@
+// clock_gettime and CLOCK_MONOTONIC are POSIX, not ISO C
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include "operation_stats.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// The clock is also used for tracing, so it stays when the statistics are compiled out
+uint64_t StatsNow(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+#endif
+}
+
+#if CHECKPOINT_STATS
+
+// Log-linear buckets like an HDR histogram: values below 32 ns get a bucket each,
+// above that every power of two is split into 16 buckets, so a bucket is never
+// wider than about 6% of its value, whatever the range.
+#define SubBucketBits 4
+#define SubBuckets (1 << SubBucketBits)
+#define BucketCount ((64 - SubBucketBits + 1) * SubBuckets)
+
+typedef struct {
+    uint64_t count;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    uint64_t buckets[BucketCount];
+} LatencyHistogram;
+
+static const char *OperationNames[StatOperationCount] = {
+    "find", "find_by_phone", "search_students", "insert_student", "insert_students", "rank_students",
+    "apply_grade_updates", "insert", "insertMany", "update", "updateMany", "Delete",
+    "SaveHeapMatrixToJson", "LoadHeapMatrixFromJson", "read_data_from_file"
+};
+
+static const char *CounterNames[StatCounterCount] = {
+    "find probes", "phone probes", "SiftUp calls", "SiftUp swaps", "SiftDown calls", "SiftDown swaps"
+};
+
+static LatencyHistogram Histograms[StatOperationCount];
+static uint64_t Counters[StatCounterCount];
+static const HashTable *WatchedTable;
+
+static uint64_t DumpInterval;   // nanoseconds, 0 when the periodic dump is off
+static uint64_t NextDump;
+static char DumpPath[256];
+
+static int HighestBit(uint64_t value) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1) bit++;
+    return bit;
+#endif
+}
+
+static int BucketOf(uint64_t value) {
+    if (value < 2 * SubBuckets) return (int)value;
+    int shift = HighestBit(value) - SubBucketBits;
+    return (shift + 1) * SubBuckets + (int)((value >> shift) & (SubBuckets - 1));
+}
+
+// Largest value that falls into bucket
+static uint64_t BucketLimit(int bucket) {
+    if (bucket < 2 * SubBuckets) return (uint64_t)bucket;
+    int shift = bucket / SubBuckets - 1;
+    uint64_t low = (uint64_t)(SubBuckets + bucket % SubBuckets) << shift;
+    return low + ((uint64_t)1 << shift) - 1;
+}
+
+static uint64_t Percentile(const LatencyHistogram *histogram, double percent) {
+    uint64_t rank = (uint64_t)((double)histogram->count * percent / 100.0 + 0.5);
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BucketCount; bucket++) {
+        seen += histogram->buckets[bucket];
+        if (seen >= rank) {
+            uint64_t limit = BucketLimit(bucket);
+            return limit < histogram->max ? limit : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+static void DumpIfDue(void) {
+    uint64_t now = StatsNow();
+    if (now < NextDump) return;
+    NextDump = now + DumpInterval;
+
+    FILE *file = fopen(DumpPath, "a");
+    if (!file) return;
+    StatsPrint(file);
+    fclose(file);
+}
+
+void StatsRecord(StatOperation operation, uint64_t nanoseconds) {
+    LatencyHistogram *histogram = &Histograms[operation];
+    if (histogram->count == 0 || nanoseconds < histogram->min) histogram->min = nanoseconds;
+    if (nanoseconds > histogram->max) histogram->max = nanoseconds;
+    histogram->count++;
+    histogram->total += nanoseconds;
+    histogram->buckets[BucketOf(nanoseconds)]++;
+
+    if (DumpInterval != 0) DumpIfDue();
+}
+
+void StatsCount(StatCounter counter, uint64_t amount) {
+    Counters[counter] += amount;
+}
+
+void StatsWatchHashTable(const HashTable *table) {
+    WatchedTable = table;
+}
+
+void StatsSetDumpInterval(int seconds, const char *path) {
+    if (seconds <= 0 || !path) {
+        DumpInterval = 0;
+        return;
+    }
+    snprintf(DumpPath, sizeof(DumpPath), "%s", path);
+    DumpInterval = (uint64_t)seconds * 1000000000u;
+    NextDump = StatsNow() + DumpInterval;
+}
+
+static void PrintHashTable(FILE *out, const HashTable *table) {
+    // Chains of length 0, 1, 2, 3-4, 5-8, ... 257+
+    static const char *ranges[] = {"0", "1", "2", "3-4", "5-8", "9-16", "17-32", "33-64", "65-128", "129-256", "257+"};
+    uint64_t lengths[11] = {0};
+    uint64_t students = 0, used = 0, longest = 0, squares = 0;
+
+    for (int i = 0; i < table->bucket_count; i++) {
+        uint64_t length = 0;
+        for (const Student *current = table->buckets[i]; current; current = (const Student *)current->next) {
+            length++;
+        }
+        students += length;
+        squares += length * length;
+        if (length > 0) used++;
+        if (length > longest) longest = length;
+
+        int range = 0;
+        if (length > 0) {
+            range = 1;
+            while (range < 10 && length > ((uint64_t)1 << (range - 1))) range++;
+        }
+        lengths[range]++;
+    }
+
+    fprintf(out, "hash table: %llu students in %llu of %d buckets, longest chain %llu\n",
+            (unsigned long long)students, (unsigned long long)used, table->bucket_count, (unsigned long long)longest);
+    if (students > 0) {
+        // A successful find walks half of the chain it lands in on average, and
+        // a student lands in a chain of length L with probability L / students
+        fprintf(out, "  mean chain %.2f (used buckets), expected probes per hit %.2f\n",
+                (double)students / (double)used, ((double)squares / (double)students + 1) / 2);
+    }
+    for (int range = 0; range < 11; range++) {
+        if (lengths[range] > 0) {
+            fprintf(out, "  chains of length %-8s %llu\n", ranges[range], (unsigned long long)lengths[range]);
+        }
+    }
+}
+
+void StatsPrint(FILE *out) {
+    fprintf(out, "%-24s %10s %10s %10s %10s %10s %10s %10s\n",
+            "operation (us)", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+    for (int operation = 0; operation < StatOperationCount; operation++) {
+        const LatencyHistogram *histogram = &Histograms[operation];
+        if (histogram->count == 0) continue;
+        fprintf(out, "%-24s %10llu %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+                OperationNames[operation], (unsigned long long)histogram->count,
+                (double)histogram->total / (double)histogram->count / 1000.0,
+                (double)Percentile(histogram, 50) / 1000.0, (double)Percentile(histogram, 90) / 1000.0,
+                (double)Percentile(histogram, 99) / 1000.0, (double)Percentile(histogram, 99.9) / 1000.0,
+                (double)histogram->max / 1000.0);
+    }
+
+    for (int counter = 0; counter < StatCounterCount; counter++) {
+        fprintf(out, "%-24s %10llu\n", CounterNames[counter], (unsigned long long)Counters[counter]);
+    }
+
+    if (WatchedTable) PrintHashTable(out, WatchedTable);
+}
+
+void StatsReset(void) {
+    memset(Histograms, 0, sizeof(Histograms));
+    memset(Counters, 0, sizeof(Counters));
+}
+
+#else
+
+void StatsRecord(StatOperation operation, uint64_t nanoseconds) {
+    (void)operation;
+    (void)nanoseconds;
+}
+
+void StatsCount(StatCounter counter, uint64_t amount) {
+    (void)counter;
+    (void)amount;
+}
+
+void StatsWatchHashTable(const HashTable *table) {
+    (void)table;
+}
+
+void StatsSetDumpInterval(int seconds, const char *path) {
+    (void)seconds;
+    (void)path;
+}
+
+void StatsPrint(FILE *out) {
+    fprintf(out, "Statistics were compiled out (CHECKPOINT_STATS=0).\n");
+}
+
+void StatsReset(void) {
+}
+
+#endif
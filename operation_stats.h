@@ -0,0 +1,69 @@
+#ifndef CHECKPOINT_OPERATION_STATS_H
+#define CHECKPOINT_OPERATION_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "student_management_system.h"
+
+// Set CHECKPOINT_STATS to 0 to compile the instrumentation out entirely,
+// the macros below then expand to nothing and nothing is timed or counted.
+#ifndef CHECKPOINT_STATS
+#define CHECKPOINT_STATS 1
+#endif
+
+// Operations with a latency histogram
+typedef enum {
+    StatFind,
+    StatFindByPhone,
+    StatSearchNames,
+    StatInsertStudent,
+    StatInsertStudents,
+    StatRankStudents,
+    StatApplyGradeUpdates,
+    StatHeapInsert,
+    StatHeapInsertMany,
+    StatHeapUpdate,
+    StatHeapUpdateMany,
+    StatHeapDelete,
+    StatSaveHeapMatrix,
+    StatLoadHeapMatrix,
+    StatReadDataFile,
+    StatOperationCount
+} StatOperation;
+
+// Plain event counters
+typedef enum {
+    StatFindProbes,      // students compared while walking hash chains in find
+    StatPhoneProbes,     // students compared while walking phone index chains in find_by_phone
+    StatSiftUpCalls,
+    StatSiftUpSwaps,
+    StatSiftDownCalls,
+    StatSiftDownSwaps,
+    StatCounterCount
+} StatCounter;
+
+#if CHECKPOINT_STATS
+#define STATS_START(name) uint64_t name = StatsNow()
+#define STATS_STOP(operation, name) StatsRecord(operation, StatsNow() - (name))
+#define STATS_COUNT(counter, amount) StatsCount(counter, amount)
+#else
+#define STATS_START(name)
+#define STATS_STOP(operation, name) ((void)0)
+#define STATS_COUNT(counter, amount) ((void)0)
+#endif
+
+// Monotonic clock in nanoseconds, available even with CHECKPOINT_STATS=0
+uint64_t StatsNow(void);
+void StatsRecord(StatOperation operation, uint64_t nanoseconds);
+void StatsCount(StatCounter counter, uint64_t amount);
+
+// The hash table whose chain lengths are reported, NULL to stop reporting it
+void StatsWatchHashTable(const HashTable *table);
+// Writes the statistics to path (appending) at most every seconds, checked whenever an operation is recorded.
+// seconds <= 0 turns the dump off.
+void StatsSetDumpInterval(int seconds, const char *path);
+// Counts, latency percentiles, counters and hash chain lengths
+void StatsPrint(FILE *out);
+void StatsReset(void);
+
+#endif //CHECKPOINT_OPERATION_STATS_H
@@ -4,48 +4,65 @@
 #include <ctype.h>
 #include "student_management_system.h"
 #include "FixedSizeHeap.h"
+#include "operation_stats.h"
+#include "memory_stats.h"
+#include "trace_events.h"
+#include "name_index.h"
+#include "grade_aggregates.h"
 
 
-int loaded = 0;
-void setup(const char *matrix_filename) {
+void setup(School* school, const char *matrix_filename) {
+    TRACE_BEGIN(setupSpan);
     // Try to open the matrix file
+    TRACE_BEGIN(existsSpan);
     FILE *file = fopen(matrix_filename, "r");
+    TRACE_END(existsSpan, "file_exists");
     if (file) {
         // File exists, close it and load the matrix
         fclose(file);
 
         // Free previously allocated memory if any
-        FreeHeapMatrix();
+        FreeHeapMatrix(school->heaps);
 
         // Load the matrix from the JSON file
         printf("Loading heap matrix from file: %s\n", matrix_filename);
-        LoadHeapMatrixFromJson(matrix_filename);
-
-        // Check if the matrix is loaded correctly
-        int loaded_successfully = 0;
-        for (int grade = 0; grade < 12; grade++) {
-            for (int course = 0; course < 10; course++) {
-                if (heapMatrix[grade][course] == NULL) {
-                    loaded_successfully = 1;
+        TRACE_BEGIN(loadSpan);
+        int loaded = LoadHeapMatrixFromJson(school->heaps, matrix_filename);
+        TRACE_END(loadSpan, "LoadHeapMatrixFromJson");
+        if (!loaded) {
+            // The heaps are ranked from the roster again, and the save afterwards
+            // only writes the matrix when there's no file in the way
+            printf("Heap matrix file is damaged, rebuilding it from the roster.\n");
+            remove(matrix_filename);
+            school->heaps_loaded = 0;
+            TRACE_END(setupSpan, "setup");
+            return;
+        }
+
+        // Heaps are only saved for grades and courses that had students,
+        // so the matrix counts as loaded when the file held any heap at all
+        int heap_count = 0;
+        for (int grade = 0; grade < MAX_GRADES; grade++) {
+            for (int course = 0; course < SUBJECTS; course++) {
+                if (school->heaps[grade][course] != NULL) {
+                    heap_count++;
                 }
             }
         }
 
-        if (loaded_successfully == 0) {
-            loaded = 1;
+        if (heap_count > 0) {
+            school->heaps_loaded = 1;
             printf("Heap matrix loaded successfully.\n");
         } else {
-            printf("Heap matrix loading failed. Some heaps are missing.\n");
-            loaded = 0;
+            printf("Heap matrix loading failed. No heaps were found.\n");
+            school->heaps_loaded = 0;
         }
     } else {
-        // File doesn't exist, create a new heap matrix
+        // File doesn't exist, heaps are created as students are added
         printf("No matrix file found. Creating new heap matrix.\n");
-
-        // Initialize a new heap matrix
-        CreateHeapMatrix();
-        loaded = 0;
+        school->heaps_loaded = 0;
     }
+    TRACE_END(setupSpan, "setup");
 }
 
 
@@ -61,49 +78,305 @@ unsigned long hash(const char* first_name, const char* last_name) {
     while ((c = *last_name++))
         hash = ((hash << 5) + hash) + tolower(c);
 
-    return hash % HASH_SIZE;
+    return hash;
 }
 
-void insert_student(School* school, Student* student) {
-    if (!school || !student) return;
+// Bucket counts are powers of two, so the low bits of the hash pick the bucket
+static unsigned long bucket_index(const HashTable* table, const char* first_name, const char* last_name) {
+    return hash(first_name, last_name) & (unsigned long)(table->bucket_count - 1);
+}
 
-    int grade_index = student->grade - 1;
-    int class_index = student->class - 1;
+// Buckets for needed students: the current count doubled as often as it takes
+static int buckets_for(const HashTable* table, int needed) {
+    int count = table->bucket_count ? table->bucket_count : HASH_INITIAL_SIZE;
+    while (count < needed) count *= 2;
+    return count;
+}
 
-    if (grade_index < 0 || grade_index >= MAX_GRADES || class_index < 0 || class_index >= MAX_CLASSES) {
-        printf("Invalid grade or class for student %s %s\n", student->first_name, student->last_name);
-        return;
+// Grows the bucket array (or allocates the first one) to hold needed students
+// and moves every student to its new chain
+static int grow_hash_table(HashTable* table, int needed) {
+    int new_count = buckets_for(table, needed);
+    if (new_count == table->bucket_count) return 1;
+    Student** new_buckets = calloc(new_count, sizeof(Student*));
+    if (!new_buckets) return 0;
+    MEMORY_RESIZE(MemoryHashBuckets, table->bucket_count * sizeof(Student*), new_count * sizeof(Student*));
+
+    Student** old_buckets = table->buckets;
+    int old_count = table->bucket_count;
+    table->buckets = new_buckets;
+    table->bucket_count = new_count;
+
+    for (int i = 0; i < old_count; i++) {
+        Student* current = old_buckets[i];
+        while (current) {
+            Student* next = current->next;
+            unsigned long index = bucket_index(table, current->first_name, current->last_name);
+            current->next = table->buckets[index];
+            table->buckets[index] = current;
+            current = next;
+        }
     }
+    free(old_buckets);
+    return 1;
+}
 
-    Class* class = &school->grades[grade_index].classes[class_index];
+unsigned long long pack_phone(const char* phone) {
+    // Every digit goes into a nibble as digit + 1, so leading zeros count and
+    // 0 is left for "no digits". Punctuation and spaces are skipped; a phone
+    // has at most 14 digits, which fits in 56 bits.
+    unsigned long long key = 0;
+    for (; *phone; phone++) {
+        if (*phone >= '0' && *phone <= '9')
+            key = (key << 4) | (unsigned long long)(*phone - '0' + 1);
+    }
+    return key;
+}
 
-    // Check if we need to resize the students array
-    if (class->num_students >= class->capacity) {
-        int new_capacity = class->capacity * 2;
-        Student** new_students = realloc(class->students, new_capacity * sizeof(Student*));
-        if (!new_students) {
-            printf("Failed to allocate memory for new student\n");
-            return;
+// Keys differ mostly in their last digits, the multiply spreads them over every bucket
+static unsigned long phone_bucket_index(const HashTable* table, unsigned long long key) {
+    return (unsigned long)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (unsigned long)(table->bucket_count - 1);
+}
+
+static int grow_phone_index(HashTable* table, int needed) {
+    int new_count = buckets_for(table, needed);
+    if (new_count == table->bucket_count) return 1;
+    Student** new_buckets = calloc(new_count, sizeof(Student*));
+    if (!new_buckets) return 0;
+    MEMORY_RESIZE(MemoryHashBuckets, table->bucket_count * sizeof(Student*), new_count * sizeof(Student*));
+
+    Student** old_buckets = table->buckets;
+    int old_count = table->bucket_count;
+    table->buckets = new_buckets;
+    table->bucket_count = new_count;
+
+    for (int i = 0; i < old_count; i++) {
+        Student* current = old_buckets[i];
+        while (current) {
+            Student* next = current->next_by_phone;
+            unsigned long index = phone_bucket_index(table, current->phone_key);
+            current->next_by_phone = table->buckets[index];
+            table->buckets[index] = current;
+            current = next;
         }
-        class->students = new_students;
-        class->capacity = new_capacity;
     }
+    free(old_buckets);
+    return 1;
+}
+
+// Makes room for needed phones, like grow_hash_table it only reallocates when the buckets run out
+static int reserve_phone_index(HashTable* table, int needed) {
+    return needed <= table->bucket_count || grow_phone_index(table, needed);
+}
+
+// Students without digits in their phone stay out of the index. The index must already have
+// room, see reserve_phone_index, so a student is never left out for lack of memory.
+static void index_phone(HashTable* table, Student* student) {
+    student->phone_key = pack_phone(student->phone);
+    student->next_by_phone = NULL;
+    if (student->phone_key == 0) return;
+
+    unsigned long index = phone_bucket_index(table, student->phone_key);
+    student->next_by_phone = table->buckets[index];
+    table->buckets[index] = student;
+    table->size++;
+}
+
+static void unindex_phone(HashTable* table, Student* student) {
+    if (student->phone_key == 0) return;
+
+    Student** link = &table->buckets[phone_bucket_index(table, student->phone_key)];
+    while (*link && *link != student) {
+        link = &(*link)->next_by_phone;
+    }
+    if (*link) {
+        *link = student->next_by_phone;
+        table->size--;
+    }
+    student->next_by_phone = NULL;
+}
+
+// Makes room for needed students in the class array, which starts at 10 and doubles
+static int reserve_class(Class* class, int needed) {
+    if (needed <= class->capacity) return 1;
+
+    int new_capacity = class->capacity ? class->capacity : 10;
+    while (new_capacity < needed) new_capacity *= 2;
+    Student** new_students = realloc(class->students, new_capacity * sizeof(Student*));
+    if (!new_students) return 0;
+    MEMORY_RESIZE(MemoryClassArrays, class->capacity * sizeof(Student*), new_capacity * sizeof(Student*));
+    class->students = new_students;
+    class->capacity = new_capacity;
+    return 1;
+}
+
+// Allocates the grade aggregates of the class, the school's store first if it has none yet.
+// Unlike the name index they have to count every student to stay exact, so failing here fails the insert.
+static int reserve_aggregates(School* school, int grade, int class) {
+    if (!school->aggregates) school->aggregates = AggregatesCreate();
+    return AggregatesReserve(school->aggregates, grade, class);
+}
 
+// Adds the student to its class, the name and phone hash tables, the name index and the aggregates.
+// The class array, the name hash table and the class's aggregates must already have room.
+static void link_student(School* school, Class* class, Student* student) {
     // Add the student to the class
+    student->class_slot = class->num_students;
     class->students[class->num_students++] = student;
     school->total_students++;
 
     // Insert into hash table
-    unsigned long index = hash(student->first_name, student->last_name);
+    unsigned long index = bucket_index(&school->hash_table, student->first_name, student->last_name);
     student->next = school->hash_table.buckets[index];
     school->hash_table.buckets[index] = student;
     school->hash_table.size++;
+
+    index_phone(&school->phone_index, student);
+
+    // A failed name index only costs search results, find keeps working
+    if (!school->name_index) school->name_index = NameIndexCreate();
+    NameIndexAdd(school->name_index, student);
+
+    AggregatesAdd(school->aggregates, student);
+}
+
+int insert_student(School* school, Student* student) {
+    if (!school || !student) return 0;
+
+    int grade_index = student->grade - 1;
+    int class_index = student->class - 1;
+
+    if (grade_index < 0 || grade_index >= MAX_GRADES || class_index < 0 || class_index >= MAX_CLASSES) {
+        printf("Invalid grade or class for student %s %s\n", student->first_name, student->last_name);
+        return 0;
+    }
+
+    STATS_START(start);
+    Class* class = &school->grades[grade_index].classes[class_index];
+
+    // Check if we need to resize the students array, classes get theirs with the first student
+    if (!reserve_class(class, class->num_students + 1) || !reserve_aggregates(school, student->grade, student->class)) {
+        printf("Failed to allocate memory for new student\n");
+        return 0;
+    }
+
+    // Grow the hash tables first, so a failed allocation leaves the student out of all of them
+    if ((school->hash_table.size >= school->hash_table.bucket_count &&
+         !grow_hash_table(&school->hash_table, school->hash_table.size + 1)) ||
+        !reserve_phone_index(&school->phone_index, school->phone_index.size + 1)) {
+        printf("Failed to allocate memory for new student\n");
+        return 0;
+    }
+
+    link_student(school, class, student);
+    STATS_STOP(StatInsertStudent, start);
+    return 1;
+}
+
+int insert_students(School* school, Student** students, int count) {
+    if (!school || !students || count <= 0) return 0;
+
+    STATS_START(start);
+    // Move students with an invalid grade or class past the ones that get inserted
+    int valid = 0;
+    for (int i = 0; i < count; i++) {
+        Student* student = students[i];
+        if (student->grade < 1 || student->grade > MAX_GRADES || student->class < 1 || student->class > MAX_CLASSES) {
+            printf("Invalid grade or class for student %s %s\n", student->first_name, student->last_name);
+            continue;
+        }
+        students[i] = students[valid];
+        students[valid++] = student;
+    }
+
+    // Size every class array and both hash tables once for the whole batch
+    int per_class[MAX_GRADES][MAX_CLASSES] = {{0}};
+    for (int i = 0; i < valid; i++) {
+        per_class[students[i]->grade - 1][students[i]->class - 1]++;
+    }
+    for (int grade = 0; grade < MAX_GRADES; grade++) {
+        for (int class_index = 0; class_index < MAX_CLASSES; class_index++) {
+            Class* class = &school->grades[grade].classes[class_index];
+            if (per_class[grade][class_index] > 0 &&
+                (!reserve_class(class, class->num_students + per_class[grade][class_index]) ||
+                 !reserve_aggregates(school, grade + 1, class_index + 1))) {
+                printf("Failed to allocate memory for %d students\n", valid);
+                return 0;
+            }
+        }
+    }
+    // Phones without digits aren't indexed, so this may reserve a few phone buckets too many
+    if (!grow_hash_table(&school->hash_table, school->hash_table.size + valid) ||
+        !reserve_phone_index(&school->phone_index, school->phone_index.size + valid)) {
+        printf("Failed to allocate memory for %d students\n", valid);
+        return 0;
+    }
+
+    for (int i = 0; i < valid; i++) {
+        Student* student = students[i];
+        link_student(school, &school->grades[student->grade - 1].classes[student->class - 1], student);
+    }
+    STATS_STOP(StatInsertStudents, start);
+    return valid;
+}
+
+void rank_students(School* school, Student** students, int count) {
+    if (!school || !students || count <= 0) return;
+
+    STATS_START(start);
+    // Group the students by grade level, every heap then gets its grade's group in one call.
+    // Students with an invalid grade level have no heaps and are left out, as insert_students does.
+    Student** by_grade = malloc(count * sizeof(Student*));
+    if (!by_grade) return;
+    int offsets[MAX_GRADES + 1] = {0};
+    for (int i = 0; i < count; i++) {
+        if (students[i]->grade >= 1 && students[i]->grade <= MAX_GRADES) {
+            offsets[students[i]->grade]++;
+        }
+    }
+    for (int grade = 1; grade <= MAX_GRADES; grade++) {
+        offsets[grade] += offsets[grade - 1];
+    }
+    int next[MAX_GRADES];
+    memcpy(next, offsets, sizeof(next));
+    for (int i = 0; i < count; i++) {
+        if (students[i]->grade >= 1 && students[i]->grade <= MAX_GRADES) {
+            by_grade[next[students[i]->grade - 1]++] = students[i];
+        }
+    }
+
+    for (int grade = 0; grade < MAX_GRADES; grade++) {
+        int size = offsets[grade + 1] - offsets[grade];
+        for (int course = 0; course < SUBJECTS && size > 0; course++) {
+            FixedSizeMaxHeap* heap = GetOrCreateHeap(school->heaps, grade, course);
+            if (heap != NULL)
+                insertMany(heap, by_grade + offsets[grade], size);
+        }
+    }
+    free(by_grade);
+    STATS_STOP(StatRankStudents, start);
+}
+
+void remove_student_from_class(School* school, Student* student) {
+    if (!school || !student) return;
+    if (student->grade < 1 || student->grade > MAX_GRADES || student->class < 1 || student->class > MAX_CLASSES) return;
+
+    Class* class = &school->grades[student->grade - 1].classes[student->class - 1];
+    int slot = student->class_slot;
+    if (slot < 0 || slot >= class->num_students || class->students[slot] != student) return;
+
+    Student* last = class->students[--class->num_students];
+    class->students[slot] = last;
+    last->class_slot = slot;
+    student->class_slot = -1;
 }
 
 School* create_school() {
     School* school = malloc(sizeof(School));
     if (!school) return NULL;
+    MEMORY_ADD(MemorySchool, sizeof(School));
 
+    // No buckets, class arrays or heaps yet, an empty school is just this struct
     memset(school, 0, sizeof(School));
 
     // Initialize grades and classes
@@ -111,13 +384,6 @@ School* create_school() {
         school->grades[i].grade_id = i + 1;
         for (int j = 0; j < MAX_CLASSES; j++) {
             school->grades[i].classes[j].class_id = j + 1;
-            school->grades[i].classes[j].capacity = 10;
-            school->grades[i].classes[j].students = malloc(10 * sizeof(Student*));
-            if (!school->grades[i].classes[j].students) {
-                // Handle allocation failure
-                // For simplicity, we're not handling this case fully here
-                return NULL;
-            }
         }
         school->grades[i].num_classes = MAX_CLASSES;
     }
@@ -126,34 +392,72 @@ School* create_school() {
     return school;
 }
 
+// Students read from the roster before they are inserted together
+#define READ_BATCH 1024
+
+// Inserts and, unless the heaps came from the matrix file, ranks a batch read from the roster.
+// Students that can't be inserted are freed.
+static void insert_batch(School* school, Student** batch, int count) {
+    if (count == 0) return;
+
+    TRACE_BEGIN(insertSpan);
+    int inserted = insert_students(school, batch, count);
+    TRACE_END(insertSpan, "insert_students");
+
+    if (!school->heaps_loaded) {
+        TRACE_BEGIN(rankSpan);
+        rank_students(school, batch, inserted);
+        TRACE_END(rankSpan, "rank_students");
+    }
+
+    for (int i = inserted; i < count; i++) {
+        MEMORY_REMOVE(MemoryStudents, sizeof(Student));
+        free(batch[i]);
+    }
+}
+
 School* read_data_from_file(const char* file_name) {
+    STATS_START(start);
+    TRACE_BEGIN(readSpan);
     FILE* file = fopen(file_name, "r");
     if (!file) {
         printf("Error opening file.\n");
         return NULL;
     }
-    setup(MatrixPath);
     School* school = create_school();
     if (!school) {
         printf("Failed to create school.\n");
         fclose(file);
         return NULL;
     }
+    setup(school, MatrixPath);
 
+    // Lines are traced one in every CHECKPOINT_TRACE_SAMPLE, a large roster would fill the trace otherwise.
+    // Students are inserted and ranked a batch at a time, so the class arrays, the hash
+    // tables and the heaps are maintained once per batch rather than once per line.
     char line[256];
+    long lineNumber = 0;
+    Student* batch[READ_BATCH];
+    int batched = 0;
+    TRACE_BEGIN(linesSpan);
     while (fgets(line, sizeof(line), file)) {
+        TRACE_BEGIN_IF(lineSpan, TraceSampled(lineNumber));
+        lineNumber++;
         Student* student = malloc(sizeof(Student));
         if (!student) {
             printf("Memory allocation failed for student.\n");
             continue;
         }
+        MEMORY_ADD(MemoryStudents, sizeof(Student));
 
+        TRACE_BEGIN_IF(parseSpan, lineSpan);
         if (sscanf(line, "%s %s %s %d %d %d %d %d %d %d %d %d %d %d %d",
                    student->first_name, student->last_name, student->phone,
                    &student->grade, &student->class,
                    &student->grades[0], &student->grades[1], &student->grades[2], &student->grades[3],
                    &student->grades[4], &student->grades[5], &student->grades[6], &student->grades[7],
                    &student->grades[8], &student->grades[9]) == 15) {
+            TRACE_END(parseSpan, "parse line");
 
             int sum = 0;
             for (int i = 0; i < SUBJECTS; i++) {
@@ -161,28 +465,31 @@ School* read_data_from_file(const char* file_name) {
             }
             student->average_grade = (double)sum / SUBJECTS;
 
-            insert_student(school, student);
-            for (int i = 0; i < 10; i++) {
-                // Check if heap exists, if not create it
-                if (heapMatrix[student->grade-1][i+1] == NULL) {
-                    heapMatrix[student->grade-1][i+1] = CreateMaxHeap(student->grade, i);
-                    if (heapMatrix[student->grade-1][i+1] == NULL) {
-                        continue;
-                    }
-                }
-                    if(loaded == 0)
-                    insert(heapMatrix[student->grade-1][i + 1], student);
+            batch[batched++] = student;
+            if (batched == READ_BATCH) {
+                insert_batch(school, batch, batched);
+                batched = 0;
             }
         } else {
             printf("Error parsing line: %s", line);
+            MEMORY_REMOVE(MemoryStudents, sizeof(Student));
             free(student);
         }
+        TRACE_END(lineSpan, "line");
     }
-    SaveHeapMatrixToJson(MatrixPath);
+    insert_batch(school, batch, batched);
+    TRACE_END(linesSpan, "read lines");
+
+    TRACE_BEGIN(saveSpan);
+    SaveHeapMatrixToJson(school->heaps, MatrixPath);
+    TRACE_END(saveSpan, "SaveHeapMatrixToJson");
 
 
     fclose(file);
     printf("Total students added: %d\n", school->total_students);
+    StatsWatchHashTable(&school->hash_table);
+    STATS_STOP(StatReadDataFile, start);
+    TRACE_END(readSpan, "read_data_from_file");
     return school;
 }
 
@@ -192,6 +499,7 @@ void insertNewStudent(School* school) {
         printf("Failed to allocate memory for new student.\n");
         return;
     }
+    MEMORY_ADD(MemoryStudents, sizeof(Student));
 
     printf("Enter student's first name: ");
     scanf("%s", new_student->first_name);
@@ -218,6 +526,7 @@ void insertNewStudent(School* school) {
     if (new_student->grade < 1 || new_student->grade > MAX_GRADES ||
         new_student->class < 1 || new_student->class > MAX_CLASSES) {
         printf("Invalid grade or class. Student not added.\n");
+        MEMORY_REMOVE(MemoryStudents, sizeof(Student));
         free(new_student);
         return;
     }
@@ -229,10 +538,17 @@ void insertNewStudent(School* school) {
     }
     new_student->average_grade = (double)sum / SUBJECTS;
 
-    // Insert the new student
-    insert_student(school, new_student);
-    for (int i = 0; i <10 ; i++) {
-        insert(heapMatrix[new_student->grade][i],new_student);
+    // Insert the new student, it is only ranked once it is in the roster
+    if (!insert_student(school, new_student)) {
+        printf("Student %s %s was not added.\n", new_student->first_name, new_student->last_name);
+        MEMORY_REMOVE(MemoryStudents, sizeof(Student));
+        free(new_student);
+        return;
+    }
+    for (int i = 0; i < SUBJECTS; i++) {
+        FixedSizeMaxHeap* heap = GetOrCreateHeap(school->heaps, new_student->grade - 1, i);
+        if (heap != NULL)
+            insert(heap, new_student);
     }
     printf("Student %s %s added successfully.\n", new_student->first_name, new_student->last_name);
 }
@@ -246,7 +562,11 @@ void deleteStudent(School* school) {
     printf("Enter the last name of the student to delete: ");
     scanf("%s", last_name);
 
-    unsigned long index = hash(first_name, last_name);
+    if (school->hash_table.bucket_count == 0) {
+        printf("Student %s %s not found.\n", first_name, last_name);
+        return;
+    }
+    unsigned long index = bucket_index(&school->hash_table, first_name, last_name);
     Student* current = school->hash_table.buckets[index];
     Student* prev = NULL;
 
@@ -260,13 +580,20 @@ void deleteStudent(School* school) {
                 prev->next = current->next;
             }
 
+            school->hash_table.size--;
+            unindex_phone(&school->phone_index, current);
+            NameIndexRemove(school->name_index, current);
+            AggregatesRemove(school->aggregates, current);
+            remove_student_from_class(school, current);
             school->total_students--;
 
             printf("Student %s %s has been deleted.\n", first_name, last_name);
-            for (int i = 0; i <10 ; i++)
+            for (int i = 0; i < SUBJECTS; i++)
             {
-                Delete(heapMatrix[current->grade][i],current);
+                if (school->heaps[current->grade - 1][i] != NULL)
+                    Delete(school->heaps[current->grade - 1][i],current);
             }
+            MEMORY_REMOVE(MemoryStudents, sizeof(Student));
             free(current);
             return;
         }
@@ -314,6 +641,7 @@ void editStudentGrade(School* school) {
 
     int old_grade = student->grades[subject];
     student->grades[subject] = new_grade;
+    AggregatesChange(school->aggregates, student, subject, old_grade);
 
     // Recalculate student's average
     int sum = 0;
@@ -322,35 +650,396 @@ void editStudentGrade(School* school) {
     }
     double old_average = student->average_grade;
     student->average_grade = (double)sum / SUBJECTS;
-    for (int i = 0; i <10 ;i++) {
-        update(heapMatrix[student->grade][i],student);
+    for (int i = 0; i < SUBJECTS; i++) {
+        if (school->heaps[student->grade - 1][i] != NULL)
+            update(school->heaps[student->grade - 1][i],student);
     }
     printf("Grade updated successfully.\n");
 }
 
+// A grade update between lookup and re-ranking. key is the hash bucket of the name while the
+// students are looked up, then the grade level and course whose ranking the update changes.
+typedef struct {
+    unsigned long key;
+    Student* student;
+    int row;
+    int delta;
+} PendingUpdate;
+
+static int compare_pending(const void* a, const void* b) {
+    const PendingUpdate* left = a;
+    const PendingUpdate* right = b;
+    if (left->key != right->key) return left->key < right->key ? -1 : 1;
+    if (left->student != right->student) return left->student < right->student ? -1 : 1;
+    return left->row - right->row;
+}
+
+// Ranks every student of the grade level again, for when a ranked student's grade went down
+static void rerank_grade(School* school, FixedSizeMaxHeap* heap, int grade_index) {
+    int count = 0;
+    for (int i = 0; i < MAX_CLASSES; i++) {
+        count += school->grades[grade_index].classes[i].num_students;
+    }
+    Student** students = malloc((count ? count : 1) * sizeof(Student*));
+    if (!students) return;
+
+    count = 0;
+    for (int i = 0; i < MAX_CLASSES; i++) {
+        Class* class = &school->grades[grade_index].classes[i];
+        if (class->num_students == 0) continue;  // lazily allocated, students may still be NULL
+        memcpy(students + count, class->students, class->num_students * sizeof(Student*));
+        count += class->num_students;
+    }
+    rankAll(heap, students, count);
+    free(students);
+}
+
+int apply_grade_updates(School* school, const GradeUpdate* updates, int count) {
+    if (!school || !updates || count <= 0 || school->hash_table.bucket_count == 0) return 0;
+
+    PendingUpdate* pending = malloc(count * sizeof(PendingUpdate));
+    Student** resolved = malloc(count * sizeof(Student*));
+    if (!pending || !resolved) {
+        printf("Failed to allocate memory for %d grade updates\n", count);
+        free(pending);
+        free(resolved);
+        return 0;
+    }
+
+    STATS_START(start);
+    // Hash every name once and sort the rows by bucket, then walk each bucket's chain a
+    // single time for all the rows that land in it. A row takes the first student of the
+    // chain with its name, the same one find would return.
+    TRACE_BEGIN(resolveSpan);
+    for (int i = 0; i < count; i++) {
+        pending[i].key = bucket_index(&school->hash_table, updates[i].first_name, updates[i].last_name);
+        pending[i].student = NULL;
+        pending[i].row = i;
+        resolved[i] = NULL;
+    }
+    qsort(pending, count, sizeof(PendingUpdate), compare_pending);
+    for (int begin = 0, end; begin < count; begin = end) {
+        for (end = begin + 1; end < count && pending[end].key == pending[begin].key; end++);
+
+        int unresolved = end - begin;
+        for (Student* current = school->hash_table.buckets[pending[begin].key]; current && unresolved > 0;
+             current = current->next) {
+            STATS_COUNT(StatFindProbes, 1);
+            for (int i = begin; i < end; i++) {
+                const GradeUpdate* update = &updates[pending[i].row];
+                if (resolved[pending[i].row] == NULL && strcasecmp(current->first_name, update->first_name) == 0 &&
+                    strcasecmp(current->last_name, update->last_name) == 0) {
+                    resolved[pending[i].row] = current;
+                    unresolved--;
+                }
+            }
+        }
+    }
+    TRACE_END(resolveSpan, "resolve students");
+
+    // Apply in file order, so the last row for a student and subject wins
+    TRACE_BEGIN(applySpan);
+    int applied = 0;
+    for (int i = 0; i < count; i++) {
+        Student* student = resolved[i];
+        const GradeUpdate* update = &updates[i];
+        if (student == NULL) {
+            printf("Student %s %s not found.\n", update->first_name, update->last_name);
+            continue;
+        }
+        if (update->subject < 1 || update->subject > SUBJECTS || update->grade < 0 || update->grade > 100) {
+            printf("Invalid subject or grade for %s %s.\n", update->first_name, update->last_name);
+            continue;
+        }
+
+        int course = update->subject - 1;
+        pending[applied].key = (unsigned long)((student->grade - 1) * SUBJECTS + course);
+        pending[applied].student = student;
+        pending[applied].row = i;
+        pending[applied].delta = update->grade - student->grades[course];
+        applied++;
+
+        int old_grade = student->grades[course];
+        student->grades[course] = update->grade;
+        AggregatesChange(school->aggregates, student, course, old_grade);
+        int sum = 0;
+        for (int j = 0; j < SUBJECTS; j++) {
+            sum += student->grades[j];
+        }
+        student->average_grade = (double)sum / SUBJECTS;
+    }
+    TRACE_END(applySpan, "apply grades");
+
+    // Every (grade level, course) ranking is repaired once, with each changed student in it once
+    TRACE_BEGIN(rankSpan);
+    qsort(pending, applied, sizeof(PendingUpdate), compare_pending);
+    for (int begin = 0, end; begin < applied; begin = end) {
+        int changed = 0, delta = 0;
+        for (end = begin; end < applied && pending[end].key == pending[begin].key; end++) {
+            if (end == begin || pending[end].student != pending[end - 1].student) {
+                resolved[changed++] = pending[end].student;
+            }
+            delta += pending[end].delta;
+        }
+
+        int grade_index = (int)(pending[begin].key / SUBJECTS);
+        FixedSizeMaxHeap* heap = school->heaps[grade_index][pending[begin].key % SUBJECTS];
+        if (heap != NULL && !updateMany(heap, resolved, changed, delta)) {
+            rerank_grade(school, heap, grade_index);
+        }
+    }
+    TRACE_END(rankSpan, "rank grades");
+
+    free(pending);
+    free(resolved);
+    STATS_STOP(StatApplyGradeUpdates, start);
+    return applied;
+}
+
+int import_grade_updates(School* school, const char* file_name) {
+    FILE* file = fopen(file_name, "r");
+    if (!file) {
+        printf("Error opening file.\n");
+        return -1;
+    }
+
+    // The whole file is applied as one batch, so every ranking is repaired once
+    GradeUpdate* updates = NULL;
+    int count = 0, capacity = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        if (count == capacity) {
+            int new_capacity = capacity ? capacity * 2 : 1024;
+            GradeUpdate* grown = realloc(updates, new_capacity * sizeof(GradeUpdate));
+            if (!grown) {
+                printf("Failed to allocate memory for grade updates.\n");
+                break;
+            }
+            updates = grown;
+            capacity = new_capacity;
+        }
+
+        GradeUpdate* update = &updates[count];
+        if (sscanf(line, "%19s %19s %d %d", update->first_name, update->last_name, &update->subject, &update->grade) == 4) {
+            count++;
+        } else if (strspn(line, " \t\r\n") != strlen(line)) {
+            printf("Error parsing line: %s", line);
+        }
+    }
+    fclose(file);
+
+    int applied = apply_grade_updates(school, updates, count);
+    free(updates);
+    return applied;
+}
+
+void importExamResults(School* school) {
+    char file_name[256];
+
+    printf("Enter the exam results file (first name, last name, subject and grade per line): ");
+    if (scanf("%255s", file_name) != 1) {
+        printf("Error reading input.\n");
+        return;
+    }
+
+    int applied = import_grade_updates(school, file_name);
+    if (applied >= 0) {
+        printf("Grades updated: %d\n", applied);
+    }
+}
+
 Student* find(School* school, const char* first_name, const char* last_name) {
     if (!school || !first_name || !last_name) return NULL;
 
-    unsigned long index = hash(first_name, last_name);
+    if (school->hash_table.bucket_count == 0) return NULL;
+
+    STATS_START(start);
+    unsigned long index = bucket_index(&school->hash_table, first_name, last_name);
     Student* current = school->hash_table.buckets[index];
 
     while (current != NULL) {
+        STATS_COUNT(StatFindProbes, 1);
         if (strcasecmp(current->first_name, first_name) == 0 &&
             strcasecmp(current->last_name, last_name) == 0) {
+            STATS_STOP(StatFind, start);
             return current;
         }
         current = current->next;
     }
 
+    STATS_STOP(StatFind, start);
+    return NULL;
+}
+
+Student* find_by_phone(School* school, const char* phone) {
+    if (!school || !phone || school->phone_index.bucket_count == 0) return NULL;
+
+    unsigned long long key = pack_phone(phone);
+    if (key == 0) return NULL;
+
+    STATS_START(start);
+    Student* current = school->phone_index.buckets[phone_bucket_index(&school->phone_index, key)];
+    while (current != NULL) {
+        STATS_COUNT(StatPhoneProbes, 1);
+        if (current->phone_key == key) {
+            STATS_STOP(StatFindByPhone, start);
+            return current;
+        }
+        current = current->next_by_phone;
+    }
+
+    STATS_STOP(StatFindByPhone, start);
     return NULL;
 }
 
+int update_student_phone(School* school, Student* student, const char* phone) {
+    if (!school || !student || !phone) return 0;
+
+    // A student whose old phone had no digits takes a new place in the index
+    if (!reserve_phone_index(&school->phone_index, school->phone_index.size + 1)) return 0;
+
+    // The heaps recognize their copies of a student by the phone too, so the copies change with it
+    for (int course = 0; course < SUBJECTS; course++) {
+        FixedSizeMaxHeap* heap = school->heaps[student->grade - 1][course];
+        for (int i = 0; heap != NULL && i < heap->FilledIndex; i++) {
+            if (isSameStudent(&heap->students[i], student)) {
+                strncpy(heap->students[i].phone, phone, MAX_PHONE - 1);
+                heap->students[i].phone[MAX_PHONE - 1] = '\0';
+            }
+        }
+    }
+
+    unindex_phone(&school->phone_index, student);
+    strncpy(student->phone, phone, MAX_PHONE - 1);
+    student->phone[MAX_PHONE - 1] = '\0';
+    index_phone(&school->phone_index, student);
+    return 1;
+}
+
+void editStudentPhone(School* school) {
+    char first_name[MAX_NAME];
+    char last_name[MAX_NAME];
+    char phone[64];
+
+    printf("Enter the first name of the student: ");
+    scanf("%19s", first_name);
+    printf("Enter the last name of the student: ");
+    scanf("%19s", last_name);
+
+    Student* student = find(school, first_name, last_name);
+    if (student == NULL) {
+        printf("Student not found.\n");
+        return;
+    }
+
+    printf("Current phone: %s\n", student->phone);
+    // The rest of the line, phones may be written with spaces
+    printf("Enter the new phone number: ");
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF);
+    if (fgets(phone, sizeof(phone), stdin) == NULL) {
+        printf("Error reading input.\n");
+        return;
+    }
+    phone[strcspn(phone, "\n")] = 0;
+    if (strlen(phone) >= MAX_PHONE || pack_phone(phone) == 0) {
+        printf("Invalid phone number.\n");
+        return;
+    }
+
+    if (!update_student_phone(school, student, phone)) {
+        printf("Failed to allocate memory for the phone index.\n");
+        return;
+    }
+    printf("Phone updated successfully.\n");
+}
+
+// Most results one search returns
+#define SEARCH_CANDIDATES 256
+// Counting a word's candidates stops here, past it either word is as costly
+#define SEARCH_COUNT_LIMIT 100000
+
+// Typos allowed grow with the word: none up to 2 letters, "al" with one would
+// match most of the school, one up to 5 letters and two beyond that
+static int allowed_edits(const char* word) {
+    size_t length = strlen(word);
+    return length <= 2 ? 0 : length <= 5 ? 1 : 2;
+}
+
+typedef struct {
+    const char* first;
+    const char* last;
+} FullNameQuery;
+
+// With two words the index finds candidates by one of them, both names are
+// checked here and the student ranks by the edits of both together
+static int score_full_name(const Student* student, const void* context) {
+    const FullNameQuery* query = context;
+    int last_edits = NameIndexDistance(student->last_name, query->last, allowed_edits(query->last));
+    if (last_edits < 0) return -1;
+    int first_edits = NameIndexDistance(student->first_name, query->first, allowed_edits(query->first));
+    return first_edits < 0 ? -1 : first_edits + last_edits;
+}
+
+int search_students(School* school, const char* query, Student** results, int max) {
+    if (!school || !query || !school->name_index || max <= 0) return 0;
+
+    char first[MAX_NAME], last[MAX_NAME];
+    int words = sscanf(query, "%19s %19s", first, last);
+    if (words < 1) return 0;
+    if (max > SEARCH_CANDIDATES) max = SEARCH_CANDIDATES;
+
+    STATS_START(start);
+    FullNameQuery full_name = {first, last};
+    NameScore score = NULL;
+    const char* word = first;
+    if (words == 2) {
+        // Look candidates up by whichever word has fewer, a common first name
+        // can have thousands of students where the last name has a handful
+        score = score_full_name;
+        int first_count = NameIndexCount(school->name_index, first, allowed_edits(first), SEARCH_COUNT_LIMIT);
+        int last_count = NameIndexCount(school->name_index, last, allowed_edits(last), first_count);
+        if (last_count < first_count) word = last;
+    }
+
+    // Prefix matches of the word, then its typos for whatever room is left
+    NameMatch matches[SEARCH_CANDIDATES], typos[SEARCH_CANDIDATES];
+    int count = NameIndexPrefix(school->name_index, word, score, &full_name, matches, max);
+    if (count < max) {
+        int found = NameIndexFuzzy(school->name_index, word, allowed_edits(word), score, &full_name, typos, max);
+        for (int i = 0; i < found && count < max; i++) {
+            int seen = 0;
+            for (int j = 0; j < count && !seen; j++) {
+                seen = matches[j].student == typos[i].student;
+            }
+            if (!seen) matches[count++] = typos[i];
+        }
+    }
+
+    // Edits of the other name can put a typo ahead of a prefix match
+    for (int i = 1; i < count; i++) {
+        NameMatch match = matches[i];
+        int at = i;
+        while (at > 0 && matches[at - 1].distance > match.distance) {
+            matches[at] = matches[at - 1];
+            at--;
+        }
+        matches[at] = match;
+    }
+
+    for (int i = 0; i < count; i++) {
+        results[i] = matches[i].student;
+    }
+    STATS_STOP(StatSearchNames, start);
+    return count;
+}
+
 void searchStudent(School* school) {
     char input[MAX_NAME * 2];
     char first_name[MAX_NAME];
     char last_name[MAX_NAME];
 
-    printf("Please enter name and last name separated by space:\n");
+    printf("Please enter name and last name separated by space, or the start of a name:\n");
     while (getchar() != '\n');
 
     if (fgets(input, sizeof(input), stdin) == NULL) {
@@ -360,12 +1049,13 @@ void searchStudent(School* school) {
 
     input[strcspn(input, "\n")] = 0;
 
-    if (sscanf(input, "%s %s", first_name, last_name) != 2) {
-        printf("Invalid input. Please enter both first and last name.\n");
+    int words = sscanf(input, "%19s %19s", first_name, last_name);
+    if (words < 1) {
+        printf("Invalid input. Please enter a name.\n");
         return;
     }
 
-    Student* student = find(school, first_name, last_name);
+    Student* student = words == 2 ? find(school, first_name, last_name) : NULL;
 
     if (student != NULL) {
         printf("Student found:\n");
@@ -379,11 +1069,49 @@ void searchStudent(School* school) {
         }
         printf("\nAverage Grade: %.2f\n", student->average_grade);
     } else {
-        printf("Student not found. Please check the spelling and try again.\n");
+        // No exact match, list the names that start with or are close to what was typed
+        Student* matches[10];
+        int count = search_students(school, input, matches, 10);
+        if (count == 0) {
+            printf("Student not found. Please check the spelling and try again.\n");
+            return;
+        }
+        printf("%s:\n", words == 2 ? "Student not found, did you mean" : "Matching students");
+        for (int i = 0; i < count; i++) {
+            printf("  %s %s (grade %d, class %d, phone %s)\n", matches[i]->first_name, matches[i]->last_name,
+                   matches[i]->grade, matches[i]->class, matches[i]->phone);
+        }
     }
 
 }
 
+void searchStudentByPhone(School* school) {
+    char input[64];
+
+    printf("Please enter the phone number:\n");
+    while (getchar() != '\n');
+
+    if (fgets(input, sizeof(input), stdin) == NULL) {
+        printf("Error reading input.\n");
+        return;
+    }
+
+    input[strcspn(input, "\n")] = 0;
+
+    Student* student = find_by_phone(school, input);
+
+    if (student != NULL) {
+        printf("Student found:\n");
+        printf("Name: %s %s\n", student->first_name, student->last_name);
+        printf("Phone: %s\n", student->phone);
+        printf("Grade: %d\n", student->grade);
+        printf("Class: %d\n", student->class);
+        printf("Average Grade: %.2f\n", student->average_grade);
+    } else {
+        printf("No student with phone %s.\n", input);
+    }
+}
+
 void printAllStudents(School* school) {
     if (school == NULL || school->total_students == 0) {
         printf("No students in the school.\n");
@@ -394,7 +1122,7 @@ void printAllStudents(School* school) {
            "First Name", "Last Name", "Phone", "Grade", "Class", "Grades", "Average Grade");
     printf("----------------------------------------------------------------------------------------------------\n");
 
-    for (int i = 0; i < HASH_SIZE; i++) {
+    for (int i = 0; i < school->hash_table.bucket_count; i++) {
         Student* current = school->hash_table.buckets[i];
         while (current != NULL) {
             printf("%-20s %-20s %-15s %-6d %-6d ",
@@ -420,26 +1148,58 @@ void printTopNStudentsPerCourse(School* school) {
     int grade , course;
     printf("enter grade and course number");
     scanf("%d %d" , &grade,&course);
-    printHeap(heapMatrix[grade][course-1]);
+    if (grade < 1 || grade > MAX_GRADES || course < 1 || course > SUBJECTS || school->heaps[grade-1][course-1] == NULL) {
+        printf("No students for grade %d in course %d.\n", grade, course);
+        return;
+    }
+    printHeap(school->heaps[grade-1][course-1]);
 }
 
 void printUnderperformedStudents(School* school, int threshold) {
     printf("Print underperformed students function not implemented yet.\n");
 }
 
+// One line of printAverage: mean, spread and range of a course's grades over some group of students
+static void print_totals(const char* label, const GradeTotals* totals) {
+    printf("%-18s %8.2f %8.2f %5d %5d %9d\n", label, AggregatesMean(totals), AggregatesStdDev(totals),
+           totals->min, totals->max, totals->count);
+}
+
 void printAverage(School* school) {
     int input;
     printf("Enter the course you want to see: ");
     scanf("%d", &input);
-    for (int i = 0; i <12 ;i++)
-    {
-        if (heapMatrix[i][input-1] != NULL && heapMatrix[i][input-1]->studentsCount > 0) {
-            printf("The average grades for grade_level %d: %.2f\n", i+1,
-                   (float)heapMatrix[i][input-1]->overall_grade / heapMatrix[i][input-1]->studentsCount);
-        } else {
-            printf("No students or data available for grade_level %d in course %d.\n", i+1, input);
+    if (input < 1 || input > SUBJECTS) {
+        printf("Invalid course number.\n");
+        return;
+    }
+    int course = input - 1;
+
+    printf("\nCourse %d\n", input);
+    printf("%-18s %8s %8s %5s %5s %9s\n", "", "average", "std dev", "min", "max", "students");
+    for (int grade_level = 1; grade_level <= MAX_GRADES; grade_level++) {
+        GradeTotals totals = AggregatesQuery(school->aggregates, grade_level, 0, course);
+        char label[32];
+        snprintf(label, sizeof(label), "grade_level %d", grade_level);
+        if (totals.count == 0) {
+            printf("%-18s no students\n", label);
+            continue;
+        }
+
+        print_totals(label, &totals);
+        for (int class = 1; class <= MAX_CLASSES; class++) {
+            GradeTotals class_totals = AggregatesQuery(school->aggregates, grade_level, class, course);
+            if (class_totals.count == 0) continue;
+            snprintf(label, sizeof(label), "  class %d", class);
+            print_totals(label, &class_totals);
         }
+    }
 
+    GradeTotals totals = AggregatesQuery(school->aggregates, 0, 0, course);
+    if (totals.count == 0) {
+        printf("%-18s no students\n", "all grade levels");
+    } else {
+        print_totals("all grade levels", &totals);
     }
 }
 
@@ -449,13 +1209,15 @@ void exportDatabase(School* school, const char* file_name) {
 
 void destroySchool(School* school) {
     if (!school) return;
+    StatsWatchHashTable(NULL);
 
     // Free students in hash table
-    for (int i = 0; i < HASH_SIZE; i++) {
+    for (int i = 0; i < school->hash_table.bucket_count; i++) {
         Student* current = school->hash_table.buckets[i];
         while (current) {
             Student* temp = current;
             current = current->next;
+            MEMORY_REMOVE(MemoryStudents, sizeof(Student));
             free(temp);
         }
     }
@@ -463,10 +1225,20 @@ void destroySchool(School* school) {
     // Free students in classes
     for (int i = 0; i < MAX_GRADES; i++) {
         for (int j = 0; j < MAX_CLASSES; j++) {
+            MEMORY_RESIZE(MemoryClassArrays, school->grades[i].classes[j].capacity * sizeof(Student*), 0);
             free(school->grades[i].classes[j].students);
         }
     }
 
+    MEMORY_RESIZE(MemoryHashBuckets, school->hash_table.bucket_count * sizeof(Student*), 0);
+    free(school->hash_table.buckets);
+    MEMORY_RESIZE(MemoryHashBuckets, school->phone_index.bucket_count * sizeof(Student*), 0);
+    free(school->phone_index.buckets);
+    NameIndexFree(school->name_index);
+    AggregatesFree(school->aggregates);
+    FreeHeapMatrix(school->heaps);
+
+    MEMORY_REMOVE(MemorySchool, sizeof(School));
     free(school);
     printf("School destroyed.\n");
 }
@@ -496,12 +1268,17 @@ void menu() {
         printf("\t[7] |--> Average per course\n");
         printf("\t[8] |--> Export\n");
         printf("\t[9] |--> Exit\n");
-        printf("\n\tPlease Enter Your Choice (0-9): ");
+        printf("\t[10] |--> Statistics\n");
+        printf("\t[11] |--> Memory report\n");
+        printf("\t[12] |--> Search by phone\n");
+        printf("\t[13] |--> Import exam results\n");
+        printf("\t[14] |--> Edit phone\n");
+        printf("\n\tPlease Enter Your Choice (0-14): ");
 
         if (scanf("%d", &input) != 1) {
             // Invalid input, clear the input buffer
             while (getchar() != '\n');
-            printf("\nInvalid input. Please enter a number between 0 and 9.\n");
+            printf("\nInvalid input. Please enter a number between 0 and 14.\n");
             continue;
         }
 
@@ -536,8 +1313,23 @@ void menu() {
             case 9:
                 destroySchool(school);
                 break;
+            case 10:
+                StatsPrint(stdout);
+                break;
+            case 11:
+                MemoryPrint(stdout);
+                break;
+            case 12:
+                searchStudentByPhone(school);
+                break;
+            case 13:
+                importExamResults(school);
+                break;
+            case 14:
+                editStudentPhone(school);
+                break;
             default:
-                printf("\nThere is no item with symbol \"%d\". Please enter a number between 0 and 9!\n", input);
+                printf("\nThere is no item with symbol \"%d\". Please enter a number between 0 and 14!\n", input);
                 break;
         }
 
@@ -545,8 +1337,3 @@ void menu() {
         while (getchar() != '\n');
     } while (input != 9);
 }
-
-int main() {
-    menu();
-    return 0;
-}
\ No newline at end of file
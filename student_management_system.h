@@ -5,13 +5,14 @@
 #ifndef CHECKPOINT_STUDENT_MANAGEMENT_SYSTEM_H
 #define CHECKPOINT_STUDENT_MANAGEMENT_SYSTEM_H
 
-#define HASH_SIZE 10007
+// Buckets a school's hash table starts with, it doubles whenever it holds as many students as buckets
+#define HASH_INITIAL_SIZE 16
 #define MAX_NAME 20
 #define MAX_PHONE 15
 #define MAX_GRADES 12
 #define MAX_CLASSES 10
 #define SUBJECTS 10
-typedef struct{
+typedef struct Student {
     char first_name[MAX_NAME];
     char last_name[MAX_NAME];
     char phone[MAX_PHONE];
@@ -19,7 +20,10 @@ typedef struct{
     int class;
     int grades[10];
     double average_grade;
+    int class_slot;       // index in its class's students array, so removal needs no search
+    unsigned long long phone_key; // phone packed by pack_phone, 0 when it has no digits
     struct Student* next;
+    struct Student* next_by_phone;
 } Student;
 
 typedef struct {
@@ -36,25 +40,54 @@ typedef struct {
 } Grade;
 
 typedef struct {
-    Student* buckets[HASH_SIZE];
+    Student** buckets;    // allocated with the first student
+    int bucket_count;
     int size;
 } HashTable;
 
+// Top students per grade level and course, see FixedSizeHeap.h. Heaps are created when first needed.
+struct FixedSizeMaxHeap;
+typedef struct FixedSizeMaxHeap* HeapMatrix[MAX_GRADES][SUBJECTS];
+
+// Everything a school owns, so one process can keep any number of them.
+// Class arrays, hash buckets and heaps are only allocated once students arrive.
 typedef struct {
     HashTable hash_table;
+    HashTable phone_index; // same layout as hash_table, keyed on phone_key and chained through next_by_phone
     Grade grades[12];
     int num_of_grades;
     int total_students;
+    HeapMatrix heaps;
+    int heaps_loaded;     // heaps came from the matrix file, so reading the roster doesn't insert again
+    struct NameIndex* name_index; // prefix and typo search over the names, see name_index.h
+    struct GradeAggregates* aggregates; // grade totals per grade level, class and course, see grade_aggregates.h
 } School;
 
 
 
+// One row of an exam results import
+typedef struct {
+    char first_name[MAX_NAME];
+    char last_name[MAX_NAME];
+    int subject;    // 1 to SUBJECTS
+    int grade;      // 0 to 100
+} GradeUpdate;
+
 //functions
 unsigned long hash(const char* first_name, const char* last_name);
 HashTable* create_hash_table();
 School* read_data_from_file(const char* file_name);
 School* create_school();
-void insert_student(School* school, Student* student);
+// Returns 0 when the student's grade or class is invalid or memory runs out, the caller then still owns it
+int insert_student(School* school, Student* student);
+// Inserts count students, growing each class array and the hash tables once for all of them.
+// Students with an invalid grade or class are moved after the inserted ones; returns how many were inserted.
+int insert_students(School* school, Student** students, int count);
+// Adds count inserted students to the top ranked heaps, one insertMany per grade and course.
+// Students with a grade outside 1 to MAX_GRADES are skipped.
+void rank_students(School* school, Student** students, int count);
+// Takes the student out of its class in O(1) by moving the class's last student into its slot
+void remove_student_from_class(School* school, Student* student);
 void insertNewStudent(School* school);
 void deleteStudent(School* school);
 void editStudentGrade(School* school);
@@ -65,6 +98,24 @@ void printUnderperformedStudents(School* school, int threshold);
 void printAverage(School* school);
 void exportDatabase(School* school, const char* file_name);
 void destroySchool(School* school);
-void setup(const char *matrix_filename);
+void setup(School* school, const char *matrix_filename);
 Student* find(School* school, const char* first_name, const char* last_name) ;
+// Phone numbers are compared by their digits only, so "050-123 4567" finds "0501234567"
+unsigned long long pack_phone(const char* phone);
+Student* find_by_phone(School* school, const char* phone);
+// Changes a student's phone and moves it to its new phone index chain.
+// Returns 0 and leaves the phone as it was when the index can't grow.
+int update_student_phone(School* school, Student* student, const char* phone);
+void searchStudentByPhone(School* school);
+void editStudentPhone(School* school);
+// Up to max students whose names start with or are a typo or two away from query,
+// "first" or "first last", best matches first. At most 256 are returned.
+int search_students(School* school, const char* query, Student** results, int max);
+// Applies count grade updates, looking the students up together and repairing each
+// (grade level, course) ranking once. Returns how many were applied.
+int apply_grade_updates(School* school, const GradeUpdate* updates, int count);
+// Applies a file of "first last subject grade" lines as one batch, -1 when it can't be opened
+int import_grade_updates(School* school, const char* file_name);
+void importExamResults(School* school);
+void menu();
 #endif //CHECKPOINT_STUDENT_MANAGEMENT_SYSTEM_H
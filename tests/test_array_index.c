@@ -0,0 +1,93 @@
+// Regression tests for the opt-in array index behind cJSON_GetArrayItem and cJSON_GetArraySize
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "test_common.h"
+
+// Every position, and the ones just outside, hold the same values as a walk of the children
+static void CheckMatchesWalk(const cJSON *array) {
+    int size = 0;
+    for (const cJSON *child = array->child; child != NULL; child = child->next) {
+        const cJSON *item = cJSON_GetArrayItem(array, size);
+        CHECK(item == child);
+        size++;
+    }
+    CHECK(cJSON_GetArraySize(array) == size);
+    CHECK(cJSON_GetArrayItem(array, size) == NULL);
+    CHECK(cJSON_GetArrayItem(array, -1) == NULL);
+}
+
+static void TestIndexFollowsChanges(void) {
+    cJSON *array = cJSON_CreateArray();
+    for (int i = 0; i < 100; i++) cJSON_AddItemToArray(array, cJSON_CreateNumber(i));
+
+    // Lookups alone never build an index
+    CheckMatchesWalk(array);
+    CHECK(array->index == NULL);
+
+    CHECK(cJSON_BuildIndex(array));
+    CheckMatchesWalk(array);
+    CHECK(cJSON_GetArrayItem(array, 73)->valueint == 73);
+
+    // Appends keep the index, growing it past its first capacity
+    for (int i = 100; i < 1000; i++) cJSON_AddItemToArray(array, cJSON_CreateNumber(i));
+    CHECK(array->index != NULL);
+    CheckMatchesWalk(array);
+
+    // Inserting, replacing and detaching drop it
+    CHECK(cJSON_InsertItemInArray(array, 10, cJSON_CreateNumber(-10)));
+    CHECK(array->index == NULL);
+    CHECK(cJSON_GetArrayItem(array, 10)->valueint == -10);
+    CHECK(cJSON_GetArrayItem(array, 11)->valueint == 10);
+    CheckMatchesWalk(array);
+
+    CHECK(cJSON_BuildIndex(array));
+    CHECK(cJSON_ReplaceItemInArray(array, 500, cJSON_CreateString("five hundred")));
+    CHECK(array->index == NULL);
+    CHECK(cJSON_IsString(cJSON_GetArrayItem(array, 500)));
+    CheckMatchesWalk(array);
+
+    CHECK(cJSON_BuildIndex(array));
+    cJSON_DeleteItemFromArray(array, 0);
+    CHECK(array->index == NULL);
+    CHECK(cJSON_GetArrayItem(array, 0)->valueint == 1);
+    CheckMatchesWalk(array);
+
+    // An emptied array can still be indexed
+    CHECK(cJSON_BuildIndex(array));
+    while (array->child != NULL) cJSON_DeleteItemFromArray(array, 0);
+    CHECK(cJSON_BuildIndex(array));
+    CHECK(cJSON_GetArraySize(array) == 0);
+    CHECK(cJSON_GetArrayItem(array, 0) == NULL);
+
+    cJSON_Delete(array);
+}
+
+// A parsed array reads the same with and without an index
+static void TestParsedArray(void) {
+    char document[8192];
+    char *out = document;
+    out += sprintf(out, "[");
+    for (int i = 0; i < 700; i++) out += sprintf(out, "%s%d", i ? "," : "", i * 3);
+    sprintf(out, "]");
+
+    cJSON *indexed = cJSON_Parse(document);
+    cJSON *plain = cJSON_Parse(document);
+    CHECK(indexed != NULL && plain != NULL);
+    CHECK(cJSON_BuildIndex(indexed));
+    CHECK(cJSON_GetArraySize(indexed) == cJSON_GetArraySize(plain));
+    for (int i = 0; i < 700; i++) {
+        CHECK(cJSON_GetArrayItem(indexed, i)->valueint == cJSON_GetArrayItem(plain, i)->valueint);
+    }
+    CHECK(plain->index == NULL);
+
+    cJSON_Delete(indexed);
+    cJSON_Delete(plain);
+}
+
+int main(void) {
+    TestIndexFollowsChanges();
+    TestParsedArray();
+    return TestsFinish();
+}
@@ -0,0 +1,143 @@
+// Regression tests for CBOR encoding, checked against RFC 8949 examples and JSON round trips
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "cJSON_CBOR.h"
+#include "test_common.h"
+
+static int SameBytes(const unsigned char *data, size_t length, const char *expected, size_t expectedLength) {
+    return data != NULL && length == expectedLength && memcmp(data, expected, length) == 0;
+}
+
+// Encodes the JSON text and compares with the expected bytes
+static void CheckEncoding(const char *json, const char *expected, size_t expectedLength) {
+    cJSON *item = cJSON_Parse(json);
+    size_t length = 0;
+    unsigned char *data = cJSONCBOR_Encode(item, &length);
+    CHECK(SameBytes(data, length, expected, expectedLength));
+    cJSON_free(data);
+    cJSON_Delete(item);
+}
+
+#define ENCODES(json, bytes) CheckEncoding(json, bytes, sizeof(bytes) - 1)
+
+static void TestKnownEncodings(void) {
+    ENCODES("0", "\x00");
+    ENCODES("23", "\x17");
+    ENCODES("24", "\x18\x18");
+    ENCODES("100", "\x18\x64");
+    ENCODES("1000", "\x19\x03\xe8");
+    ENCODES("1000000", "\x1a\x00\x0f\x42\x40");
+    ENCODES("-1", "\x20");
+    ENCODES("-1000", "\x39\x03\xe7");
+    ENCODES("1.5", "\xfa\x3f\xc0\x00\x00");
+    ENCODES("1.1", "\xfb\x3f\xf1\x99\x99\x99\x99\x99\x9a");
+    ENCODES("4294967296", "\xfa\x4f\x80\x00\x00");
+    ENCODES("true", "\xf5");
+    ENCODES("false", "\xf4");
+    ENCODES("null", "\xf6");
+    ENCODES("\"\"", "\x60");
+    ENCODES("\"IETF\"", "\x64\x49\x45\x54\x46");
+    ENCODES("[]", "\x80");
+    ENCODES("[1,[2,3]]", "\x82\x01\x82\x02\x03");
+    ENCODES("{\"a\":1,\"b\":[2,3]}", "\xa2\x61\x61\x01\x61\x62\x82\x02\x03");
+}
+
+// Decodes the bytes and compares with the JSON text
+static void CheckDecoding(const char *bytes, size_t length, const char *json) {
+    cJSON *decoded = cJSONCBOR_Decode((const unsigned char *)bytes, length);
+    cJSON *expected = cJSON_Parse(json);
+    CHECK(decoded != NULL && cJSON_Compare(decoded, expected, 1));
+    cJSON_Delete(expected);
+    cJSON_Delete(decoded);
+}
+
+#define DECODES(bytes, json) CheckDecoding(bytes, sizeof(bytes) - 1, json)
+
+static void TestKnownDecodings(void) {
+    DECODES("\xf9\x3c\x00", "1.0");
+    DECODES("\xf9\xc4\x00", "-4.0");
+    DECODES("\xf9\x00\x01", "5.9604644775390625e-8");
+    DECODES("\x3b\x00\x00\x00\x00\x00\x00\x00\x00", "-1");
+    DECODES("\x1b\x00\x00\x00\x02\x00\x00\x00\x00", "8589934592");
+    DECODES("\x9f\x01\x82\x02\x03\xff", "[1,[2,3]]");
+    DECODES("\xbf\x61\x61\x01\x61\x62\x9f\xff\xff", "{\"a\":1,\"b\":[]}");
+    DECODES("\x7f\x62\x73\x74\x62\x72\x65\xff", "\"stre\"");
+    DECODES("\xc1\x1a\x51\x4b\x67\xb0", "1363896240");
+    DECODES("\xf7", "null");
+}
+
+static void TestRejected(void) {
+    static const struct { const char *bytes; size_t length; } rejected[] = {
+        {"\x41\x00", 2},           // byte string
+        {"\xa1\x01\x01", 3},       // key that isn't text
+        {"\x62\x61\x00", 3},       // text with a NUL
+        {"\x01\x01", 2},           // two data items
+        {"\xff", 1},               // break outside an indefinite length item
+        {"\x1c", 1},               // reserved additional information
+        {"\x5f\xff", 2},           // indefinite byte string
+        {"\x7f\x41\x00\xff", 4},   // indefinite text with a byte string chunk
+    };
+    for (size_t i = 0; i < sizeof(rejected) / sizeof(rejected[0]); i++) {
+        CHECK(cJSONCBOR_Decode((const unsigned char *)rejected[i].bytes, rejected[i].length) == NULL);
+    }
+    CHECK(cJSONCBOR_Decode(NULL, 0) == NULL);
+
+    // Nesting past CJSON_NESTING_LIMIT
+    size_t depth = CJSON_NESTING_LIMIT + 1;
+    unsigned char *nested = malloc(depth + 1);
+    if (!nested) exit(1);
+    memset(nested, 0x81, depth);
+    nested[depth] = 0x00;
+    CHECK(cJSONCBOR_Decode(nested, depth + 1) == NULL);
+    free(nested);
+
+    // Raw items have no CBOR form
+    cJSON *raw = cJSON_CreateRaw("[1]");
+    size_t length = 0;
+    CHECK(cJSONCBOR_Encode(raw, &length) == NULL);
+    cJSON_Delete(raw);
+}
+
+static const char *Documents[] = {
+    "{\"Grade_Level\":3,\"CourseNumber\":7,\"students\":[{\"first_name\":\"Ada\",\"last_name\":\"Lovelace\","
+    "\"phone\":\"0501234567\",\"grades\":[90,85,77,100,64,88,91,73,99,80]}]}",
+    "[0,-0.5,0.1,1e300,-1e-300,2147483647,-2147483648,4294967295,-4294967297,3.4028234663852886e38]",
+    "{\"empty\":{},\"list\":[],\"text\":\"caf\\u00e9 \\ud83d\\ude00 \\\"quoted\\\"\",\"flags\":[true,false,null]}",
+    "\"a string long enough that its length needs a second byte in the CBOR header, which starts at 24 bytes\"",
+};
+
+// Every document survives a round trip, and every truncation of its encoding is rejected
+static void TestRoundTripsAndTruncation(void) {
+    for (size_t d = 0; d < sizeof(Documents) / sizeof(Documents[0]); d++) {
+        cJSON *item = cJSON_Parse(Documents[d]);
+        size_t length = 0;
+        unsigned char *data = cJSONCBOR_Encode(item, &length);
+        CHECK(data != NULL);
+
+        cJSON *decoded = cJSONCBOR_Decode(data, length);
+        CHECK(cJSON_Compare(decoded, item, 1));
+        cJSON_Delete(decoded);
+
+        for (size_t cut = 0; data != NULL && cut < length; cut++) {
+            // Its own allocation, so reading past the cut shows up under ASan
+            unsigned char *truncated = malloc(cut + 1);
+            if (!truncated) exit(1);
+            memcpy(truncated, data, cut);
+            CHECK(cJSONCBOR_Decode(truncated, cut) == NULL);
+            free(truncated);
+        }
+
+        cJSON_free(data);
+        cJSON_Delete(item);
+    }
+}
+
+int main(void) {
+    TestKnownEncodings();
+    TestKnownDecodings();
+    TestRejected();
+    TestRoundTripsAndTruncation();
+    return TestsFinish();
+}
@@ -0,0 +1,26 @@
+// Shared check macro for the regression tests, each test is a single translation unit
+#ifndef CHECKPOINT_TEST_COMMON_H
+#define CHECKPOINT_TEST_COMMON_H
+
+#include <stdio.h>
+
+static int Failures;
+
+#define CHECK(condition) do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            Failures++; \
+        } \
+    } while (0)
+
+// The exit code for main
+static int TestsFinish(void) {
+    if (Failures > 0) {
+        fprintf(stderr, "%d checks failed\n", Failures);
+        return 1;
+    }
+    printf("All checks passed\n");
+    return 0;
+}
+
+#endif //CHECKPOINT_TEST_COMMON_H
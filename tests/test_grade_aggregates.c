@@ -0,0 +1,182 @@
+// Regression tests for the grade aggregates, checked against totals recomputed from every student
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "student_management_system.h"
+#include "grade_aggregates.h"
+#include "test_common.h"
+
+#define STUDENTS 400
+
+static Student Students[STUDENTS];
+static int Counted[STUDENTS];
+static unsigned int Seed = 12345;
+
+static int Random(int bound) {
+    Seed = Seed * 1103515245u + 12345u;
+    return (int)((Seed >> 16) % (unsigned int)bound);
+}
+
+static GradeTotals ScanTotals(int grade, int class, int course) {
+    GradeTotals totals = {0, 0, 0, 0, 0};
+    for (int i = 0; i < STUDENTS; i++) {
+        const Student *student = &Students[i];
+        if (!Counted[i] || (grade && student->grade != grade) || (class && student->class != class)) continue;
+        int value = student->grades[course];
+        if (totals.count == 0 || value < totals.min) totals.min = value;
+        if (totals.count == 0 || value > totals.max) totals.max = value;
+        totals.sum += value;
+        totals.sumOfSquares += (long long)value * value;
+        totals.count++;
+    }
+    return totals;
+}
+
+static int SameTotals(GradeTotals a, GradeTotals b) {
+    if (a.count != b.count || a.sum != b.sum || a.sumOfSquares != b.sumOfSquares) return 0;
+    return a.count == 0 || (a.min == b.min && a.max == b.max);
+}
+
+// Every grade level, class and course, including the "all of them" rows
+static void CheckAllQueries(const GradeAggregates *aggregates) {
+    for (int grade = 0; grade <= MAX_GRADES; grade++) {
+        for (int class = 0; class <= MAX_CLASSES; class++) {
+            for (int course = 0; course < SUBJECTS; course++) {
+                CHECK(SameTotals(AggregatesQuery(aggregates, grade, class, course), ScanTotals(grade, class, course)));
+            }
+        }
+    }
+}
+
+static void Count(GradeAggregates *aggregates, int i) {
+    CHECK(AggregatesReserve(aggregates, Students[i].grade, Students[i].class));
+    AggregatesAdd(aggregates, &Students[i]);
+    Counted[i] = 1;
+}
+
+static void TestRandomChanges(void) {
+    GradeAggregates *aggregates = AggregatesCreate();
+    for (int i = 0; i < STUDENTS; i++) {
+        // Few classes, so removals often take out a class's minimum or maximum
+        Students[i].grade = Random(3) + 1;
+        Students[i].class = Random(2) + 1;
+        for (int course = 0; course < SUBJECTS; course++) Students[i].grades[course] = Random(101);
+        Count(aggregates, i);
+    }
+    CheckAllQueries(aggregates);
+
+    for (int round = 0; round < 20; round++) {
+        for (int step = 0; step < 60; step++) {
+            int i = Random(STUDENTS);
+            if (!Counted[i]) {
+                Count(aggregates, i);
+            } else if (Random(2)) {
+                AggregatesRemove(aggregates, &Students[i]);
+                Counted[i] = 0;
+            } else {
+                int course = Random(SUBJECTS);
+                int old = Students[i].grades[course];
+                // Mostly to the ends of the range, so the minimum and maximum move both ways
+                Students[i].grades[course] = Random(3) ? Random(2) * 100 : Random(101);
+                AggregatesChange(aggregates, &Students[i], course, old);
+            }
+        }
+        CheckAllQueries(aggregates);
+    }
+
+    AggregatesFree(aggregates);
+}
+
+static void TestMinMaxAfterRemovals(void) {
+    GradeAggregates *aggregates = AggregatesCreate();
+    Student students[4];
+    memset(students, 0, sizeof(students));
+    static const int grades[] = {50, 70, 90, 90};
+    for (int i = 0; i < 4; i++) {
+        students[i].grade = 1;
+        students[i].class = 1;
+        students[i].grades[0] = grades[i];
+        CHECK(AggregatesReserve(aggregates, 1, 1));
+        AggregatesAdd(aggregates, &students[i]);
+    }
+
+    GradeTotals totals = AggregatesQuery(aggregates, 1, 1, 0);
+    CHECK(totals.count == 4 && totals.min == 50 && totals.max == 90);
+    CHECK(AggregatesMean(&totals) == 75.0);
+    CHECK(fabs(AggregatesVariance(&totals) - 275.0) < 1e-9);
+
+    // One of two maximums goes, the other one stays
+    AggregatesRemove(aggregates, &students[3]);
+    totals = AggregatesQuery(aggregates, 0, 0, 0);
+    CHECK(totals.count == 3 && totals.min == 50 && totals.max == 90);
+    AggregatesRemove(aggregates, &students[2]);
+    totals = AggregatesQuery(aggregates, 1, 0, 0);
+    CHECK(totals.count == 2 && totals.min == 50 && totals.max == 70);
+    AggregatesRemove(aggregates, &students[0]);
+    totals = AggregatesQuery(aggregates, 0, 1, 0);
+    CHECK(totals.count == 1 && totals.min == 70 && totals.max == 70);
+    CHECK(AggregatesStdDev(&totals) == 0.0);
+
+    // A grade change past the other end
+    int old = students[1].grades[0];
+    students[1].grades[0] = 0;
+    AggregatesChange(aggregates, &students[1], 0, old);
+    totals = AggregatesQuery(aggregates, 1, 1, 0);
+    CHECK(totals.count == 1 && totals.min == 0 && totals.max == 0);
+
+    AggregatesRemove(aggregates, &students[1]);
+    totals = AggregatesQuery(aggregates, 1, 1, 0);
+    CHECK(totals.count == 0 && totals.sum == 0);
+    CHECK(AggregatesMean(&totals) == 0.0);
+    CHECK(AggregatesQuery(aggregates, 5, 5, 0).count == 0);
+
+    AggregatesFree(aggregates);
+}
+
+// The school keeps its aggregates in step with inserts and imported grades
+static void TestSchool(void) {
+    School *school = create_school();
+    Student *students[30];
+    for (int i = 0; i < 30; i++) {
+        students[i] = calloc(1, sizeof(Student));
+        if (!students[i]) exit(1);
+        snprintf(students[i]->first_name, MAX_NAME, "First%d", i);
+        snprintf(students[i]->last_name, MAX_NAME, "Last%d", i);
+        snprintf(students[i]->phone, MAX_PHONE, "05000000%02d", i);
+        students[i]->grade = i % 2 + 1;
+        students[i]->class = i % 3 + 1;
+        for (int course = 0; course < SUBJECTS; course++) students[i]->grades[course] = (i * 7 + course * 13) % 101;
+    }
+    CHECK(insert_students(school, students, 30) == 30);
+
+    GradeUpdate updates[] = {{"First4", "Last4", 1, 100}, {"First10", "Last10", 1, 0}, {"First4", "Last4", 10, 3}};
+    CHECK(apply_grade_updates(school, updates, 3) == 3);
+
+    for (int course = 0; course < SUBJECTS; course++) {
+        for (int grade = 0; grade <= 2; grade++) {
+            for (int class = 0; class <= 3; class++) {
+                GradeTotals expected = {0, 0, 0, 0, 0};
+                for (int i = 0; i < 30; i++) {
+                    if ((grade && students[i]->grade != grade) || (class && students[i]->class != class)) continue;
+                    int value = students[i]->grades[course];
+                    if (expected.count == 0 || value < expected.min) expected.min = value;
+                    if (expected.count == 0 || value > expected.max) expected.max = value;
+                    expected.sum += value;
+                    expected.sumOfSquares += (long long)value * value;
+                    expected.count++;
+                }
+                CHECK(SameTotals(AggregatesQuery(school->aggregates, grade, class, course), expected));
+            }
+        }
+    }
+
+    destroySchool(school);
+}
+
+int main(void) {
+    TestRandomChanges();
+    TestMinMaxAfterRemovals();
+    TestSchool();
+    return TestsFinish();
+}
@@ -0,0 +1,95 @@
+// Regression tests for apply_grade_updates and the heap repair behind it
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "student_management_system.h"
+#include "FixedSizeHeap.h"
+#include "test_common.h"
+
+static Student *NewStudent(const char *first, const char *last, const char *phone, int grade) {
+    Student *student = calloc(1, sizeof(Student));
+    if (!student) exit(1);
+    snprintf(student->first_name, MAX_NAME, "%s", first);
+    snprintf(student->last_name, MAX_NAME, "%s", last);
+    snprintf(student->phone, MAX_PHONE, "%s", phone);
+    student->grade = 1;
+    student->class = 1;
+    student->grades[0] = grade;
+    return student;
+}
+
+// Whether the heap holds exactly the best course 0 grades of grade level 1, class 1
+static int HoldsTopTen(School *school, const FixedSizeMaxHeap *heap) {
+    Class *class = &school->grades[0].classes[0];
+    int grades[64];
+    for (int i = 0; i < class->num_students; i++) grades[i] = class->students[i]->grades[0];
+    // Highest first
+    for (int i = 1; i < class->num_students; i++) {
+        for (int j = i; j > 0 && grades[j - 1] < grades[j]; j--) {
+            int swap = grades[j];
+            grades[j] = grades[j - 1];
+            grades[j - 1] = swap;
+        }
+    }
+
+    int expected = class->num_students < MaxSize ? class->num_students : MaxSize;
+    if (heap->FilledIndex != expected) return 0;
+    for (int i = 0; i < expected; i++) {
+        if (heap->students[i].grades[0] != grades[i]) return 0;
+    }
+    return 1;
+}
+
+static int Ranks(const FixedSizeMaxHeap *heap, const char *phone) {
+    for (int i = 0; i < heap->FilledIndex; i++) {
+        if (strcmp(heap->students[i].phone, phone) == 0) return 1;
+    }
+    return 0;
+}
+
+// Two ranked students share a name and only one of them gets a new grade
+static void TestDuplicateNames(void) {
+    School *school = create_school();
+    Student *students[20];
+    for (int i = 0; i < 18; i++) {
+        char first[MAX_NAME], phone[MAX_PHONE];
+        snprintf(first, sizeof(first), "Student%d", i);
+        snprintf(phone, sizeof(phone), "05000000%02d", i);
+        students[i] = NewStudent(first, "Levi", phone, 40 + 2 * i);
+    }
+    students[18] = NewStudent("Dan", "Cohen", "0521111111", 90);
+    students[19] = NewStudent("Dan", "Cohen", "0522222222", 90);
+    int inserted = insert_students(school, students, 20);
+    rank_students(school, students, inserted);
+    CHECK(inserted == 20);
+
+    FixedSizeMaxHeap *heap = school->heaps[0][0];
+    CHECK(heap != NULL && HoldsTopTen(school, heap));
+
+    // find returns one of the two, the other one has to stay ranked
+    GradeUpdate update = {"Dan", "Cohen", 1, 95};
+    CHECK(apply_grade_updates(school, &update, 1) == 1);
+    CHECK(HoldsTopTen(school, heap));
+    CHECK(Ranks(heap, "0521111111") && Ranks(heap, "0522222222"));
+    CHECK(heap->overall_grade == 18 * 40 + 2 * (17 * 18 / 2) + 90 + 95 && heap->studentsCount == 20);
+
+    // Dropping one of them below the top ten pulls the next best student in
+    update.grade = 10;
+    CHECK(apply_grade_updates(school, &update, 1) == 1);
+    CHECK(HoldsTopTen(school, heap));
+
+    // A new phone keeps the ranked copy recognizable
+    Student *dan = find(school, "Dan", "Cohen");
+    update_student_phone(school, dan, "0533333333");
+    update.grade = 99;
+    CHECK(apply_grade_updates(school, &update, 1) == 1);
+    CHECK(HoldsTopTen(school, heap));
+    CHECK(Ranks(heap, "0533333333"));
+
+    destroySchool(school);
+}
+
+int main(void) {
+    TestDuplicateNames();
+    return TestsFinish();
+}
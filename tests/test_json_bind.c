@@ -0,0 +1,134 @@
+// Regression tests for field descriptor binding, checked against decoding by hand
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <stddef.h>
+#include "cJSON.h"
+#include "cJSON_Bind.h"
+#include "test_common.h"
+
+typedef struct {
+    int count;
+    double average;
+    cJSON_bool active;
+    char name[8];
+    int grades[4];
+} Record;
+
+static const cJSONBind_Field RecordFields[] = {
+    {"count", offsetof(Record, count), cJSONBind_Int, 0},
+    {"average", offsetof(Record, average), cJSONBind_Double, 0},
+    {"active", offsetof(Record, active), cJSONBind_Bool, 0},
+    {"name", offsetof(Record, name), cJSONBind_String, sizeof(((Record *)0)->name)},
+    {"grades", offsetof(Record, grades), cJSONBind_IntArray, 4},
+};
+
+#define RECORD_FIELDS (sizeof(RecordFields) / sizeof(RecordFields[0]))
+
+// The lookups the loaders used before binding
+static void DecodeByHand(const cJSON *object, Record *record) {
+    const cJSON *item = cJSON_GetObjectItemCaseSensitive(object, "count");
+    if (cJSON_IsNumber(item)) record->count = item->valueint;
+    item = cJSON_GetObjectItemCaseSensitive(object, "average");
+    if (cJSON_IsNumber(item)) record->average = item->valuedouble;
+    item = cJSON_GetObjectItemCaseSensitive(object, "active");
+    if (cJSON_IsBool(item)) record->active = cJSON_IsTrue(item);
+    item = cJSON_GetObjectItemCaseSensitive(object, "name");
+    if (cJSON_IsString(item)) {
+        strncpy(record->name, item->valuestring, sizeof(record->name) - 1);
+        record->name[sizeof(record->name) - 1] = '\0';
+    }
+    item = cJSON_GetObjectItemCaseSensitive(object, "grades");
+    for (int i = 0; cJSON_IsArray(item) && i < 4 && i < cJSON_GetArraySize(item); i++) {
+        record->grades[i] = cJSON_GetArrayItem(item, i)->valueint;
+    }
+}
+
+static void CheckSameRecord(const Record *a, const Record *b) {
+    CHECK(a->count == b->count);
+    CHECK(a->average == b->average);
+    CHECK(a->active == b->active);
+    CHECK(strcmp(a->name, b->name) == 0);
+    CHECK(memcmp(a->grades, b->grades, sizeof(a->grades)) == 0);
+}
+
+static const char *Documents[] = {
+    "{\"count\":3,\"average\":81.5,\"active\":true,\"name\":\"Ada\",\"grades\":[90,85,77,100]}",
+    "{\"grades\":[1,2],\"name\":\"Lovelace, a name longer than the buffer\",\"unknown\":[1],\"count\":-7}",
+    "{\"count\":1e20,\"average\":-1e300,\"grades\":[1,2,3,4,5,6,7],\"active\":false}",
+    "{\"count\":-1e20,\"grades\":[2.9,-2.9,2147483648,-2147483649]}",
+    "{}",
+};
+
+static void TestMatchesHandDecoding(void) {
+    for (size_t d = 0; d < sizeof(Documents) / sizeof(Documents[0]); d++) {
+        cJSON *object = cJSON_Parse(Documents[d]);
+        Record bound, byHand;
+        memset(&bound, 0, sizeof(bound));
+        memset(&byHand, 0, sizeof(byHand));
+        CHECK(cJSONBind_DecodeObject(object, RecordFields, RECORD_FIELDS, &bound));
+        DecodeByHand(object, &byHand);
+        CheckSameRecord(&bound, &byHand);
+        cJSON_Delete(object);
+    }
+
+    // Saturated like valueint, truncated to the buffer
+    cJSON *object = cJSON_Parse(Documents[2]);
+    Record record;
+    memset(&record, 0, sizeof(record));
+    cJSONBind_DecodeObject(object, RecordFields, RECORD_FIELDS, &record);
+    CHECK(record.count == INT_MAX);
+    CHECK(record.grades[3] == 4);
+    cJSON_Delete(object);
+}
+
+// A member of the wrong type fails the decode, the others are still decoded
+static void TestWrongTypes(void) {
+    cJSON *object = cJSON_Parse("{\"count\":\"three\",\"name\":\"Ada\",\"grades\":[1,\"x\",3],\"active\":1}");
+    Record record;
+    memset(&record, 0, sizeof(record));
+    CHECK(!cJSONBind_DecodeObject(object, RecordFields, RECORD_FIELDS, &record));
+    CHECK(record.count == 0);
+    CHECK(record.active == 0);
+    CHECK(strcmp(record.name, "Ada") == 0);
+    CHECK(record.grades[0] == 1);
+    cJSON_Delete(object);
+
+    object = cJSON_Parse("[1]");
+    CHECK(!cJSONBind_DecodeObject(object, RecordFields, RECORD_FIELDS, &record));
+    cJSON_Delete(object);
+}
+
+static void TestSetters(void) {
+    Record record;
+    memset(&record, 0, sizeof(record));
+
+    const cJSONBind_Field *count = cJSONBind_FindField(RecordFields, RECORD_FIELDS, "count");
+    const cJSONBind_Field *name = cJSONBind_FindField(RecordFields, RECORD_FIELDS, "name");
+    const cJSONBind_Field *grades = cJSONBind_FindField(RecordFields, RECORD_FIELDS, "grades");
+    CHECK(count == &RecordFields[0]);
+    CHECK(cJSONBind_FindField(RecordFields, RECORD_FIELDS, "Count") == NULL);
+    CHECK(cJSONBind_FindField(RecordFields, RECORD_FIELDS, "missing") == NULL);
+
+    CHECK(cJSONBind_SetNumber(count, &record, 12.7));
+    CHECK(record.count == 12);
+    CHECK(!cJSONBind_SetNumber(name, &record, 1));
+    CHECK(!cJSONBind_SetString(count, &record, "x"));
+    CHECK(!cJSONBind_SetBool(count, &record, 1));
+    CHECK(cJSONBind_SetString(name, &record, "exactly"));
+    CHECK(strcmp(record.name, "exactly") == 0);
+    CHECK(cJSONBind_SetString(name, &record, "overflowing"));
+    CHECK(strcmp(record.name, "overflo") == 0);
+    CHECK(cJSONBind_SetArrayNumber(grades, &record, 3, 99));
+    CHECK(record.grades[3] == 99);
+    CHECK(!cJSONBind_SetArrayNumber(grades, &record, 4, 99));
+    CHECK(!cJSONBind_SetArrayNumber(count, &record, 0, 99));
+}
+
+int main(void) {
+    TestMatchesHandDecoding();
+    TestWrongTypes();
+    TestSetters();
+    return TestsFinish();
+}
@@ -0,0 +1,138 @@
+// Regression tests for cJSON_Context, checked against the global parse and print functions
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "test_common.h"
+
+static int GlobalBlocks;
+static int ContextBlocks;
+
+static void *GlobalMalloc(size_t size) {
+    GlobalBlocks++;
+    return malloc(size);
+}
+
+static void GlobalFree(void *pointer) {
+    if (pointer) GlobalBlocks--;
+    free(pointer);
+}
+
+static void *ContextMalloc(size_t size) {
+    ContextBlocks++;
+    return malloc(size);
+}
+
+static void ContextFree(void *pointer) {
+    if (pointer) ContextBlocks--;
+    free(pointer);
+}
+
+static const char Document[] = "{\"students\":[{\"name\":\"Ada\",\"grades\":[90,85.5,-3e-7]},{\"name\":\"Alan\",\"active\":true}],\"note\":null}";
+
+// Parsing, printing and deleting only go through the context's hooks, and give what the global functions give
+static void TestSameResultsOwnHooks(void) {
+    cJSON_Hooks global = {GlobalMalloc, GlobalFree};
+    cJSON_Hooks hooks = {ContextMalloc, ContextFree};
+    cJSON_InitHooks(&global);
+
+    cJSON *expected = cJSON_Parse(Document);
+    char *expectedText = cJSON_PrintUnformatted(expected);
+    char *expectedFormatted = cJSON_Print(expected);
+    int globalBlocks = GlobalBlocks;
+
+    cJSON_Context *context = cJSON_CreateContext(&hooks, 0);
+    cJSON_Context *formatting = cJSON_CreateContext(&hooks, cJSON_ContextFormat);
+    CHECK(context != NULL && formatting != NULL);
+    cJSON *item = cJSON_ContextParse(context, Document);
+    CHECK(cJSON_Compare(item, expected, 1));
+
+    char *printed = cJSON_ContextPrint(context, item);
+    CHECK(printed != NULL && strcmp(printed, expectedText) == 0);
+    cJSON_ContextFree(context, printed);
+    printed = cJSON_ContextPrint(formatting, item);
+    CHECK(printed != NULL && strcmp(printed, expectedFormatted) == 0);
+    cJSON_ContextFree(formatting, printed);
+
+    cJSON_ContextDelete(context, item);
+    CHECK(GlobalBlocks == globalBlocks);
+    cJSON_DeleteContext(formatting);
+    cJSON_DeleteContext(context);
+    CHECK(ContextBlocks == 0);
+
+    cJSON_free(expectedFormatted);
+    cJSON_free(expectedText);
+    cJSON_Delete(expected);
+    CHECK(GlobalBlocks == 0);
+    cJSON_InitHooks(NULL);
+}
+
+// Each context keeps its own error position, and none of them touches cJSON_GetErrorPtr
+static void TestErrorsStayInContext(void) {
+    static const char first[] = "[1,2,?]";
+    static const char second[] = "{\"a\" 1}";
+    static const char global[] = "[x]";
+
+    CHECK(cJSON_Parse(global) == NULL);
+    const char *globalError = cJSON_GetErrorPtr();
+    CHECK(globalError == global + 1);
+
+    cJSON_Context *a = cJSON_CreateContext(NULL, 0);
+    cJSON_Context *b = cJSON_CreateContext(NULL, 0);
+    CHECK(cJSON_ContextParse(a, first) == NULL);
+    CHECK(cJSON_ContextParse(b, second) == NULL);
+    CHECK(cJSON_ContextGetErrorPtr(a) == first + 5);
+    CHECK(cJSON_ContextGetErrorPtr(b) == second + 5);
+    CHECK(cJSON_GetErrorPtr() == globalError);
+
+    // Same position as the global parser reports
+    CHECK(cJSON_Parse(second) == NULL);
+    CHECK(cJSON_GetErrorPtr() == cJSON_ContextGetErrorPtr(b));
+
+    // A successful parse clears it
+    cJSON *item = cJSON_ContextParse(a, "[1]");
+    CHECK(item != NULL && cJSON_ContextGetErrorPtr(a) == NULL);
+    CHECK(cJSON_ContextGetErrorPtr(b) == second + 5);
+    cJSON_ContextDelete(a, item);
+
+    cJSON_DeleteContext(b);
+    cJSON_DeleteContext(a);
+}
+
+static void TestOptions(void) {
+    static const char trailing[] = "[1] trailing";
+    const char *end = NULL;
+
+    cJSON_Context *lenient = cJSON_CreateContext(NULL, 0);
+    cJSON_Context *strict = cJSON_CreateContext(NULL, cJSON_ContextRequireNullTerminated);
+
+    cJSON *item = cJSON_ContextParse(lenient, trailing);
+    CHECK(item != NULL);
+    cJSON_ContextDelete(lenient, item);
+    CHECK(cJSON_ContextParse(strict, trailing) == NULL);
+
+    // Length limited input that isn't null terminated, and where the parse ended
+    item = cJSON_ContextParseWithLengthOpts(lenient, "[1,2]garbage", 5, &end);
+    CHECK(cJSON_GetArraySize(item) == 2);
+    CHECK(end != NULL && strncmp(end, "garbage", 7) == 0);
+    cJSON_ContextDelete(lenient, item);
+    item = cJSON_ContextParseWithLength(lenient, "[1,2]garbage", 4);
+    CHECK(item == NULL);
+
+    CHECK(cJSON_ContextParse(NULL, "[1]") == NULL);
+    CHECK(cJSON_ContextParse(lenient, NULL) == NULL);
+    CHECK(cJSON_ContextPrint(lenient, NULL) == NULL);
+    cJSON_ContextDelete(lenient, NULL);
+    cJSON_ContextFree(lenient, NULL);
+    cJSON_DeleteContext(NULL);
+
+    cJSON_DeleteContext(strict);
+    cJSON_DeleteContext(lenient);
+}
+
+int main(void) {
+    TestSameResultsOwnHooks();
+    TestErrorsStayInContext();
+    TestOptions();
+    return TestsFinish();
+}
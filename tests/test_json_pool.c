@@ -0,0 +1,110 @@
+// Regression tests for the pooled allocator, checked against parsing with malloc
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "cJSON.h"
+#include "cJSON_Pool.h"
+#include "cJSON_Parallel.h"
+#include "test_common.h"
+
+#define BLOCKS 5000
+
+// Blocks of every size around the size classes never overlap, are aligned and report a size that fits the request
+static void TestBlocks(void) {
+    cJSON_Hooks hooks;
+    cJSONPool_GetHooks(&hooks);
+    static unsigned char *blocks[BLOCKS];
+    static size_t sizes[BLOCKS];
+
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < BLOCKS; i++) {
+            sizes[i] = (size_t)(i % 300) + 1;
+            blocks[i] = hooks.malloc_fn(sizes[i]);
+            CHECK(blocks[i] != NULL);
+            CHECK((uintptr_t)blocks[i] % sizeof(void *) == 0);
+            CHECK(cJSONPool_BlockSize(blocks[i]) >= sizes[i]);
+            // Past the largest class the size is exactly what was asked for
+            CHECK(sizes[i] <= 128 || cJSONPool_BlockSize(blocks[i]) == sizes[i]);
+            memset(blocks[i], i & 0xff, sizes[i]);
+        }
+        for (int i = 0; i < BLOCKS; i++) {
+            size_t intact = 0;
+            while (intact < sizes[i] && blocks[i][intact] == (unsigned char)(i & 0xff)) intact++;
+            CHECK(intact == sizes[i]);
+        }
+        // Free every other block first, so the next round mixes reused and fresh blocks
+        for (int i = 0; i < BLOCKS; i += 2) hooks.free_fn(blocks[i]);
+        for (int i = 1; i < BLOCKS; i += 2) hooks.free_fn(blocks[i]);
+    }
+
+    CHECK(cJSONPool_BlockSize(NULL) == 0);
+    hooks.free_fn(NULL);
+}
+
+// Rounded up to the 16 byte granularity, so a cJSON node lands in one class
+static void TestSizeClasses(void) {
+    cJSON_Hooks hooks;
+    cJSONPool_GetHooks(&hooks);
+    static const size_t requests[] = {1, 16, 17, 72, 80, 127, 128, 129, 4096};
+    static const size_t expected[] = {16, 16, 32, 80, 80, 128, 128, 129, 4096};
+    for (size_t i = 0; i < sizeof(requests) / sizeof(requests[0]); i++) {
+        void *block = hooks.malloc_fn(requests[i]);
+        CHECK(cJSONPool_BlockSize(block) == expected[i]);
+        hooks.free_fn(block);
+    }
+}
+
+static char *NewDocument(size_t *length) {
+    size_t capacity = 4000 * 300;
+    char *document = malloc(capacity);
+    if (!document) exit(1);
+    size_t used = (size_t)sprintf(document, "[");
+    for (int i = 0; i < 4000; i++) {
+        used += (size_t)sprintf(document + used, "%s{\"name\":\"student number %d\",\"grades\":[%d,%d],\"note\":\"%.*s\"}",
+                                i ? "," : "", i, i % 101, (i * 3) % 101, i % 200, "a note long enough to leave the size classes, a note long enough to leave the size classes, a note long enough to leave the size classes, a note long enough to leave the size classes");
+    }
+    used += (size_t)sprintf(document + used, "]");
+    *length = used;
+    return document;
+}
+
+// Trees allocated through the pool on several threads and freed on this one match trees allocated with malloc
+static void TestTreesThroughPool(void) {
+    size_t length = 0;
+    char *document = NewDocument(&length);
+
+    cJSON *expected = cJSON_ParseWithLength(document, length);
+    char *expectedText = cJSON_PrintUnformatted(expected);
+    CHECK(expectedText != NULL);
+
+    cJSON_Hooks hooks;
+    cJSONPool_GetHooks(&hooks);
+    cJSON_InitHooks(&hooks);
+    for (int round = 0; round < 3; round++) {
+        cJSON *pooled = cJSONParallel_ParseArray(document, length, 4);
+        char *pooledText = cJSON_PrintUnformatted(pooled);
+        CHECK(pooledText != NULL && expectedText != NULL && strcmp(pooledText, expectedText) == 0);
+        cJSON_free(pooledText);
+        cJSON_Delete(pooled);
+    }
+
+    // The pool's hooks also work for a context
+    cJSON_Context *context = cJSON_CreateContext(&hooks, 0);
+    cJSON *item = cJSON_ContextParse(context, "{\"a\":[1,2,3],\"b\":\"text\"}");
+    CHECK(cJSON_GetArraySize(cJSON_GetObjectItem(item, "a")) == 3);
+    cJSON_ContextDelete(context, item);
+    cJSON_DeleteContext(context);
+    cJSON_InitHooks(NULL);
+
+    cJSON_free(expectedText);
+    cJSON_Delete(expected);
+    free(document);
+}
+
+int main(void) {
+    TestBlocks();
+    TestSizeClasses();
+    TestTreesThroughPool();
+    return TestsFinish();
+}
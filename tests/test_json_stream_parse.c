@@ -0,0 +1,222 @@
+// Regression tests for the chunked streaming parser, checked against cJSON_Parse
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "cJSON_Stream.h"
+#include "test_common.h"
+
+// Builds a cJSON tree from the parser's callbacks, so it can be compared with cJSON_Parse
+typedef struct {
+    cJSON *root;
+    cJSON *stack[64];
+    int depth;
+    char key[256];
+    int hasKey;
+} TreeBuilder;
+
+static cJSON_bool AddValue(TreeBuilder *builder, cJSON *value) {
+    if (!value) return 0;
+    if (builder->depth == 0) {
+        if (builder->root) {
+            cJSON_Delete(value);
+            return 0;
+        }
+        builder->root = value;
+    } else if (cJSON_IsObject(builder->stack[builder->depth - 1])) {
+        if (!builder->hasKey) {
+            cJSON_Delete(value);
+            return 0;
+        }
+        cJSON_AddItemToObject(builder->stack[builder->depth - 1], builder->key, value);
+        builder->hasKey = 0;
+    } else {
+        cJSON_AddItemToArray(builder->stack[builder->depth - 1], value);
+    }
+    return 1;
+}
+
+static cJSON_bool StartContainer(TreeBuilder *builder, cJSON *container) {
+    if (builder->depth == 64 || !AddValue(builder, container)) return 0;
+    builder->stack[builder->depth++] = container;
+    return 1;
+}
+
+static cJSON_bool OnStartObject(void *user_data) {
+    return StartContainer(user_data, cJSON_CreateObject());
+}
+
+static cJSON_bool OnStartArray(void *user_data) {
+    return StartContainer(user_data, cJSON_CreateArray());
+}
+
+static cJSON_bool OnEnd(void *user_data) {
+    TreeBuilder *builder = user_data;
+    if (builder->depth == 0) return 0;
+    builder->depth--;
+    return 1;
+}
+
+static cJSON_bool OnKey(void *user_data, const char *key, size_t length) {
+    TreeBuilder *builder = user_data;
+    if (length != strlen(key) || length >= sizeof(builder->key)) return 0;
+    memcpy(builder->key, key, length + 1);
+    builder->hasKey = 1;
+    return 1;
+}
+
+static cJSON_bool OnString(void *user_data, const char *string, size_t length) {
+    if (length != strlen(string)) return 0;
+    return AddValue(user_data, cJSON_CreateString(string));
+}
+
+static cJSON_bool OnNumber(void *user_data, double number) {
+    return AddValue(user_data, cJSON_CreateNumber(number));
+}
+
+static cJSON_bool OnBoolean(void *user_data, cJSON_bool boolean) {
+    return AddValue(user_data, cJSON_CreateBool(boolean));
+}
+
+static cJSON_bool OnNull(void *user_data) {
+    return AddValue(user_data, cJSON_CreateNull());
+}
+
+static const cJSON_StreamHandler Builder = {
+    OnStartObject, OnEnd, OnStartArray, OnEnd, OnKey, OnString, OnNumber, OnBoolean, OnNull
+};
+
+// Feeds document in chunks of chunkSize bytes, returns the tree or NULL if the parse failed
+static cJSON *StreamParse(const char *document, size_t chunkSize, size_t *errorOffset) {
+    TreeBuilder builder;
+    memset(&builder, 0, sizeof(builder));
+    cJSON_StreamParser *parser = cJSONStream_CreateParser(&Builder, &builder);
+    if (!parser) exit(1);
+
+    size_t length = strlen(document);
+    cJSON_bool ok = 1;
+    for (size_t offset = 0; ok && offset < length; offset += chunkSize) {
+        size_t size = length - offset < chunkSize ? length - offset : chunkSize;
+        // Every chunk in its own allocation, so nothing may be read past its end
+        char *chunk = malloc(size);
+        if (!chunk) exit(1);
+        memcpy(chunk, document + offset, size);
+        ok = cJSONStream_Feed(parser, chunk, size);
+        free(chunk);
+    }
+    ok = ok && cJSONStream_Finish(parser);
+    *errorOffset = cJSONStream_GetErrorOffset(parser);
+    cJSONStream_DeleteParser(parser);
+
+    if (!ok) {
+        cJSON_Delete(builder.root);
+        return NULL;
+    }
+    return builder.root;
+}
+
+static const char *ValidDocuments[] = {
+    "{}",
+    "[]",
+    "0",
+    "-12.5e3",
+    "\"top level\"",
+    "true",
+    "null",
+    "  [ 1 , 2.25 , -0 , 1E10 , 3e-7 , 123456789012 ]  ",
+    "{\"a\":{\"b\":[{},[],{\"c\":null}]},\"d\":[true,false]}",
+    "{\"escapes\":\"q\\\" b\\\\ s\\/ \\b\\f\\n\\r\\t \\u00e9 \\ud83d\\ude00\",\"\\u0041key\":1}",
+    "[\"a string that is comfortably longer than the smallest chunk sizes used here\",\n\t\"second\"]",
+    "{\"students\":[{\"first_name\":\"Ada\",\"grades\":[90,85,77,100,64,88,91,73,99,80]},"
+    "{\"first_name\":\"Alan\",\"grades\":[70,65,97,100,84,58,91,83,79,60]}]}",
+};
+
+static const char *InvalidDocuments[] = {
+    "",
+    "   ",
+    "[1,]",
+    "[1 2]",
+    "{\"a\"}",
+    "{\"a\":}",
+    "{\"a\":1,}",
+    "{1:2}",
+    "[\"unterminated]",
+    "[tru]",
+    "nul",
+    "[1]]",
+    "[1] [2]",
+    "{\"a\":1} x",
+    "[-]",
+    "\"bad \\x escape\"",
+};
+
+static void TestMatchesParse(void) {
+    static const size_t chunkSizes[] = {1, 2, 3, 7, 16, 4096};
+    for (size_t d = 0; d < sizeof(ValidDocuments) / sizeof(ValidDocuments[0]); d++) {
+        cJSON *expected = cJSON_ParseWithOpts(ValidDocuments[d], NULL, 1);
+        char *expectedText = cJSON_PrintUnformatted(expected);
+        CHECK(expectedText != NULL);
+
+        for (size_t c = 0; c < sizeof(chunkSizes) / sizeof(chunkSizes[0]); c++) {
+            size_t errorOffset = 0;
+            cJSON *streamed = StreamParse(ValidDocuments[d], chunkSizes[c], &errorOffset);
+            char *streamedText = streamed ? cJSON_PrintUnformatted(streamed) : NULL;
+            CHECK(streamedText != NULL && expectedText != NULL && strcmp(streamedText, expectedText) == 0);
+            CHECK(cJSON_Compare(streamed, expected, 1));
+            cJSON_free(streamedText);
+            cJSON_Delete(streamed);
+        }
+
+        cJSON_free(expectedText);
+        cJSON_Delete(expected);
+    }
+}
+
+static void TestRejectsWhatParseRejects(void) {
+    for (size_t d = 0; d < sizeof(InvalidDocuments) / sizeof(InvalidDocuments[0]); d++) {
+        const char *document = InvalidDocuments[d];
+        CHECK(cJSON_ParseWithOpts(document, NULL, 1) == NULL);
+        for (size_t chunkSize = 1; chunkSize < 5; chunkSize++) {
+            size_t errorOffset = 0;
+            cJSON *streamed = StreamParse(document, chunkSize, &errorOffset);
+            CHECK(streamed == NULL);
+            CHECK(errorOffset <= strlen(document));
+            cJSON_Delete(streamed);
+        }
+    }
+}
+
+// The error offset counts from the start of the whole input, not of the chunk
+static void TestErrorOffset(void) {
+    size_t errorOffset = 0;
+    CHECK(StreamParse("[1,2,3,?]", 2, &errorOffset) == NULL);
+    CHECK(errorOffset == 7);
+    CHECK(StreamParse("{\"a\":1,\"b\":x}", 3, &errorOffset) == NULL);
+    CHECK(errorOffset == 11);
+}
+
+// A callback returning false stops the parse
+static cJSON_bool StopAtSecondNumber(void *user_data, double number) {
+    (void)number;
+    return ++*(int *)user_data < 2;
+}
+
+static void TestCallbackStops(void) {
+    cJSON_StreamHandler handler;
+    memset(&handler, 0, sizeof(handler));
+    handler.number = StopAtSecondNumber;
+    int numbers = 0;
+    cJSON_StreamParser *parser = cJSONStream_CreateParser(&handler, &numbers);
+    CHECK(!cJSONStream_Feed(parser, "[1,2,3]", 7));
+    CHECK(!cJSONStream_Finish(parser));
+    CHECK(numbers == 2);
+    cJSONStream_DeleteParser(parser);
+}
+
+int main(void) {
+    TestMatchesParse();
+    TestRejectsWhatParseRejects();
+    TestErrorOffset();
+    TestCallbackStops();
+    return TestsFinish();
+}
@@ -0,0 +1,139 @@
+// Regression tests for the buffered streaming writer, checked against cJSON_Print
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "cJSON_Stream.h"
+#include "test_common.h"
+
+// Emits item through the writer, the way the heap matrix save walks its data
+static cJSON_bool WriteItem(cJSON_StreamWriter *writer, const cJSON *item) {
+    if (item->string && !cJSONStream_Key(writer, item->string)) return 0;
+    if (cJSON_IsObject(item) || cJSON_IsArray(item)) {
+        if (!(cJSON_IsObject(item) ? cJSONStream_BeginObject(writer) : cJSONStream_BeginArray(writer))) return 0;
+        for (const cJSON *child = item->child; child; child = child->next) {
+            if (!WriteItem(writer, child)) return 0;
+        }
+        return cJSON_IsObject(item) ? cJSONStream_EndObject(writer) : cJSONStream_EndArray(writer);
+    }
+    if (cJSON_IsString(item)) return cJSONStream_String(writer, item->valuestring);
+    if (cJSON_IsNumber(item)) return cJSONStream_Number(writer, item->valuedouble);
+    if (cJSON_IsBool(item)) return cJSONStream_Bool(writer, cJSON_IsTrue(item));
+    return cJSONStream_Null(writer);
+}
+
+// Everything written to file so far, null terminated
+static char *ReadBack(FILE *file) {
+    long size = ftell(file);
+    char *text = malloc((size_t)size + 1);
+    if (!text) exit(1);
+    rewind(file);
+    text[fread(text, 1, (size_t)size, file)] = '\0';
+    return text;
+}
+
+static void CheckSameAsPrint(const cJSON *tree, cJSON_bool format) {
+    FILE *file = tmpfile();
+    if (!file) exit(1);
+    cJSON_StreamWriter *writer = cJSONStream_CreateFileWriter(file, format);
+    CHECK(WriteItem(writer, tree));
+    CHECK(cJSONStream_Flush(writer));
+    cJSONStream_DeleteWriter(writer);
+
+    char *written = ReadBack(file);
+    char *printed = format ? cJSON_Print(tree) : cJSON_PrintUnformatted(tree);
+    CHECK(printed != NULL && strcmp(written, printed) == 0);
+    cJSON_free(printed);
+    free(written);
+    fclose(file);
+}
+
+static const char *Documents[] = {
+    "{}",
+    "[]",
+    "[[],{},[{}]]",
+    "\"top level \\\" \\n \\u0001 \\u00e9\"",
+    "-0.5",
+    "{\"a\":{\"b\":[1,2.5,-3e-7,1e300,123456789,null,true,false]},\"empty\":\"\",\"nested\":{\"x\":{\"y\":{}}}}",
+    "[{\"first_name\":\"Ada\",\"last_name\":\"Lovelace\",\"phone\":\"0501234567\",\"grades\":[90,85,77,100,64,88,91,73,99,80]}]",
+};
+
+static void TestDocuments(void) {
+    for (size_t d = 0; d < sizeof(Documents) / sizeof(Documents[0]); d++) {
+        cJSON *tree = cJSON_Parse(Documents[d]);
+        CHECK(tree != NULL);
+        CheckSameAsPrint(tree, 0);
+        CheckSameAsPrint(tree, 1);
+        cJSON_Delete(tree);
+    }
+}
+
+// Output many times the buffer size, with strings that straddle its end
+static void TestLargerThanBuffer(void) {
+    cJSON *tree = cJSON_CreateObject();
+    cJSON *rows = cJSON_AddArrayToObject(tree, "rows");
+    char text[300];
+    for (int i = 0; i < 500; i++) {
+        cJSON *row = cJSON_CreateObject();
+        memset(text, 'a' + i % 26, (size_t)(i % 290));
+        text[i % 290] = '\0';
+        cJSON_AddStringToObject(row, "text", text);
+        cJSON_AddNumberToObject(row, "value", i * 1.25);
+        cJSON_AddItemToArray(rows, row);
+    }
+    CheckSameAsPrint(tree, 0);
+    CheckSameAsPrint(tree, 1);
+    cJSON_Delete(tree);
+}
+
+static void TestFdWriter(void) {
+    FILE *file = tmpfile();
+    if (!file) exit(1);
+    cJSON_StreamWriter *writer = cJSONStream_CreateFdWriter(fileno(file), 0);
+    CHECK(cJSONStream_BeginArray(writer));
+    CHECK(cJSONStream_Int(writer, 42));
+    CHECK(cJSONStream_String(writer, "x"));
+    CHECK(cJSONStream_EndArray(writer));
+    CHECK(cJSONStream_Flush(writer));
+    cJSONStream_DeleteWriter(writer);
+
+    // Nothing went through the FILE's own buffer, so it reads what the writer wrote to the descriptor
+    fseek(file, 0, SEEK_END);
+    char *written = ReadBack(file);
+    CHECK(strcmp(written, "[42,\"x\"]") == 0);
+    free(written);
+    fclose(file);
+}
+
+// Misplaced calls fail, and so does everything after them
+static void TestMisuse(void) {
+    FILE *file = tmpfile();
+    if (!file) exit(1);
+
+    cJSON_StreamWriter *writer = cJSONStream_CreateFileWriter(file, 0);
+    CHECK(cJSONStream_BeginObject(writer));
+    CHECK(!cJSONStream_Int(writer, 1));
+    CHECK(!cJSONStream_Key(writer, "a"));
+    CHECK(!cJSONStream_Flush(writer));
+    cJSONStream_DeleteWriter(writer);
+
+    writer = cJSONStream_CreateFileWriter(file, 0);
+    CHECK(cJSONStream_BeginArray(writer));
+    CHECK(!cJSONStream_EndObject(writer));
+    cJSONStream_DeleteWriter(writer);
+
+    writer = cJSONStream_CreateFileWriter(file, 0);
+    CHECK(cJSONStream_BeginArray(writer));
+    CHECK(!cJSONStream_Key(writer, "a"));
+    cJSONStream_DeleteWriter(writer);
+
+    fclose(file);
+}
+
+int main(void) {
+    TestDocuments();
+    TestLargerThanBuffer();
+    TestFdWriter();
+    TestMisuse();
+    return TestsFinish();
+}
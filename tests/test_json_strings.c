@@ -0,0 +1,81 @@
+// Regression tests for the string scanners behind cJSON's parse_string and print_string_ptr
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "test_common.h"
+
+// Escapes text the way cJSON always has, one byte at a time
+static void ReferenceEscape(const unsigned char *text, char *out) {
+    *out++ = '"';
+    for (; *text != '\0'; text++) {
+        switch (*text) {
+            case '"': out += sprintf(out, "\\\""); break;
+            case '\\': out += sprintf(out, "\\\\"); break;
+            case '\b': out += sprintf(out, "\\b"); break;
+            case '\f': out += sprintf(out, "\\f"); break;
+            case '\n': out += sprintf(out, "\\n"); break;
+            case '\r': out += sprintf(out, "\\r"); break;
+            case '\t': out += sprintf(out, "\\t"); break;
+            default:
+                if (*text < 32) out += sprintf(out, "\\u%04x", *text);
+                else *out++ = (char)*text;
+        }
+    }
+    *out++ = '"';
+    *out = '\0';
+}
+
+// Every special byte at every position of runs around the 16 and 32 byte vector widths
+static void TestRoundTripAroundVectorWidths(void) {
+    static const unsigned char specials[] = {'"', '\\', '\n', '\t', '\r', '\b', '\f', 0x01, 0x1f, ' ', '/', 0x7f, 0xc3};
+    unsigned char text[80];
+    char expected[80 * 6 + 3];
+
+    for (size_t length = 1; length < 72; length++) {
+        for (size_t position = 0; position < length; position++) {
+            for (size_t s = 0; s < sizeof(specials); s++) {
+                memset(text, 'a', length);
+                text[length] = '\0';
+                text[position] = specials[s];
+                ReferenceEscape(text, expected);
+
+                cJSON *item = cJSON_CreateString((const char *)text);
+                char *printed = cJSON_PrintUnformatted(item);
+                CHECK(printed != NULL && strcmp(printed, expected) == 0);
+
+                cJSON *parsed = printed ? cJSON_Parse(printed) : NULL;
+                CHECK(parsed != NULL && cJSON_IsString(parsed) && strcmp(parsed->valuestring, (const char *)text) == 0);
+
+                cJSON_Delete(parsed);
+                cJSON_free(printed);
+                cJSON_Delete(item);
+            }
+        }
+    }
+}
+
+static void TestKnownEscapes(void) {
+    cJSON *item = cJSON_Parse("\"caf\\u00e9\\n\\/\\ud83d\\ude00 and a long unescaped tail after the escapes\"");
+    CHECK(item != NULL && strcmp(item->valuestring, "caf\xc3\xa9\n/\xf0\x9f\x98\x80 and a long unescaped tail after the escapes") == 0);
+    cJSON_Delete(item);
+
+    // Unterminated strings fail however long the unescaped run is
+    CHECK(cJSON_Parse("\"an unterminated string that is longer than one vector register\\\"") == NULL);
+    CHECK(cJSON_Parse("\"short") == NULL);
+
+    // An invalid \u escape swallowing the backslash of \" used to loop forever
+    item = cJSON_Parse("\"\\uZZ\\\"abcdefghijklmnopqrstuvwxyz0123456789\"");
+    cJSON_Delete(item);
+
+    char *printed = cJSON_PrintUnformatted(item = cJSON_CreateString("tab\tquote\"nul\x01 and \xc3\xa9 stay"));
+    CHECK(printed != NULL && strcmp(printed, "\"tab\\tquote\\\"nul\\u0001 and \xc3\xa9 stay\"") == 0);
+    cJSON_free(printed);
+    cJSON_Delete(item);
+}
+
+int main(void) {
+    TestRoundTripAroundVectorWidths();
+    TestKnownEscapes();
+    return TestsFinish();
+}
@@ -0,0 +1,71 @@
+// Regression tests for the vectorized whitespace skipping in cJSON's parser
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "test_common.h"
+
+// A run of mixed whitespace, length bytes long
+static void FillWhitespace(char *out, size_t length) {
+    static const char whitespace[] = {' ', '\t', '\n', '\r'};
+    for (size_t i = 0; i < length; i++) out[i] = whitespace[(i * 7 + length) % 4];
+}
+
+// Whitespace runs around the 16 and 32 byte vector widths between every token
+static void TestRunsBetweenTokens(void) {
+    static const char *tokens[] = {"{", "\"a\"", ":", "[", "1", ",", "true", ",", "null", "]", ",", "\"b\"", ":", "\"x\"", "}"};
+    char document[16 * 80 + 1];
+
+    for (size_t length = 0; length < 72; length++) {
+        char *out = document;
+        for (size_t t = 0; t < sizeof(tokens) / sizeof(tokens[0]); t++) {
+            FillWhitespace(out, length);
+            out += length;
+            out += sprintf(out, "%s", tokens[t]);
+        }
+        FillWhitespace(out, length);
+        out += length;
+
+        // Not null terminated, so a scanner reading past the end of the run shows up under ASan
+        size_t size = (size_t)(out - document);
+        char *exact = malloc(size);
+        if (!exact) exit(1);
+        memcpy(exact, document, size);
+        cJSON *item = cJSON_ParseWithLength(exact, size);
+        char *printed = item ? cJSON_PrintUnformatted(item) : NULL;
+        CHECK(printed != NULL && strcmp(printed, "{\"a\":[1,true,null],\"b\":\"x\"}") == 0);
+        cJSON_free(printed);
+        cJSON_Delete(item);
+        free(exact);
+    }
+}
+
+// The error position still points at the first byte after the whitespace
+static void TestErrorAfterWhitespace(void) {
+    char document[128];
+
+    for (size_t length = 0; length < 72; length++) {
+        document[0] = '[';
+        FillWhitespace(document + 1, length);
+        strcpy(document + 1 + length, "?]");
+        CHECK(cJSON_Parse(document) == NULL);
+        CHECK(cJSON_GetErrorPtr() == document + 1 + length);
+    }
+
+    // Only whitespace is not a document
+    memset(document, ' ', 100);
+    document[100] = '\0';
+    CHECK(cJSON_Parse(document) == NULL);
+
+    const char *end = NULL;
+    strcpy(document, "[1]  \t\n  ");
+    cJSON *item = cJSON_ParseWithOpts(document, &end, 1);
+    CHECK(item != NULL && end == document + strlen(document));
+    cJSON_Delete(item);
+}
+
+int main(void) {
+    TestRunsBetweenTokens();
+    TestErrorAfterWhitespace();
+    return TestsFinish();
+}
@@ -0,0 +1,180 @@
+// Regression tests for the name trie, checked against scanning every name
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "student_management_system.h"
+#include "name_index.h"
+#include "test_common.h"
+
+static const char *FirstNames[] = {"Dan", "Dana", "Daniel", "Danielle", "Noa", "Noam", "Levi", "Lior", "Maya", "Amit"};
+static const char *LastNames[] = {"Cohen", "Kohen", "Levi", "Levy", "Mizrahi", "Peretz", "Biton", "Dahan", "Avraham", "Friedman", "Coen"};
+
+#define STUDENTS 330
+#define MAX_MATCHES 400
+
+static Student Students[STUDENTS];
+
+// Plain Levenshtein distance over the lower cased names
+static int Distance(const char *a, const char *b) {
+    int n = (int)strlen(a), m = (int)strlen(b);
+    int rows[2][64];
+    for (int j = 0; j <= m; j++) rows[0][j] = j;
+    for (int i = 1; i <= n; i++) {
+        int *previous = rows[(i - 1) & 1], *row = rows[i & 1];
+        row[0] = i;
+        for (int j = 1; j <= m; j++) {
+            int best = previous[j - 1] + (tolower((unsigned char)a[i - 1]) != tolower((unsigned char)b[j - 1]));
+            if (previous[j] + 1 < best) best = previous[j] + 1;
+            if (row[j - 1] + 1 < best) best = row[j - 1] + 1;
+            row[j] = best;
+        }
+    }
+    return rows[n & 1][m];
+}
+
+static int StartsWith(const char *name, const char *prefix) {
+    for (; *prefix; name++, prefix++) {
+        if (tolower((unsigned char)*name) != tolower((unsigned char)*prefix)) return 0;
+    }
+    return 1;
+}
+
+static int Indexed[STUDENTS];
+
+// The distance a scan gives the student, -1 when it shouldn't be found
+static int ScanFuzzy(const Student *student, const char *word, int maxEdits) {
+    int first = Distance(student->first_name, word);
+    int last = Distance(student->last_name, word);
+    int best = first < last ? first : last;
+    return best <= maxEdits ? best : -1;
+}
+
+static int FindMatch(const NameMatch *matches, int count, const Student *student) {
+    int found = -1;
+    for (int i = 0; i < count; i++) {
+        if (matches[i].student == student) {
+            // Listed once
+            if (found != -1) return -2;
+            found = i;
+        }
+    }
+    return found;
+}
+
+static void CheckPrefix(const NameIndex *index, const char *prefix) {
+    static NameMatch matches[MAX_MATCHES];
+    int count = NameIndexPrefix(index, prefix, NULL, NULL, matches, MAX_MATCHES);
+    int expected = 0;
+    for (int i = 0; i < STUDENTS; i++) {
+        int shouldFind = Indexed[i] && (StartsWith(Students[i].first_name, prefix) || StartsWith(Students[i].last_name, prefix));
+        int at = FindMatch(matches, count, &Students[i]);
+        CHECK(shouldFind ? at >= 0 && matches[at].distance == 0 : at == -1);
+        expected += shouldFind;
+    }
+    CHECK(count == expected);
+}
+
+static void CheckFuzzy(const NameIndex *index, const char *word, int maxEdits) {
+    static NameMatch matches[MAX_MATCHES];
+    int count = NameIndexFuzzy(index, word, maxEdits, NULL, NULL, matches, MAX_MATCHES);
+    int expected = 0;
+    for (int i = 0; i < STUDENTS; i++) {
+        int distance = Indexed[i] ? ScanFuzzy(&Students[i], word, maxEdits) : -1;
+        int at = FindMatch(matches, count, &Students[i]);
+        CHECK(distance >= 0 ? at >= 0 && matches[at].distance == distance : at == -1);
+        expected += distance >= 0;
+    }
+    CHECK(count == expected);
+    for (int i = 1; i < count; i++) {
+        CHECK(matches[i - 1].distance <= matches[i].distance);
+    }
+
+    // A short list keeps the closest ones
+    NameMatch few[5];
+    int kept = NameIndexFuzzy(index, word, maxEdits, NULL, NULL, few, 5);
+    CHECK(kept == (count < 5 ? count : 5));
+    for (int i = 0; i < kept; i++) {
+        CHECK(few[i].distance == matches[i].distance);
+    }
+}
+
+static const char *Queries[] = {"d", "dan", "DANI", "danielle", "danielles", "l", "lev", "co", "koh", "x", "", "mizrahi"};
+static const char *Typos[] = {"dn", "cohn", "kohen", "levvi", "mizrachi", "naom", "frideman", "biton", "amitt", "zzz"};
+
+static void TestMatchesScan(void) {
+    NameIndex *index = NameIndexCreate();
+    for (int i = 0; i < STUDENTS; i++) {
+        snprintf(Students[i].first_name, MAX_NAME, "%s", FirstNames[i % 10]);
+        snprintf(Students[i].last_name, MAX_NAME, "%s", LastNames[i % 11]);
+        CHECK(NameIndexAdd(index, &Students[i]));
+        Indexed[i] = 1;
+    }
+
+    for (int round = 0; round < 2; round++) {
+        for (size_t q = 0; q < sizeof(Queries) / sizeof(Queries[0]); q++) CheckPrefix(index, Queries[q]);
+        for (size_t t = 0; t < sizeof(Typos) / sizeof(Typos[0]); t++) {
+            CheckFuzzy(index, Typos[t], 1);
+            CheckFuzzy(index, Typos[t], 2);
+        }
+
+        // Then again with every third student removed
+        for (int i = 0; i < STUDENTS; i += 3) {
+            NameIndexRemove(index, &Students[i]);
+            Indexed[i] = 0;
+        }
+    }
+
+    // Counting finds nothing where the searches find nothing and stops at the limit
+    CHECK(NameIndexCount(index, "zzz", 1, 1000) == 0);
+    CHECK(NameIndexCount(index, "dan", 1, 7) == 7);
+
+    NameIndexFree(index);
+}
+
+static void TestDistance(void) {
+    CHECK(NameIndexDistance("Cohen", "coh", 2) == 0);
+    CHECK(NameIndexDistance("Cohen", "COHEN", 0) == 0);
+    CHECK(NameIndexDistance("Cohen", "kohen", 2) == 1);
+    CHECK(NameIndexDistance("Cohen", "kohn", 2) == 2);
+    CHECK(NameIndexDistance("Cohen", "kohn", 1) == -1);
+    CHECK(NameIndexDistance("Levi", "xyz", 2) == -1);
+    CHECK(NameIndexDistance("Levi", "levvi", 1) == 1);
+}
+
+// The whole search behind searchStudent, first and last name together
+static void TestSearchStudents(void) {
+    School *school = create_school();
+    static const char *names[][2] = {{"Dan", "Cohen"}, {"Dana", "Cohen"}, {"Dan", "Levi"}, {"Noa", "Kohen"}, {"Daniel", "Coen"}};
+    for (int i = 0; i < 5; i++) {
+        Student *student = calloc(1, sizeof(Student));
+        if (!student) exit(1);
+        snprintf(student->first_name, MAX_NAME, "%s", names[i][0]);
+        snprintf(student->last_name, MAX_NAME, "%s", names[i][1]);
+        snprintf(student->phone, MAX_PHONE, "05000000%02d", i);
+        student->grade = 1;
+        student->class = 1;
+        CHECK(insert_student(school, student));
+    }
+
+    Student *results[8];
+    int found = search_students(school, "dan cohen", results, 8);
+    CHECK(found >= 2);
+    CHECK(found > 0 && strcmp(results[0]->first_name, "Dan") == 0 && strcmp(results[0]->last_name, "Cohen") == 0);
+    for (int i = 0; i < found; i++) {
+        CHECK(strcmp(results[i]->last_name, "Levi") != 0);
+    }
+
+    found = search_students(school, "coehn", results, 8);
+    CHECK(found >= 1);
+    CHECK(search_students(school, "", results, 8) == 0);
+
+    destroySchool(school);
+}
+
+int main(void) {
+    TestMatchesScan();
+    TestDistance();
+    TestSearchStudents();
+    return TestsFinish();
+}
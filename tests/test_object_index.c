@@ -0,0 +1,137 @@
+// Regression tests for the opt-in object index behind cJSON_GetObjectItem
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "cJSON.h"
+#include "test_common.h"
+
+static int ContextBlocks;
+
+static void *CountingMalloc(size_t size) {
+    ContextBlocks++;
+    return malloc(size);
+}
+
+static void CountingFree(void *pointer) {
+    if (pointer) ContextBlocks--;
+    free(pointer);
+}
+
+// Looks up every key, its upper case form and a few missing ones in both objects
+static void CheckSameLookups(const cJSON *indexed, const cJSON *plain, int keys) {
+    char key[32];
+    for (int i = -2; i < keys + 2; i++) {
+        snprintf(key, sizeof(key), "Key%d", i);
+        CHECK(cJSON_GetObjectItemCaseSensitive(indexed, key) == NULL
+              ? cJSON_GetObjectItemCaseSensitive(plain, key) == NULL
+              : cJSON_GetObjectItemCaseSensitive(plain, key) != NULL
+                && cJSON_GetObjectItemCaseSensitive(indexed, key)->valueint == cJSON_GetObjectItemCaseSensitive(plain, key)->valueint);
+        for (char *c = key; *c; c++) *c = (char)toupper((unsigned char)*c);
+        CHECK(cJSON_GetObjectItemCaseSensitive(indexed, key) == NULL);
+        CHECK(cJSON_GetObjectItem(indexed, key) == NULL
+              ? cJSON_GetObjectItem(plain, key) == NULL
+              : cJSON_GetObjectItem(plain, key) != NULL
+                && cJSON_GetObjectItem(indexed, key)->valueint == cJSON_GetObjectItem(plain, key)->valueint);
+    }
+}
+
+static cJSON *NewObject(int keys) {
+    cJSON *object = cJSON_CreateObject();
+    char key[32];
+    for (int i = 0; i < keys; i++) {
+        snprintf(key, sizeof(key), "Key%d", i);
+        cJSON_AddNumberToObject(object, key, i);
+    }
+    // A duplicate key, the first one still wins
+    cJSON_AddNumberToObject(object, "Key1", -1);
+    return object;
+}
+
+static void TestLookupsMatchWalk(void) {
+    cJSON *indexed = NewObject(100);
+    cJSON *plain = NewObject(100);
+
+    // Lookups alone never build an index
+    CheckSameLookups(plain, plain, 100);
+    CHECK(plain->index == NULL);
+
+    CHECK(cJSON_BuildIndex(indexed));
+    CHECK(indexed->index != NULL);
+    CheckSameLookups(indexed, plain, 100);
+    CHECK(cJSON_GetObjectItem(indexed, "Key1")->valueint == 1);
+
+    // Appends keep the index, growing it past its first capacity
+    char key[32];
+    for (int i = 100; i < 300; i++) {
+        snprintf(key, sizeof(key), "Key%d", i);
+        cJSON_AddNumberToObject(indexed, key, i);
+        cJSON_AddNumberToObject(plain, key, i);
+    }
+    CHECK(indexed->index != NULL);
+    CheckSameLookups(indexed, plain, 300);
+
+    // Removing a child drops the index, lookups still work and it can be built again
+    cJSON_DeleteItemFromObject(indexed, "Key7");
+    cJSON_DeleteItemFromObject(plain, "Key7");
+    CHECK(indexed->index == NULL);
+    CheckSameLookups(indexed, plain, 300);
+    CHECK(cJSON_BuildIndex(indexed));
+    CheckSameLookups(indexed, plain, 300);
+
+    // A child without a key falls back to walking
+    cJSON_AddItemToArray(indexed, cJSON_CreateNumber(5));
+    cJSON_AddItemToArray(plain, cJSON_CreateNumber(5));
+    CheckSameLookups(indexed, plain, 300);
+
+    cJSON_DropIndex(indexed);
+    CHECK(indexed->index == NULL);
+
+    cJSON_Delete(indexed);
+    cJSON_Delete(plain);
+}
+
+static void TestBuildIndexArguments(void) {
+    cJSON *number = cJSON_CreateNumber(1);
+    cJSON *object = NewObject(3);
+    cJSON *reference = cJSON_CreateObjectReference(object->child);
+
+    CHECK(!cJSON_BuildIndex(NULL));
+    CHECK(!cJSON_BuildIndex(number));
+    CHECK(!cJSON_BuildIndex(reference));
+    CHECK(cJSON_BuildIndex(object));
+    // Building twice keeps the first index
+    CHECK(cJSON_BuildIndex(object));
+    cJSON_DropIndex(NULL);
+
+    cJSON_Delete(reference);
+    cJSON_Delete(object);
+    cJSON_Delete(number);
+}
+
+// The index comes from the context's hooks and goes back to them
+static void TestContextHooks(void) {
+    cJSON_Hooks hooks = {CountingMalloc, CountingFree};
+    cJSON_Context *context = cJSON_CreateContext(&hooks, 0);
+    cJSON *object = cJSON_ContextParse(context, "{\"a\":1,\"b\":2,\"c\":3}");
+    CHECK(object != NULL);
+
+    int before = ContextBlocks;
+    CHECK(cJSON_ContextBuildIndex(context, object));
+    CHECK(ContextBlocks > before);
+    CHECK(cJSON_GetObjectItem(object, "B")->valueint == 2);
+    cJSON_DropIndex(object);
+    CHECK(ContextBlocks == before);
+
+    CHECK(cJSON_ContextBuildIndex(context, object));
+    cJSON_ContextDelete(context, object);
+    cJSON_DeleteContext(context);
+    CHECK(ContextBlocks == 0);
+}
+
+int main(void) {
+    TestLookupsMatchWalk();
+    TestBuildIndexArguments();
+    TestContextHooks();
+    return TestsFinish();
+}
@@ -0,0 +1,128 @@
+// Regression tests for cJSONParallel_ParseArray, checked against the serial cJSON_ParseWithLength
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cJSON.h"
+#include "cJSON_Parallel.h"
+#include "test_common.h"
+
+#define ELEMENTS 3000
+
+// A top-level array well above CJSON_PARALLEL_MIN_LENGTH, with brackets, quotes and commas inside strings
+static char *NewDocument(size_t *length) {
+    size_t capacity = ELEMENTS * 200 + 16;
+    char *document = malloc(capacity);
+    if (!document) exit(1);
+    size_t used = (size_t)sprintf(document, " [\n");
+    for (int i = 0; i < ELEMENTS; i++) {
+        switch (i % 5) {
+            case 0:
+                used += (size_t)sprintf(document + used, "{\"name\":\"student %d, [x] {y}\",\"grades\":[%d,%d,%d]}", i, i % 101, (i * 7) % 101, (i * 13) % 101);
+                break;
+            case 1:
+                used += (size_t)sprintf(document + used, "\"escaped \\\" quote ] and \\\\ backslash %d\"", i);
+                break;
+            case 2:
+                used += (size_t)sprintf(document + used, "[[%d],[],{\"a\":[{}]}]", i);
+                break;
+            case 3:
+                used += (size_t)sprintf(document + used, "%d.%de-3", -i, i % 10);
+                break;
+            default:
+                used += (size_t)sprintf(document + used, "%s", i % 2 ? "true" : "null");
+        }
+        used += (size_t)sprintf(document + used, "%s", i + 1 < ELEMENTS ? " ,\n\t" : "\n");
+    }
+    used += (size_t)sprintf(document + used, "] ");
+    *length = used;
+    return document;
+}
+
+static void TestSameTreeAsSerial(void) {
+    size_t length = 0;
+    char *document = NewDocument(&length);
+    CHECK(length >= CJSON_PARALLEL_MIN_LENGTH);
+
+    cJSON *serial = cJSON_ParseWithLength(document, length);
+    CHECK(cJSON_GetArraySize(serial) == ELEMENTS);
+    char *serialText = cJSON_PrintUnformatted(serial);
+
+    static const int threadCounts[] = {0, 1, 2, 3, 4, 8, 64};
+    for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++) {
+        cJSON *parallel = cJSONParallel_ParseArray(document, length, threadCounts[t]);
+        CHECK(cJSON_Compare(parallel, serial, 1));
+        char *parallelText = cJSON_PrintUnformatted(parallel);
+        CHECK(parallelText != NULL && serialText != NULL && strcmp(parallelText, serialText) == 0);
+        // The linked array walks the same both ways
+        CHECK(parallel != NULL && parallel->child->prev == cJSON_GetArrayItem(parallel, ELEMENTS - 1));
+        cJSON_free(parallelText);
+        cJSON_Delete(parallel);
+    }
+
+    cJSON_free(serialText);
+    cJSON_Delete(serial);
+    free(document);
+}
+
+// Breaks the document at offset and checks that both parsers fail at the same byte
+static void CheckSameError(char *document, size_t length, size_t offset, char replacement) {
+    char saved = document[offset];
+    document[offset] = replacement;
+
+    cJSON *serial = cJSON_ParseWithLength(document, length);
+    const char *serialError = cJSON_GetErrorPtr();
+    cJSON *parallel = cJSONParallel_ParseArray(document, length, 4);
+    const char *parallelError = cJSON_GetErrorPtr();
+    CHECK(serial == NULL);
+    CHECK(parallel == NULL);
+    CHECK(serialError != NULL && parallelError == serialError);
+
+    cJSON_Delete(serial);
+    cJSON_Delete(parallel);
+    document[offset] = saved;
+}
+
+static void TestSameErrorsAsSerial(void) {
+    size_t length = 0;
+    char *document = NewDocument(&length);
+
+    // Inside the first element, halfway through, in the last element and on the closing bracket
+    const char *first = strchr(document, '{');
+    CheckSameError(document, length, (size_t)(first - document) + 1, '?');
+    const char *middle = strstr(document, "student 1500,");
+    CheckSameError(document, length, (size_t)(middle - document) - 2, '?');
+    const char *last = strrchr(document, ']');
+    CheckSameError(document, length, (size_t)(last - document) - 3, ',');
+    CheckSameError(document, length, (size_t)(last - document), '}');
+
+    // A comma between elements turned into something else
+    const char *comma = strstr(middle, " ,\n");
+    CheckSameError(document, length, (size_t)(comma - document) + 1, ':');
+
+    // Truncated before the end of the array
+    CHECK(cJSONParallel_ParseArray(document, length / 2, 4) == NULL);
+    CHECK(cJSON_ParseWithLength(document, length / 2) == NULL);
+
+    free(document);
+}
+
+// Anything other than a large array goes to the serial parser
+static void TestOtherInput(void) {
+    size_t length = 0;
+    char *document = NewDocument(&length);
+    document[1] = '{';
+    CHECK(cJSONParallel_ParseArray(document, length, 4) == NULL);
+    free(document);
+
+    cJSON *small = cJSONParallel_ParseArray("[1,2,3]", 7, 4);
+    CHECK(cJSON_GetArraySize(small) == 3);
+    cJSON_Delete(small);
+    CHECK(cJSONParallel_ParseArray(NULL, 0, 4) == NULL);
+}
+
+int main(void) {
+    TestSameTreeAsSerial();
+    TestSameErrorsAsSerial();
+    TestOtherInput();
+    return TestsFinish();
+}
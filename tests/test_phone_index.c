@@ -0,0 +1,116 @@
+// Regression tests for the phone index behind find_by_phone, checked against a scan of every student
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "student_management_system.h"
+#include "test_common.h"
+
+#define STUDENTS 500
+
+static Student *NewStudent(int number, const char *phone) {
+    Student *student = calloc(1, sizeof(Student));
+    if (!student) exit(1);
+    snprintf(student->first_name, MAX_NAME, "First%d", number);
+    snprintf(student->last_name, MAX_NAME, "Last%d", number);
+    snprintf(student->phone, MAX_PHONE, "%s", phone);
+    student->grade = number % MAX_GRADES + 1;
+    student->class = number % MAX_CLASSES + 1;
+    return student;
+}
+
+// The digits of a phone, which is what the index compares
+static void Digits(const char *phone, char *digits) {
+    for (; *phone; phone++) {
+        if (*phone >= '0' && *phone <= '9') *digits++ = *phone;
+    }
+    *digits = '\0';
+}
+
+// The first student found by walking every bucket of the name table whose phone has the same digits, or NULL
+static int ScanFinds(School *school, const char *phone, Student *found) {
+    char wanted[MAX_PHONE * 2], digits[MAX_PHONE];
+    Digits(phone, wanted);
+    int matches = 0;
+    for (int i = 0; i < school->hash_table.bucket_count; i++) {
+        for (Student *student = school->hash_table.buckets[i]; student; student = student->next) {
+            Digits(student->phone, digits);
+            if (wanted[0] != '\0' && strcmp(digits, wanted) == 0) {
+                if (student == found) return 1;
+                matches++;
+            }
+        }
+    }
+    return found == NULL && matches == 0;
+}
+
+static void TestPackPhone(void) {
+    CHECK(pack_phone("") == 0);
+    CHECK(pack_phone("no digits") == 0);
+    CHECK(pack_phone("0") == 0x1);
+    CHECK(pack_phone("00") == 0x11);
+    CHECK(pack_phone("050") == 0x161);
+    CHECK(pack_phone("050-123 4567") == pack_phone("0501234567"));
+    CHECK(pack_phone("0501234567") != pack_phone("501234567"));
+    CHECK(pack_phone("99999999999999") == 0xAAAAAAAAAAAAAAULL);
+}
+
+static void TestMatchesScan(void) {
+    School *school = create_school();
+    CHECK(find_by_phone(school, "0501234567") == NULL);
+
+    // Enough students to grow the index several times, some sharing a phone and some without digits
+    for (int i = 0; i < STUDENTS; i++) {
+        char phone[MAX_PHONE];
+        if (i % 50 == 49) snprintf(phone, sizeof(phone), "none");
+        else if (i % 10 == 9) snprintf(phone, sizeof(phone), "050-000-%04d", i - 1);
+        else snprintf(phone, sizeof(phone), "050000%04d", i);
+        Student *student = NewStudent(i, phone);
+        CHECK(insert_student(school, student));
+    }
+    CHECK(school->phone_index.bucket_count >= STUDENTS - STUDENTS / 50);
+
+    for (int i = 0; i < STUDENTS + 10; i++) {
+        char phone[32];
+        snprintf(phone, sizeof(phone), "050 000 %04d", i);
+        Student *found = find_by_phone(school, phone);
+        CHECK(ScanFinds(school, phone, found));
+    }
+    CHECK(find_by_phone(school, "none") == NULL);
+    CHECK(find_by_phone(school, "") == NULL);
+    CHECK(find_by_phone(school, NULL) == NULL);
+
+    // A new phone moves the student, the old one is gone unless someone else shares it
+    Student *student = find(school, "First7", "Last7");
+    CHECK(update_student_phone(school, student, "(052) 777-7777"));
+    CHECK(find_by_phone(school, "0527777777") == student);
+    CHECK(find_by_phone(school, "0500000007") == NULL);
+    CHECK(strcmp(student->phone, "(052) 777-7777") == 0);
+
+    // Without digits it leaves the index, and comes back with a phone
+    int indexed = school->phone_index.size;
+    CHECK(update_student_phone(school, student, "unknown"));
+    CHECK(find_by_phone(school, "0527777777") == NULL);
+    CHECK(school->phone_index.size == indexed - 1);
+    CHECK(update_student_phone(school, student, "0527777777"));
+    CHECK(find_by_phone(school, "0527777777") == student);
+    CHECK(school->phone_index.size == indexed);
+
+    // Longer than the phone buffer, cut to what is stored
+    CHECK(update_student_phone(school, student, "05277777771234567"));
+    CHECK(strlen(student->phone) == MAX_PHONE - 1);
+    CHECK(find_by_phone(school, student->phone) == student);
+
+    for (int i = 0; i < STUDENTS; i++) {
+        char phone[32];
+        snprintf(phone, sizeof(phone), "050000%04d", i);
+        CHECK(ScanFinds(school, phone, find_by_phone(school, phone)));
+    }
+
+    destroySchool(school);
+}
+
+int main(void) {
+    TestPackPhone();
+    TestMatchesScan();
+    return TestsFinish();
+}
@@ -0,0 +1,86 @@
+// Regression tests for cJSON_GetPrintBufferSize, checked against what cJSON_Print produces
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "cJSON.h"
+#include "test_common.h"
+
+// The size is the printed length plus 2, and cJSON_PrintPreallocated succeeds with exactly that much room
+static void CheckExactSize(cJSON *item, cJSON_bool format) {
+    char *printed = format ? cJSON_Print(item) : cJSON_PrintUnformatted(item);
+    size_t size = cJSON_GetPrintBufferSize(item, format);
+    CHECK(printed != NULL && size == strlen(printed) + 2);
+
+    char *buffer = malloc(size);
+    if (!buffer) exit(1);
+    CHECK(cJSON_PrintPreallocated(item, buffer, (int)size, format));
+    CHECK(printed != NULL && strcmp(buffer, printed) == 0);
+    free(buffer);
+    cJSON_free(printed);
+}
+
+static const char *Documents[] = {
+    "{}",
+    "[]",
+    "null",
+    "true",
+    "0",
+    "-0",
+    "1e300",
+    "-1.2345678901234567e-300",
+    "0.1",
+    "123456789012345678",
+    "2147483647",
+    "-2147483648",
+    "\"\"",
+    "\"tab\\t quote\\\" nul\\u0001 \\u00e9 \\ud83d\\ude00 slash/\"",
+    "[1,2,3,[4,[5,[6,{}]]],{\"a\":[],\"b\":{}}]",
+    "{\"a\":{\"b\":{\"c\":{\"d\":[true,false,null,\"x\",1.5]}}},\"e\":[[],[[]],[[[]]]]}",
+    "[{\"first_name\":\"Ada\",\"last_name\":\"Lovelace\",\"phone\":\"0501234567\",\"grades\":[90,85,77,100,64,88,91,73,99,80]}]",
+};
+
+static void TestDocuments(void) {
+    for (size_t d = 0; d < sizeof(Documents) / sizeof(Documents[0]); d++) {
+        cJSON *item = cJSON_Parse(Documents[d]);
+        CHECK(item != NULL);
+        CheckExactSize(item, 0);
+        CheckExactSize(item, 1);
+        cJSON_Delete(item);
+    }
+}
+
+// Values that only come from building a tree: raw text, non finite numbers, numbers that need 17 digits
+static void TestBuiltValues(void) {
+    cJSON *object = cJSON_CreateObject();
+    cJSON_AddRawToObject(object, "raw", "[1, 2 ,3]");
+    cJSON_AddNumberToObject(object, "nan", NAN);
+    cJSON_AddNumberToObject(object, "infinity", -INFINITY);
+    cJSON_AddNumberToObject(object, "third", 1.0 / 3.0);
+    cJSON_AddNumberToObject(object, "big", 1e21);
+    cJSON_AddItemToObject(object, "null string", cJSON_CreateString(NULL));
+    cJSON *numbers = cJSON_AddArrayToObject(object, "numbers");
+    for (int i = 0; i < 200; i++) cJSON_AddItemToArray(numbers, cJSON_CreateNumber(i * 0.7 - 50));
+    CheckExactSize(object, 0);
+    CheckExactSize(object, 1);
+    cJSON_Delete(object);
+}
+
+static void TestUnprintable(void) {
+    CHECK(cJSON_GetPrintBufferSize(NULL, 0) == 0);
+
+    cJSON *invalid = cJSON_CreateNull();
+    invalid->type = cJSON_Invalid;
+    CHECK(cJSON_GetPrintBufferSize(invalid, 0) == 0);
+    cJSON *array = cJSON_CreateArray();
+    cJSON_AddItemToArray(array, invalid);
+    CHECK(cJSON_GetPrintBufferSize(array, 1) == 0);
+    cJSON_Delete(array);
+}
+
+int main(void) {
+    TestDocuments();
+    TestBuiltValues();
+    TestUnprintable();
+    return TestsFinish();
+}
@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "trace_events.h"
+#include "cJSON_Stream.h"
+
+volatile int TraceActive = 0;
+
+#if CHECKPOINT_TRACE
+
+// Spans may end on several threads at once, so slots are claimed with an atomic counter
+#if defined(__STDC_NO_ATOMICS__)
+typedef size_t Counter;
+#define CounterTake(counter) ((*(counter))++)
+#else
+#include <stdatomic.h>
+typedef _Atomic size_t Counter;
+#define CounterTake(counter) atomic_fetch_add((counter), 1)
+#endif
+
+#if defined(_MSC_VER)
+#define ThreadLocal __declspec(thread)
+#else
+#define ThreadLocal _Thread_local
+#endif
+
+typedef struct {
+    const char *name;
+    uint64_t start;
+    uint64_t duration;
+    int thread;
+} TraceEvent;
+
+static TraceEvent *Events;
+static Counter EventCount;
+static Counter ThreadCount;
+static ThreadLocal int ThreadId;
+static uint64_t Origin;
+static int SampleEvery = 1;
+static char Path[256];
+
+int TraceStart(const char *path, int sampleEvery) {
+    if (TraceActive || !path) return 0;
+
+    Events = malloc(TRACE_CAPACITY * sizeof(TraceEvent));
+    if (!Events) return 0;
+
+    snprintf(Path, sizeof(Path), "%s", path);
+    SampleEvery = sampleEvery > 0 ? sampleEvery : 1;
+    EventCount = 0;
+    Origin = StatsNow();
+    TraceActive = 1;
+    return 1;
+}
+
+int TraceSampled(long n) {
+    return n % SampleEvery == 0;
+}
+
+void TraceRecord(const char *name, uint64_t start) {
+    uint64_t end = StatsNow();
+    if (!TraceActive) return;
+
+    // Threads are numbered in the order they first end a span
+    if (ThreadId == 0) ThreadId = (int)CounterTake(&ThreadCount) + 1;
+
+    size_t slot = CounterTake(&EventCount);
+    if (slot >= TRACE_CAPACITY) return;
+
+    TraceEvent *event = &Events[slot];
+    event->name = name;
+    event->start = start;
+    event->duration = end - start;
+    event->thread = ThreadId;
+}
+
+int TraceStop(void) {
+    if (!TraceActive) return 0;
+    TraceActive = 0;
+
+    size_t count = EventCount;
+    size_t dropped = count > TRACE_CAPACITY ? count - TRACE_CAPACITY : 0;
+    if (count > TRACE_CAPACITY) count = TRACE_CAPACITY;
+
+    FILE *file = fopen(Path, "w");
+    cJSON_StreamWriter *writer = file ? cJSONStream_CreateFileWriter(file, 0) : NULL;
+    if (!writer) {
+        if (file) fclose(file);
+        free(Events);
+        Events = NULL;
+        return 0;
+    }
+
+    // Complete ("X") events, timestamps in microseconds since TraceStart
+    cJSONStream_BeginObject(writer);
+    cJSONStream_Key(writer, "traceEvents");
+    cJSONStream_BeginArray(writer);
+    for (size_t i = 0; i < count; i++) {
+        const TraceEvent *event = &Events[i];
+        cJSONStream_BeginObject(writer);
+        cJSONStream_Key(writer, "name");
+        cJSONStream_String(writer, event->name);
+        cJSONStream_Key(writer, "ph");
+        cJSONStream_String(writer, "X");
+        cJSONStream_Key(writer, "ts");
+        cJSONStream_Number(writer, (double)(event->start - Origin) / 1000.0);
+        cJSONStream_Key(writer, "dur");
+        cJSONStream_Number(writer, (double)event->duration / 1000.0);
+        cJSONStream_Key(writer, "pid");
+        cJSONStream_Int(writer, 1);
+        cJSONStream_Key(writer, "tid");
+        cJSONStream_Int(writer, event->thread);
+        cJSONStream_EndObject(writer);
+    }
+    cJSONStream_EndArray(writer);
+    cJSONStream_Key(writer, "displayTimeUnit");
+    cJSONStream_String(writer, "ms");
+    cJSONStream_Key(writer, "otherData");
+    cJSONStream_BeginObject(writer);
+    cJSONStream_Key(writer, "sampleEvery");
+    cJSONStream_Int(writer, SampleEvery);
+    cJSONStream_Key(writer, "droppedEvents");
+    cJSONStream_Number(writer, (double)dropped);
+    cJSONStream_EndObject(writer);
+    cJSONStream_EndObject(writer);
+
+    int ok = cJSONStream_Flush(writer);
+    cJSONStream_DeleteWriter(writer);
+    ok = fclose(file) == 0 && ok;
+
+    free(Events);
+    Events = NULL;
+    return ok;
+}
+
+#else
+
+int TraceStart(const char *path, int sampleEvery) {
+    (void)path;
+    (void)sampleEvery;
+    return 0;
+}
+
+int TraceStop(void) {
+    return 0;
+}
+
+int TraceSampled(long n) {
+    (void)n;
+    return 0;
+}
+
+void TraceRecord(const char *name, uint64_t start) {
+    (void)name;
+    (void)start;
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef CHECKPOINT_TRACE_EVENTS_H
+#define CHECKPOINT_TRACE_EVENTS_H
+
+#include <stdint.h>
+#include "operation_stats.h"
+
+// Scoped spans written as Chrome trace-event JSON, for chrome://tracing or ui.perfetto.dev.
+// Tracing is off until TraceStart is called; set CHECKPOINT_TRACE to 0 to compile it out.
+#ifndef CHECKPOINT_TRACE
+#define CHECKPOINT_TRACE 1
+#endif
+
+// Events kept in memory until TraceStop, later ones are dropped and counted
+#define TRACE_CAPACITY (1 << 18)
+
+extern volatile int TraceActive;
+
+#if CHECKPOINT_TRACE
+#define TRACE_BEGIN(span) uint64_t span = TraceActive ? StatsNow() : 0
+// Only starts the span when condition holds, for spans that would otherwise come millions of times
+#define TRACE_BEGIN_IF(span, condition) uint64_t span = (TraceActive && (condition)) ? StatsNow() : 0
+#define TRACE_END(span, name) do { if (span) TraceRecord(name, span); } while (0)
+#else
+#define TRACE_BEGIN(span)
+#define TRACE_BEGIN_IF(span, condition)
+#define TRACE_END(span, name) ((void)0)
+#endif
+
+// Start collecting events; line spans are kept for every sampleEvery-th line
+int TraceStart(const char *path, int sampleEvery);
+// Write everything collected so far to the file given to TraceStart and stop
+int TraceStop(void);
+// Whether line number n is one of the sampled ones
+int TraceSampled(long n);
+// Record a span from start (StatsNow) until now, name has to be a string literal
+void TraceRecord(const char *name, uint64_t start);
+
+#endif //CHECKPOINT_TRACE_EVENTS_H